@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace debugglass::bench {
+
+inline std::uint64_t NowNs() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now().time_since_epoch())
+                                          .count());
+}
+
+struct LatencySummary {
+    std::size_t samples = 0;
+    double mean_ns = 0.0;
+    std::uint64_t p50_ns = 0;
+    std::uint64_t p99_ns = 0;
+    std::uint64_t p999_ns = 0;
+    std::uint64_t max_ns = 0;
+};
+
+// Sorts `latencies_ns` in place.
+inline LatencySummary Summarize(std::vector<std::uint64_t>& latencies_ns) {
+    LatencySummary summary;
+    if (latencies_ns.empty()) {
+        return summary;
+    }
+    std::sort(latencies_ns.begin(), latencies_ns.end());
+    const auto at = [&](double quantile) {
+        const auto index = static_cast<std::size_t>(quantile * static_cast<double>(latencies_ns.size() - 1));
+        return latencies_ns[index];
+    };
+    double total = 0.0;
+    for (const auto value : latencies_ns) {
+        total += static_cast<double>(value);
+    }
+    summary.samples = latencies_ns.size();
+    summary.mean_ns = total / static_cast<double>(latencies_ns.size());
+    summary.p50_ns = at(0.50);
+    summary.p99_ns = at(0.99);
+    summary.p999_ns = at(0.999);
+    summary.max_ns = latencies_ns.back();
+    return summary;
+}
+
+inline void PrintLatencyHeader() {
+    std::printf("%-44s %10s %8s %8s %8s %8s %10s\n", "case", "samples", "mean", "p50", "p99", "p99.9", "max");
+}
+
+inline void PrintLatency(const char* name, const LatencySummary& summary) {
+    std::printf("%-44s %10zu %8.1f %8llu %8llu %8llu %10llu\n", name, summary.samples, summary.mean_ns,
+                static_cast<unsigned long long>(summary.p50_ns), static_cast<unsigned long long>(summary.p99_ns),
+                static_cast<unsigned long long>(summary.p999_ns), static_cast<unsigned long long>(summary.max_ns));
+}
+
+}  // namespace debugglass::bench
@@ -0,0 +1,187 @@
+// Per-frame CPU cost of rendering synthetic widget trees through the headless
+// renderer: frame time (mean and p99), heap allocations per frame (from
+// debugglass and ImGui alike) and the size of the generated draw data. Needs
+// no display or OpenGL.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <imgui.h>
+
+#include "bench/bench_util.h"
+#include "debugglass/headless_renderer.h"
+#include "debugglass/subwindow_registry.h"
+#include "debugglass/widgets/graph.h"
+#include "debugglass/widgets/message_monitor.h"
+#include "debugglass/widgets/structure.h"
+#include "debugglass/widgets/variable.h"
+
+#if defined(DEBUGGLASS_ENABLE_PROFILER)
+#include "debugglass/util/profiler.h"
+
+namespace {
+// The profiler already counts operator new and ImGui's allocator.
+std::uint64_t Allocations() {
+    return debugglass::Profiler::ThreadAllocations();
+}
+
+// Constructing the profiler installs its counting ImGui allocator.
+void CountImGuiAllocations() {
+    debugglass::Profiler::Current();
+}
+}  // namespace
+#else
+namespace {
+std::atomic<std::uint64_t> g_allocations{0};
+
+std::uint64_t Allocations() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+// ImGui allocates through its own hooks rather than operator new.
+void* CountingImGuiAlloc(std::size_t size, void*) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size);
+}
+
+void CountingImGuiFree(void* pointer, void*) {
+    std::free(pointer);
+}
+
+void CountImGuiAllocations() {
+    ImGui::SetAllocatorFunctions(CountingImGuiAlloc, CountingImGuiFree, nullptr);
+}
+}  // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+#endif
+
+namespace {
+constexpr int kWarmupFrames = 30;
+constexpr int kMeasuredFrames = 300;
+
+struct Scale {
+    const char* name;
+    int windows;
+    int graphs_per_window;
+    int monitor_ids;
+    int variables_per_window;
+    // Collapsed subtrees under one root structure, to check that closed
+    // nodes stay cheap however much they hold.
+    int nested_structures = 0;
+    int variables_per_nested = 0;
+};
+
+struct Tree {
+    std::vector<debugglass::Graph*> graphs;
+    std::vector<debugglass::MessageMonitor*> monitors;
+    std::vector<debugglass::Variable*> variables;
+};
+
+Tree BuildTree(debugglass::SubWindowRegistry& windows, const Scale& scale) {
+    Tree tree;
+    for (int w = 0; w < scale.windows; ++w) {
+        auto& window = windows.Add("Window " + std::to_string(w));
+        auto& plots = window.AddTab("Plots");
+        for (int g = 0; g < scale.graphs_per_window; ++g) {
+            tree.graphs.push_back(&plots.AddGraph("graph " + std::to_string(g)));
+        }
+
+        auto& bus = window.AddTab("Bus");
+        auto& monitor = bus.AddMessageMonitor("messages");
+        tree.monitors.push_back(&monitor);
+        for (int i = 0; i < scale.monitor_ids; ++i) {
+            monitor.UpsertMessage("id/" + std::to_string(i), i);
+        }
+
+        auto& state = window.AddTab("State");
+        auto& structure = state.AddStructure("state");
+        for (int v = 0; v < scale.variables_per_window; ++v) {
+            tree.variables.push_back(&structure.AddVariable("field " + std::to_string(v)));
+        }
+        for (int n = 0; n < scale.nested_structures; ++n) {
+            auto& nested = structure.AddStructure("node " + std::to_string(n));
+            for (int v = 0; v < scale.variables_per_nested; ++v) {
+                tree.variables.push_back(&nested.AddVariable("leaf " + std::to_string(v)));
+            }
+        }
+    }
+    return tree;
+}
+
+// Mimics steady producer traffic between frames so caches are exercised the
+// same way as in a live process.
+void Feed(Tree& tree, int frame) {
+    const float sample = static_cast<float>(frame % 97);
+    for (auto* graph : tree.graphs) {
+        graph->AddValue(sample);
+    }
+    for (auto* monitor : tree.monitors) {
+        monitor->UpsertMessage("id/" + std::to_string(frame % 64), frame);
+    }
+    for (std::size_t v = 0; v < tree.variables.size(); v += 8) {
+        tree.variables[v]->SetValue(frame);
+    }
+}
+
+void RunScale(const Scale& scale) {
+    debugglass::SubWindowRegistry windows;
+    Tree tree = BuildTree(windows, scale);
+    debugglass::HeadlessRenderer renderer(windows);
+
+    for (int frame = 0; frame < kWarmupFrames; ++frame) {
+        Feed(tree, frame);
+        renderer.RenderFrame();
+    }
+
+    std::vector<std::uint64_t> frame_ns;
+    frame_ns.reserve(kMeasuredFrames);
+    std::uint64_t allocations = 0;
+    std::uint64_t vertices = 0;
+    for (int frame = 0; frame < kMeasuredFrames; ++frame) {
+        Feed(tree, frame);
+        const auto before = Allocations();
+        const auto stats = renderer.RenderFrame();
+        allocations += Allocations() - before;
+        vertices += static_cast<std::uint64_t>(stats.vertex_count);
+        frame_ns.push_back(static_cast<std::uint64_t>(stats.cpu_time.count()));
+    }
+
+    const auto summary = debugglass::bench::Summarize(frame_ns);
+    std::printf("%-10s %10.1f %10.1f %12.1f %10llu\n", scale.name, summary.mean_ns / 1e3,
+                static_cast<double>(summary.p99_ns) / 1e3, static_cast<double>(allocations) / kMeasuredFrames,
+                static_cast<unsigned long long>(vertices / kMeasuredFrames));
+}
+}  // namespace
+
+int main() {
+    const Scale scales[] = {
+        {"small", 1, 4, 64, 32},
+        {"medium", 4, 16, 1024, 256},
+        {"large", 16, 32, 8192, 1024},
+        {"deep", 1, 0, 0, 0, 100, 100},
+    };
+
+    // Installed before any context exists so every ImGui allocation is seen.
+    CountImGuiAllocations();
+
+    std::printf("Headless frame cost, %d frames after %d warm-up frames\n", kMeasuredFrames, kWarmupFrames);
+    std::printf("%-10s %10s %10s %12s %10s\n", "scale", "mean us", "p99 us", "allocs/frame", "vertices");
+    for (const auto& scale : scales) {
+        RunScale(scale);
+    }
+    return 0;
+}
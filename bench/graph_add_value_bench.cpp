@@ -0,0 +1,103 @@
+// Measures Graph::AddValue latency on the producer thread while another thread
+// keeps copying the graph the way the render thread does every frame.
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "debugglass/widgets/graph.h"
+
+namespace {
+constexpr std::size_t kSamplesPerProducer = 1'000'000;
+constexpr std::size_t kGraphCapacity = 4096;
+
+struct BenchCase {
+    const char* name;
+    debugglass::GraphProducerMode mode;
+    int producers;
+    bool render_load;
+};
+
+debugglass::bench::LatencySummary RunCase(const BenchCase& bench_case) {
+    debugglass::Graph graph("bench", kGraphCapacity, bench_case.mode);
+    std::atomic<bool> start{false};
+    std::atomic<bool> done{false};
+
+    std::thread render_thread;
+    if (bench_case.render_load) {
+        render_thread = std::thread([&]() {
+            while (!done.load(std::memory_order_relaxed)) {
+                const auto samples = graph.Snapshot();
+                if (samples.size() > kGraphCapacity) {
+                    std::printf("unexpected snapshot size\n");
+                }
+            }
+        });
+    }
+
+    std::vector<std::vector<std::uint64_t>> latencies(static_cast<std::size_t>(bench_case.producers));
+    std::vector<std::thread> producers;
+    for (int p = 0; p < bench_case.producers; ++p) {
+        producers.emplace_back([&, p]() {
+            auto& local = latencies[static_cast<std::size_t>(p)];
+            local.reserve(kSamplesPerProducer);
+            while (!start.load(std::memory_order_acquire)) {
+            }
+            for (std::size_t i = 0; i < kSamplesPerProducer; ++i) {
+                const auto begin = debugglass::bench::NowNs();
+                graph.AddValue(static_cast<float>(i));
+                local.push_back(debugglass::bench::NowNs() - begin);
+            }
+        });
+    }
+
+    start.store(true, std::memory_order_release);
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    done.store(true);
+    if (render_thread.joinable()) {
+        render_thread.join();
+    }
+
+    std::vector<std::uint64_t> merged;
+    merged.reserve(kSamplesPerProducer * latencies.size());
+    for (const auto& local : latencies) {
+        merged.insert(merged.end(), local.begin(), local.end());
+    }
+    return debugglass::bench::Summarize(merged);
+}
+
+debugglass::bench::LatencySummary TimerOverhead() {
+    std::vector<std::uint64_t> latencies;
+    latencies.reserve(kSamplesPerProducer);
+    for (std::size_t i = 0; i < kSamplesPerProducer; ++i) {
+        const auto begin = debugglass::bench::NowNs();
+        latencies.push_back(debugglass::bench::NowNs() - begin);
+    }
+    return debugglass::bench::Summarize(latencies);
+}
+}  // namespace
+
+int main() {
+    using debugglass::GraphProducerMode;
+    const BenchCase cases[] = {
+        {"single-producer, idle", GraphProducerMode::kSingleProducer, 1, false},
+        {"single-producer, render load", GraphProducerMode::kSingleProducer, 1, true},
+        {"multi-producer x1, render load", GraphProducerMode::kMultiProducer, 1, true},
+        {"multi-producer x4, idle", GraphProducerMode::kMultiProducer, 4, false},
+        {"multi-producer x4, render load", GraphProducerMode::kMultiProducer, 4, true},
+    };
+
+    std::printf("Graph::AddValue latency in ns (capacity %zu, %zu samples per producer)\n", kGraphCapacity,
+                kSamplesPerProducer);
+    debugglass::bench::PrintLatencyHeader();
+    debugglass::bench::PrintLatency("timer overhead", TimerOverhead());
+    for (const auto& bench_case : cases) {
+        debugglass::bench::PrintLatency(bench_case.name, RunCase(bench_case));
+    }
+    return 0;
+}
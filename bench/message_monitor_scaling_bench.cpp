@@ -0,0 +1,64 @@
+// Upsert throughput of one MessageMonitor fed by 1-16 producer threads, with a
+// single lock versus a sharded monitor.
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "debugglass/widgets/message_monitor.h"
+
+namespace {
+constexpr std::size_t kIdsPerThread = 512;
+constexpr std::size_t kOpsPerThread = 2'000'000;
+constexpr std::size_t kShardedCount = 64;
+
+double MeasureMopsPerSecond(std::size_t shards, int threads) {
+    debugglass::MessageMonitorOptions options;
+    options.shards = shards;
+    debugglass::MessageMonitor monitor("bench", options);
+
+    std::vector<std::vector<debugglass::MessageMonitor::Handle>> handles(static_cast<std::size_t>(threads));
+    for (int t = 0; t < threads; ++t) {
+        for (std::size_t i = 0; i < kIdsPerThread; ++i) {
+            handles[static_cast<std::size_t>(t)].push_back(
+                monitor.RegisterId("bus" + std::to_string(t) + "/" + std::to_string(i)));
+        }
+    }
+
+    std::atomic<bool> start{false};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            const auto& local = handles[static_cast<std::size_t>(t)];
+            while (!start.load(std::memory_order_acquire)) {
+            }
+            for (std::size_t op = 0; op < kOpsPerThread; ++op) {
+                monitor.Upsert(local[op % kIdsPerThread], static_cast<double>(op));
+            }
+        });
+    }
+
+    const auto begin = debugglass::bench::NowNs();
+    start.store(true, std::memory_order_release);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const auto elapsed = debugglass::bench::NowNs() - begin;
+    const double ops = static_cast<double>(kOpsPerThread) * threads;
+    return ops / (static_cast<double>(elapsed) / 1e9) / 1e6;
+}
+}  // namespace
+
+int main() {
+    std::printf("MessageMonitor upsert throughput (Mops/s), %zu ops per thread\n", kOpsPerThread);
+    std::printf("%8s %14s %14s\n", "threads", "1 shard", "64 shards");
+    for (int threads : {1, 2, 4, 8, 16}) {
+        const double single = MeasureMopsPerSecond(1, threads);
+        const double sharded = MeasureMopsPerSecond(kShardedCount, threads);
+        std::printf("%8d %14.2f %14.2f\n", threads, single, sharded);
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+// Compares the string-keyed MessageMonitor::UpsertMessage path with the
+// handle-based Upsert path on a CAN-like workload of many IDs.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "debugglass/widgets/message_monitor.h"
+
+namespace {
+constexpr std::size_t kIdCount = 4096;
+constexpr std::size_t kRounds = 256;
+
+std::vector<std::string> MakeIds() {
+    std::vector<std::string> ids;
+    ids.reserve(kIdCount);
+    char buffer[32];
+    for (std::size_t i = 0; i < kIdCount; ++i) {
+        std::snprintf(buffer, sizeof(buffer), "can0/0x%05zX", i * 7919 % 0x1FFFF);
+        ids.emplace_back(buffer);
+    }
+    return ids;
+}
+
+template <typename UpsertFn>
+double MeasureNsPerOp(UpsertFn&& upsert) {
+    const auto begin = debugglass::bench::NowNs();
+    for (std::size_t round = 0; round < kRounds; ++round) {
+        for (std::size_t i = 0; i < kIdCount; ++i) {
+            upsert(i, static_cast<double>(round * kIdCount + i));
+        }
+    }
+    const auto elapsed = debugglass::bench::NowNs() - begin;
+    return static_cast<double>(elapsed) / static_cast<double>(kRounds * kIdCount);
+}
+}  // namespace
+
+int main() {
+    const auto ids = MakeIds();
+
+    debugglass::MessageMonitor by_string("strings");
+    const double string_ns = MeasureNsPerOp([&](std::size_t i, double value) {
+        by_string.UpsertMessage(ids[i], value);
+    });
+
+    debugglass::MessageMonitor by_handle("handles");
+    std::vector<debugglass::MessageMonitor::Handle> handles;
+    handles.reserve(kIdCount);
+    for (const auto& id : ids) {
+        handles.push_back(by_handle.RegisterId(id));
+    }
+    const double handle_ns = MeasureNsPerOp([&](std::size_t i, double value) {
+        by_handle.Upsert(handles[i], value);
+    });
+
+    std::printf("MessageMonitor upsert, %zu IDs x %zu rounds\n", kIdCount, kRounds);
+    std::printf("%-32s %10.1f ns/op\n", "UpsertMessage(std::string, double)", string_ns);
+    std::printf("%-32s %10.1f ns/op\n", "Upsert(Handle, double)", handle_ns);
+    std::printf("%-32s %10.2fx\n", "speedup", string_ns / handle_ns);
+    return 0;
+}
@@ -0,0 +1,234 @@
+// Producer-side cost of every widget write API, single-threaded and with 1-32
+// contending producers, with and without a headless render thread drawing
+// the same widgets. Reports wall-clock ns/op, per-call p99 latency and
+// hardware cache misses per op (when perf_event_open is available).
+//
+// Usage: producer_bench [case-name-substring]
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "bench/perf_counter.h"
+#include "debugglass/headless_renderer.h"
+#include "debugglass/subwindow_registry.h"
+#include "debugglass/widgets/graph.h"
+#include "debugglass/widgets/message_monitor.h"
+#include "debugglass/widgets/structure.h"
+#include "debugglass/widgets/typed_variable.h"
+#include "debugglass/widgets/variable.h"
+
+namespace {
+constexpr std::size_t kIdsPerProducer = 64;
+constexpr std::size_t kBlockSamples = 4096;
+constexpr int kProducerCounts[] = {1, 2, 4, 8, 16, 32};
+
+// The widgets every case writes to, shared by all producers and drawn by the
+// optional render thread.
+struct Targets {
+    Targets() {
+        auto& tab = windows.Add("bench").AddTab("bench");
+        graph = &tab.AddGraph("graph", 4096);
+        variable = &tab.AddVariable("variable");
+        typed_variable = &tab.AddTypedVariable<double>("typed variable");
+        monitor = &tab.AddMessageMonitor("monitor");
+        structure = &tab.AddStructure("structure");
+    }
+
+    debugglass::SubWindowRegistry windows;
+    debugglass::Graph* graph = nullptr;
+    debugglass::Variable* variable = nullptr;
+    debugglass::TypedVariable<double>* typed_variable = nullptr;
+    debugglass::MessageMonitor* monitor = nullptr;
+    debugglass::Structure* structure = nullptr;
+};
+
+// Per-producer inputs prepared before timing starts, so the measured loop
+// only contains the write call.
+struct ProducerState {
+    std::vector<std::string> ids;
+    std::vector<debugglass::MessageMonitor::Handle> handles;
+    std::vector<float> block;
+    std::vector<debugglass::MessageMonitor::HandleUpdate<double>> updates;
+};
+
+using WriteOp = std::function<void(Targets&, ProducerState&, std::size_t)>;
+
+struct ApiCase {
+    const char* name;
+    std::size_t ops_per_producer;
+    WriteOp op;
+};
+
+struct Result {
+    debugglass::bench::LatencySummary latency;
+    double wall_ns_per_op = 0.0;
+    double misses_per_op = 0.0;
+    bool misses_valid = false;
+};
+
+Result RunCase(const ApiCase& api, int producers, bool render_load) {
+    Targets targets;
+    std::vector<ProducerState> states(static_cast<std::size_t>(producers));
+    for (int p = 0; p < producers; ++p) {
+        auto& state = states[static_cast<std::size_t>(p)];
+        for (std::size_t i = 0; i < kIdsPerProducer; ++i) {
+            state.ids.push_back("p" + std::to_string(p) + "/id" + std::to_string(i));
+            state.handles.push_back(targets.monitor->RegisterId(state.ids.back()));
+            state.updates.push_back({state.handles.back(), static_cast<double>(i)});
+        }
+        state.block.resize(kBlockSamples);
+        for (std::size_t i = 0; i < kBlockSamples; ++i) {
+            state.block[i] = static_cast<float>(i % 97);
+        }
+    }
+
+    std::atomic<bool> start{false};
+    std::atomic<bool> done{false};
+    std::atomic<int> ready{0};
+
+    std::thread render_thread;
+    if (render_load) {
+        render_thread = std::thread([&]() {
+            debugglass::HeadlessRenderer renderer(targets.windows);
+            while (!done.load(std::memory_order_relaxed)) {
+                renderer.RenderFrame();
+            }
+        });
+    }
+
+    std::vector<std::vector<std::uint64_t>> latencies(states.size());
+    std::vector<std::uint64_t> elapsed_ns(states.size());
+    std::vector<std::uint64_t> misses(states.size());
+    std::atomic<bool> misses_valid{true};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            const auto index = static_cast<std::size_t>(p);
+            auto& local = latencies[index];
+            local.reserve(api.ops_per_producer);
+            debugglass::bench::CacheMissCounter counter;
+            if (!counter.valid()) {
+                misses_valid.store(false);
+            }
+            ready.fetch_add(1);
+            while (!start.load(std::memory_order_acquire)) {
+            }
+
+            counter.Start();
+            const auto begin = debugglass::bench::NowNs();
+            for (std::size_t i = 0; i < api.ops_per_producer; ++i) {
+                const auto op_begin = debugglass::bench::NowNs();
+                api.op(targets, states[index], i);
+                local.push_back(debugglass::bench::NowNs() - op_begin);
+            }
+            elapsed_ns[index] = debugglass::bench::NowNs() - begin;
+            misses[index] = counter.Stop();
+        });
+    }
+
+    while (ready.load() < producers) {
+        std::this_thread::yield();
+    }
+    start.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    done.store(true);
+    if (render_thread.joinable()) {
+        render_thread.join();
+    }
+
+    Result result;
+    std::vector<std::uint64_t> merged;
+    std::uint64_t total_elapsed = 0;
+    std::uint64_t total_misses = 0;
+    for (std::size_t p = 0; p < states.size(); ++p) {
+        merged.insert(merged.end(), latencies[p].begin(), latencies[p].end());
+        total_elapsed += elapsed_ns[p];
+        total_misses += misses[p];
+    }
+    const double total_ops = static_cast<double>(api.ops_per_producer) * producers;
+    result.latency = debugglass::bench::Summarize(merged);
+    result.wall_ns_per_op = static_cast<double>(total_elapsed) / total_ops;
+    result.misses_valid = misses_valid.load();
+    result.misses_per_op = static_cast<double>(total_misses) / total_ops;
+    return result;
+}
+
+std::vector<ApiCase> ApiCases() {
+    return {
+        {"Graph::AddValue", 200'000,
+         [](Targets& t, ProducerState&, std::size_t i) { t.graph->AddValue(static_cast<float>(i)); }},
+        // One op is a whole block; compare against Graph::AddValue x 4096.
+        {"Graph::AddValues(4096 samples)", 2'000,
+         [](Targets& t, ProducerState& s, std::size_t) { t.graph->AddValues(s.block); }},
+        {"Variable::SetValue(int)", 200'000,
+         [](Targets& t, ProducerState&, std::size_t i) { t.variable->SetValue(static_cast<int>(i)); }},
+        {"Variable::SetValue(string)", 200'000,
+         [](Targets& t, ProducerState& s, std::size_t i) { t.variable->SetValue(s.ids[i % kIdsPerProducer]); }},
+        {"TypedVariable<double>::SetValue", 200'000,
+         [](Targets& t, ProducerState&, std::size_t i) { t.typed_variable->SetValue(static_cast<double>(i)); }},
+        {"MessageMonitor::UpsertMessage(string)", 200'000,
+         [](Targets& t, ProducerState& s, std::size_t i) {
+             t.monitor->UpsertMessage(s.ids[i % kIdsPerProducer], s.ids[(i + 1) % kIdsPerProducer]);
+         }},
+        {"MessageMonitor::UpsertMessage(double)", 200'000,
+         [](Targets& t, ProducerState& s, std::size_t i) {
+             t.monitor->UpsertMessage(s.ids[i % kIdsPerProducer], static_cast<double>(i));
+         }},
+        {"MessageMonitor::Upsert(handle, double)", 200'000,
+         [](Targets& t, ProducerState& s, std::size_t i) {
+             t.monitor->Upsert(s.handles[i % kIdsPerProducer], static_cast<double>(i));
+         }},
+        {"MessageMonitor::UpsertBatch(64 handles)", 20'000,
+         [](Targets& t, ProducerState& s, std::size_t) {
+             t.monitor->UpsertBatch(s.updates.data(), s.updates.size());
+         }},
+        // Grows the tree on every call, so it runs fewer iterations.
+        {"Structure::AddVariable", 20'000,
+         [](Targets& t, ProducerState& s, std::size_t i) {
+             t.structure->AddVariable(s.ids[i % kIdsPerProducer]);
+         }},
+    };
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    std::printf("%-40s %4s %6s %10s %8s %8s %10s\n", "case", "thr", "render", "wall ns/op", "p50", "p99",
+                "misses/op");
+    bool misses_reported = true;
+    for (const auto& api : ApiCases()) {
+        if (filter != nullptr && std::strstr(api.name, filter) == nullptr) {
+            continue;
+        }
+        for (bool render_load : {false, true}) {
+            for (int producers : kProducerCounts) {
+                const auto result = RunCase(api, producers, render_load);
+                char misses[32];
+                if (result.misses_valid) {
+                    std::snprintf(misses, sizeof(misses), "%.2f", result.misses_per_op);
+                } else {
+                    std::snprintf(misses, sizeof(misses), "n/a");
+                    misses_reported = false;
+                }
+                std::printf("%-40s %4d %6s %10.1f %8llu %8llu %10s\n", api.name, producers,
+                            render_load ? "yes" : "no", result.wall_ns_per_op,
+                            static_cast<unsigned long long>(result.latency.p50_ns),
+                            static_cast<unsigned long long>(result.latency.p99_ns), misses);
+                std::fflush(stdout);
+            }
+        }
+    }
+    if (!misses_reported) {
+        std::printf("\ncache misses unavailable: perf_event_open denied (check kernel.perf_event_paranoid)\n");
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+// Socket streaming throughput: producers write mirrored TypedVariables and
+// MessageMonitor handles as fast as they can while a viewer in the same
+// process receives the stream over loopback and applies it to a RemoteTree.
+// Reports producer ns/op, offered updates/s and, on the viewer side, records
+// and bytes delivered per second. The gap between offered and delivered is
+// what per-frame coalescing and overload dropping removed.
+//
+// Usage: socket_stream_bench [endpoint] [seconds] [offered updates/s, 0 = unpaced]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "debugglass/subwindow_registry.h"
+#include "debugglass/transport/remote_tree.h"
+#include "debugglass/transport/socket_client.h"
+#include "debugglass/transport/socket_sink.h"
+#include "debugglass/widgets/message_monitor.h"
+#include "debugglass/widgets/typed_variable.h"
+
+namespace {
+constexpr std::size_t kVariablesPerProducer = 64;
+constexpr std::size_t kIdsPerProducer = 256;
+constexpr int kProducerCounts[] = {1, 2, 4};
+
+struct Producer {
+    std::vector<debugglass::TypedVariable<double>*> variables;
+    debugglass::MessageMonitor* monitor = nullptr;
+    std::vector<debugglass::MessageMonitor::Handle> handles;
+};
+
+void RunCase(const std::string& endpoint, int producers, double seconds, double rate) {
+    debugglass::SocketSinkOptions options;
+    options.endpoint = endpoint;
+    std::string error;
+    auto sink = debugglass::SocketSink::Create(options, &error);
+    if (!sink) {
+        std::fprintf(stderr, "cannot listen on %s: %s\n", endpoint.c_str(), error.c_str());
+        std::exit(1);
+    }
+
+    debugglass::SubWindowRegistry windows;
+    std::vector<Producer> states(static_cast<std::size_t>(producers));
+    for (int p = 0; p < producers; ++p) {
+        auto& tab = windows.Add("bench").AddTab("producer " + std::to_string(p));
+        auto& state = states[static_cast<std::size_t>(p)];
+        for (std::size_t i = 0; i < kVariablesPerProducer; ++i) {
+            state.variables.push_back(&tab.AddTypedVariable<double>("v" + std::to_string(i)));
+        }
+        state.monitor = &tab.AddMessageMonitor("monitor");
+    }
+    windows.MirrorTo(*sink);
+    for (auto& state : states) {
+        for (std::size_t i = 0; i < kIdsPerProducer; ++i) {
+            state.handles.push_back(state.monitor->RegisterId("id" + std::to_string(i)));
+        }
+    }
+
+    debugglass::SubWindowRegistry mirror;
+    debugglass::RemoteTree tree(mirror);
+    auto client = debugglass::SocketClient::Connect(endpoint, &error);
+    if (!client) {
+        std::fprintf(stderr, "cannot connect to %s: %s\n", endpoint.c_str(), error.c_str());
+        std::exit(1);
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<std::uint64_t> ops(static_cast<std::size_t>(producers));
+    std::vector<std::uint64_t> busy_ns(static_cast<std::size_t>(producers));
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            auto& state = states[static_cast<std::size_t>(p)];
+            std::uint64_t count = 0;
+            std::uint64_t busy = 0;
+            const auto start = debugglass::bench::NowNs();
+            const double ns_per_update = rate > 0.0 ? 1e9 * producers / rate : 0.0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (ns_per_update > 0.0) {
+                    const auto due = start + static_cast<std::uint64_t>(static_cast<double>(count) * ns_per_update);
+                    const auto now = debugglass::bench::NowNs();
+                    if (due > now) {
+                        std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+                    }
+                }
+                const auto batch_start = debugglass::bench::NowNs();
+                for (std::size_t i = 0; i < 1024; ++i, ++count) {
+                    if ((count & 1) == 0) {
+                        state.variables[count % kVariablesPerProducer]->SetValue(static_cast<double>(count));
+                    } else {
+                        state.monitor->Upsert(state.handles[count % kIdsPerProducer], static_cast<double>(count));
+                    }
+                }
+                busy += debugglass::bench::NowNs() - batch_start;
+            }
+            busy_ns[static_cast<std::size_t>(p)] = busy;
+            ops[static_cast<std::size_t>(p)] = count;
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        if (!client->Poll(tree, std::chrono::milliseconds(5))) {
+            std::fprintf(stderr, "connection lost\n");
+            break;
+        }
+    }
+    stop.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::uint64_t total_ops = 0;
+    double ns_per_op = 0.0;
+    for (int p = 0; p < producers; ++p) {
+        total_ops += ops[static_cast<std::size_t>(p)];
+        ns_per_op += static_cast<double>(busy_ns[static_cast<std::size_t>(p)]) /
+                     static_cast<double>(ops[static_cast<std::size_t>(p)]);
+    }
+    ns_per_op /= producers;
+
+    std::printf("%-10d %10.1f %14.0f %14.0f %12.1f %10llu %8llu\n", producers, ns_per_op,
+                static_cast<double>(total_ops) / elapsed, static_cast<double>(client->records()) / elapsed,
+                static_cast<double>(client->bytes()) / elapsed / (1 << 20),
+                static_cast<unsigned long long>(sink->dropped()), static_cast<unsigned long long>(sink->resyncs()));
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    const std::string endpoint = argc > 1 ? argv[1] : "tcp://127.0.0.1:17777";
+    const double seconds = argc > 2 ? std::atof(argv[2]) : 2.0;
+    const double rate = argc > 3 ? std::atof(argv[3]) : 0.0;
+
+    std::printf("%s, %.1f s per case, %s\n", endpoint.c_str(), seconds, rate > 0.0 ? "paced" : "unpaced");
+    std::printf("%-10s %10s %14s %14s %12s %10s %8s\n", "producers", "ns/op", "offered/s", "delivered/s", "MiB/s",
+                "dropped", "resyncs");
+    for (int producers : kProducerCounts) {
+        RunCase(endpoint, producers, seconds, rate);
+    }
+    return 0;
+}
@@ -8,13 +8,21 @@
 
 #include <imgui.h>
 
+#include <algorithm>
 #include <iostream>
 #include <mutex>
 #include <thread>
 #include <utility>
 
+#include "debugglass/headless_renderer.h"
+#include "debugglass/util/profiler.h"
+#include "debugglass/util/redraw_signal.h"
+
 namespace {
 constexpr char kGlslVersion[] = "#version 330";
+// ImGui needs a couple of extra frames after a change for hover state and
+// layout to settle.
+constexpr int kSettleFrames = 2;
 }
 
 namespace debugglass {
@@ -30,10 +38,65 @@ bool DebugGlass::Run(const DebugGlassOptions& options) {
 
     stop_requested_.store(false);
 
+    if (options.display == DisplayMode::kSharedMemory || options.display == DisplayMode::kSocket ||
+        options.display == DisplayMode::kRecord) {
+        return StartMirroring(options);
+    }
+
     worker_ = std::thread(&DebugGlass::ThreadMain, this, options);
     return true;
 }
 
+bool DebugGlass::StartMirroring(const DebugGlassOptions& options) {
+#if defined(_WIN32)
+    static_cast<void>(options);
+    std::cerr << "Mirroring display modes are unsupported on this platform" << std::endl;
+    running_.store(false);
+    return false;
+#else
+    // The tree stays mirrored across Stop and Run; there is nothing to
+    // restart.
+    if (sink_ || recorder_) {
+        return true;
+    }
+
+    std::string error;
+    if (options.display == DisplayMode::kRecord || options.record) {
+        recorder_ = SessionRecorder::Create(options.recording, &error);
+        if (!recorder_) {
+            std::cerr << "Failed to start recording: " << error << std::endl;
+            running_.store(false);
+            return false;
+        }
+    }
+    if (options.display != DisplayMode::kRecord) {
+        if (options.display == DisplayMode::kSocket) {
+            sink_ = SocketSink::Create(options.socket, &error);
+        } else {
+            sink_ = SharedMemorySink::Create(options.shm_name, options.shm, &error);
+        }
+        if (!sink_) {
+            const std::string& target =
+                options.display == DisplayMode::kSocket ? options.socket.endpoint : options.shm_name;
+            std::cerr << "Failed to start mirroring to " << target << ": " << error << std::endl;
+            recorder_.reset();
+            running_.store(false);
+            return false;
+        }
+    }
+
+    if (sink_ && recorder_) {
+        tee_ = std::make_unique<TeeSink>(*sink_, *recorder_);
+        windows.MirrorTo(*tee_);
+    } else if (sink_) {
+        windows.MirrorTo(*sink_);
+    } else {
+        windows.MirrorTo(*recorder_);
+    }
+    return true;
+#endif
+}
+
 void DebugGlass::Stop() {
     stop_requested_.store(true);
     if (worker_.joinable()) {
@@ -53,6 +116,12 @@ void DebugGlass::SetBackgroundRenderer(BackgroundRenderCallback callback) {
 }
 
 void DebugGlass::ThreadMain(DebugGlassOptions options) {
+    if (options.display == DisplayMode::kHeadless) {
+        HeadlessMain(options);
+        running_.store(false);
+        return;
+    }
+
     GLFWwindow* window = nullptr;
     bool glfw_initialized = false;
     bool imgui_created = false;
@@ -84,7 +153,8 @@ void DebugGlass::ThreadMain(DebugGlassOptions options) {
     }
 
     glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);
+    const bool on_demand = options.redraw_mode == RedrawMode::kOnDemand;
+    glfwSwapInterval(on_demand ? 0 : 1);
 
     if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
         std::cerr << "Failed to load OpenGL functions via GLAD" << std::endl;
@@ -94,6 +164,10 @@ void DebugGlass::ThreadMain(DebugGlassOptions options) {
         return;
     }
 
+    // Installed before the ImGui backend, which chains to them.
+    glfwSetWindowUserPointer(window, this);
+    InstallInputCallbacks(window);
+
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     imgui_created = true;
@@ -125,31 +199,35 @@ void DebugGlass::ThreadMain(DebugGlassOptions options) {
 
     glClearColor(0.1f, 0.3f, 0.6f, 1.0f);
 
+    auto last_frame = std::chrono::steady_clock::now();
+    settle_frames_ = kSettleFrames;
     while (!glfwWindowShouldClose(window) && !stop_requested_.load()) {
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-        ImGui::DockSpaceOverViewport(0, ImGui::GetMainViewport());
-
-        const auto windows_snapshot = windows.Snapshot();
-        if (windows_snapshot.empty()) {
-            ImGui::Begin("DebugGlass");
-            ImGui::TextUnformatted("DebugGlass overlay running...");
-            ImGui::End();
-        } else {
-            for (const auto& window : windows_snapshot) {
-                if (!window) {
-                    continue;
-                }
-                const std::string& window_name = window->name();
-                const char* title = window_name.empty() ? "Window" : window_name.c_str();
-                ImGui::Begin(title);
-                window->Render();
-                ImGui::End();
-            }
+        if (on_demand && !WaitForNextFrame(window, options, last_frame)) {
+            break;
+        }
+        last_frame = std::chrono::steady_clock::now();
+        DEBUGGLASS_PROFILE_BEGIN_FRAME();
+
+        {
+            DEBUGGLASS_PROFILE_PHASE("NewFrame");
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+            ImGui::DockSpaceOverViewport(0, ImGui::GetMainViewport());
+        }
+
+        {
+            DEBUGGLASS_PROFILE_PHASE("Windows");
+            windows.Render();
+        }
+        if (options.show_profiler) {
+            DEBUGGLASS_PROFILER_WINDOW();
         }
 
-        ImGui::Render();
+        {
+            DEBUGGLASS_PROFILE_PHASE("ImGui::Render");
+            ImGui::Render();
+        }
         int display_w = 0;
         int display_h = 0;
         glfwGetFramebufferSize(window, &display_w, &display_h);
@@ -162,15 +240,24 @@ void DebugGlass::ThreadMain(DebugGlassOptions options) {
             background = background_callback_;
         }
         if (background) {
+            DEBUGGLASS_PROFILE_PHASE("Background");
             background();
         }
 
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            DEBUGGLASS_PROFILE_PHASE("Draw");
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
 
-        std::this_thread::sleep_for(options.frame_time);
+        {
+            DEBUGGLASS_PROFILE_PHASE("Swap");
+            glfwSwapBuffers(window);
+        }
+        DEBUGGLASS_PROFILE_END_FRAME();
+        if (!on_demand) {
+            glfwPollEvents();
+            std::this_thread::sleep_until(last_frame + options.frame_time);
+        }
     }
 
     if (imgui_opengl_backend) {
@@ -192,4 +279,85 @@ void DebugGlass::ThreadMain(DebugGlassOptions options) {
     running_.store(false);
 }
 
+void DebugGlass::HeadlessMain(const DebugGlassOptions& options) {
+    using Seconds = std::chrono::duration<double>;
+    const bool on_demand = options.redraw_mode == RedrawMode::kOnDemand;
+    const Seconds min_interval{1.0 / std::max(options.max_fps, 1.0)};
+    const Seconds max_interval{options.min_fps > 0.0 ? 1.0 / options.min_fps : 3600.0};
+
+    HeadlessRenderer renderer(windows, options.width, options.height);
+    auto last_frame = std::chrono::steady_clock::now();
+    while (!stop_requested_.load()) {
+        if (on_demand) {
+            std::this_thread::sleep_until(last_frame + std::chrono::duration_cast<std::chrono::nanoseconds>(min_interval));
+            const Seconds idle = std::chrono::steady_clock::now() - last_frame;
+            if (!RedrawSignal::Consume() && idle < max_interval) {
+                continue;
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        renderer.RenderFrame(Seconds(now - last_frame).count());
+        last_frame = now;
+        if (!on_demand) {
+            std::this_thread::sleep_until(last_frame + options.frame_time);
+        }
+    }
+}
+
+bool DebugGlass::WaitForNextFrame(GLFWwindow* window,
+                                  const DebugGlassOptions& options,
+                                  std::chrono::steady_clock::time_point last_frame) {
+    using Seconds = std::chrono::duration<double>;
+    const Seconds min_interval{1.0 / std::max(options.max_fps, 1.0)};
+    const Seconds max_interval{options.min_fps > 0.0 ? 1.0 / options.min_fps : 3600.0};
+
+    while (!stop_requested_.load() && !glfwWindowShouldClose(window)) {
+        const Seconds elapsed = std::chrono::steady_clock::now() - last_frame;
+        if (elapsed < min_interval) {
+            glfwWaitEventsTimeout((min_interval - elapsed).count());
+            continue;
+        }
+        // A frame may be due on every pass under constant writes, so events
+        // are processed here too or the window would stop responding.
+        glfwPollEvents();
+        if (glfwWindowShouldClose(window)) {
+            break;
+        }
+        if (input_pending_.exchange(false) || RedrawSignal::Consume()) {
+            settle_frames_ = kSettleFrames;
+            return true;
+        }
+        if (settle_frames_ > 0) {
+            --settle_frames_;
+            return true;
+        }
+        if (elapsed >= max_interval) {
+            return true;
+        }
+        // Input wakes the wait immediately; widget writes are picked up on
+        // the next slice, at most one max_fps frame later.
+        glfwWaitEventsTimeout(std::min(min_interval, max_interval - elapsed).count());
+    }
+    return false;
+}
+
+void DebugGlass::MarkInput(GLFWwindow* window) {
+    if (auto* self = static_cast<DebugGlass*>(glfwGetWindowUserPointer(window))) {
+        self->input_pending_.store(true);
+    }
+}
+
+void DebugGlass::InstallInputCallbacks(GLFWwindow* window) {
+    glfwSetCursorPosCallback(window, [](GLFWwindow* target, double, double) { MarkInput(target); });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow* target, int, int, int) { MarkInput(target); });
+    glfwSetScrollCallback(window, [](GLFWwindow* target, double, double) { MarkInput(target); });
+    glfwSetKeyCallback(window, [](GLFWwindow* target, int, int, int, int) { MarkInput(target); });
+    glfwSetCharCallback(window, [](GLFWwindow* target, unsigned int) { MarkInput(target); });
+    glfwSetCursorEnterCallback(window, [](GLFWwindow* target, int) { MarkInput(target); });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow* target, int) { MarkInput(target); });
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow* target, int, int) { MarkInput(target); });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow* target) { MarkInput(target); });
+}
+
 }  // namespace debugglass
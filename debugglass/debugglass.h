@@ -3,21 +3,88 @@
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
 
 #include "debugglass/subwindow_registry.h"
+
+// The transports are POSIX-only and not linked on Windows.
+#if !defined(_WIN32)
+#include "debugglass/transport/session_recorder.h"
+#include "debugglass/transport/shm_ring.h"
+#include "debugglass/transport/socket_sink.h"
+#endif
+
+struct GLFWwindow;
+
 namespace debugglass {
 
+enum class DisplayMode {
+    // GLFW window with an OpenGL renderer.
+    kWindow,
+    // No window or graphics context: frames run through HeadlessRenderer,
+    // for measuring render cost on hosts without a GPU.
+    kHeadless,
+    // No window or render thread at all: widget writes are mirrored into
+    // the POSIX shared-memory segment shm_name, where debugglass_viewer
+    // renders them in another process. This and the modes below are not
+    // supported on Windows, where Run fails.
+    kSharedMemory,
+    // Like kSharedMemory, but streamed over TCP or a Unix socket to any
+    // number of debugglass_viewer instances, possibly on other hosts.
+    kSocket,
+    // No window and no viewer: widget writes are only recorded to
+    // recording.path, for replay in debugglass_viewer.
+    kRecord,
+};
+
+enum class RedrawMode {
+    // Draw every frame, paced by vsync and frame_time.
+    kContinuous,
+    // Draw only after widget writes or input events, between min_fps and
+    // max_fps. An idle overlay sleeps in glfwWaitEventsTimeout.
+    kOnDemand,
+};
+
 struct DebugGlassOptions {
     int width = 640;
     int height = 480;
     std::string title = "DebugGlass";
+    DisplayMode display = DisplayMode::kWindow;
+    // Target frame period for RedrawMode::kContinuous.
     std::chrono::milliseconds frame_time{16};
+    RedrawMode redraw_mode = RedrawMode::kContinuous;
+    // Frame rate bounds for RedrawMode::kOnDemand. min_fps keeps time-based
+    // visuals such as message highlights fading while nothing changes.
+    double min_fps = 2.0;
+    double max_fps = 60.0;
+#if !defined(_WIN32)
+    // Segment and sizes for DisplayMode::kSharedMemory.
+    std::string shm_name = "debugglass";
+    SharedMemoryOptions shm;
+    // Endpoint and batching for DisplayMode::kSocket.
+    SocketSinkOptions socket;
+    // Also record every mirrored write with kSharedMemory or kSocket;
+    // kRecord always records.
+    bool record = false;
+    SessionRecorderOptions recording;
+#endif
+    // Show the "DebugGlass Perf" window with the render cost of each window,
+    // tab and widget. Ignored unless built with --config=profiler.
+    bool show_profiler = false;
 };
 
 class DebugGlass {
+#if !defined(_WIN32)
+    // Declared before windows, whose widgets keep a pointer to them once
+    // mirrored. The tree is mirrored to sink_, or through tee_ to both.
+    std::unique_ptr<UpdateSink> sink_;
+    std::unique_ptr<SessionRecorder> recorder_;
+    std::unique_ptr<TeeSink> tee_;
+#endif
+
 public:
     DebugGlass() = default;
     ~DebugGlass();
@@ -34,11 +101,22 @@ public:
     SubWindowRegistry windows;
 
 private:
+    bool StartMirroring(const DebugGlassOptions& options);
     void ThreadMain(DebugGlassOptions options);
+    void HeadlessMain(const DebugGlassOptions& options);
+    // Blocks until the next on-demand frame is due; false once the loop
+    // should exit.
+    bool WaitForNextFrame(GLFWwindow* window,
+                          const DebugGlassOptions& options,
+                          std::chrono::steady_clock::time_point last_frame);
+    static void InstallInputCallbacks(GLFWwindow* window);
+    static void MarkInput(GLFWwindow* window);
 
     std::thread worker_;
     std::atomic<bool> running_{false};
     std::atomic<bool> stop_requested_{false};
+    std::atomic<bool> input_pending_{false};
+    int settle_frames_ = 0;
     mutable std::mutex background_mutex_;
     BackgroundRenderCallback background_callback_;
 };
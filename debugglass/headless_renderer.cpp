@@ -0,0 +1,74 @@
+#include "debugglass/headless_renderer.h"
+
+#include <imgui.h>
+
+#include "debugglass/util/profiler.h"
+
+namespace debugglass {
+
+HeadlessRenderer::HeadlessRenderer(const SubWindowRegistry& windows, int width, int height) : windows_(windows) {
+    ImGuiContext* previous = ImGui::GetCurrentContext();
+    IMGUI_CHECKVERSION();
+    context_ = ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(static_cast<float>(width), static_cast<float>(height));
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+    ImGui::StyleColorsDark();
+    ImGui::SetCurrentContext(previous);
+}
+
+HeadlessRenderer::~HeadlessRenderer() {
+    ImGui::DestroyContext(context_);
+}
+
+HeadlessFrameStats HeadlessRenderer::RenderFrame(float delta_seconds) {
+    ImGuiContext* previous = ImGui::GetCurrentContext();
+    ImGui::SetCurrentContext(context_);
+
+    const auto begin = std::chrono::steady_clock::now();
+    DEBUGGLASS_PROFILE_BEGIN_FRAME();
+    ImGui::GetIO().DeltaTime = delta_seconds > 0.0f ? delta_seconds : 1.0f / 60.0f;
+    {
+        DEBUGGLASS_PROFILE_PHASE("NewFrame");
+        ImGui::NewFrame();
+    }
+    {
+        DEBUGGLASS_PROFILE_PHASE("Windows");
+        windows_.Render();
+    }
+    {
+        DEBUGGLASS_PROFILE_PHASE("ImGui::Render");
+        ImGui::Render();
+    }
+    AcknowledgeTextures();
+    const auto end = std::chrono::steady_clock::now();
+
+    HeadlessFrameStats stats;
+    stats.cpu_time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+    if (const ImDrawData* draw_data = ImGui::GetDrawData()) {
+        stats.vertex_count = draw_data->TotalVtxCount;
+        stats.index_count = draw_data->TotalIdxCount;
+        stats.draw_lists = draw_data->CmdListsCount;
+    }
+
+    DEBUGGLASS_PROFILE_END_FRAME();
+    ImGui::SetCurrentContext(previous);
+    return stats;
+}
+
+void HeadlessRenderer::AcknowledgeTextures() {
+    for (ImTextureData* texture : ImGui::GetPlatformIO().Textures) {
+        if (texture->Status == ImTextureStatus_WantCreate) {
+            texture->SetTexID(static_cast<ImTextureID>(1));
+            texture->SetStatus(ImTextureStatus_OK);
+        } else if (texture->Status == ImTextureStatus_WantUpdates) {
+            texture->SetStatus(ImTextureStatus_OK);
+        } else if (texture->Status == ImTextureStatus_WantDestroy && texture->UnusedFrames > 0) {
+            texture->SetTexID(static_cast<ImTextureID>(0));
+            texture->SetStatus(ImTextureStatus_Destroyed);
+        }
+    }
+}
+
+}  // namespace debugglass
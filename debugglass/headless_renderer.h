@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+
+#include "debugglass/subwindow_registry.h"
+
+struct ImGuiContext;
+
+namespace debugglass {
+
+struct HeadlessFrameStats {
+    std::chrono::nanoseconds cpu_time{0};
+    int vertex_count = 0;
+    int index_count = 0;
+    int draw_lists = 0;
+};
+
+// Runs ImGui frames over a SubWindowRegistry without any platform or
+// renderer backend. Widgets go through NewFrame/Render exactly as in the
+// overlay; the resulting draw data is measured and then dropped. Owns its
+// own ImGui context and makes it current for each frame, so it must not run
+// concurrently with another ImGui context in the same process.
+class HeadlessRenderer {
+public:
+    explicit HeadlessRenderer(const SubWindowRegistry& windows, int width = 1280, int height = 720);
+    ~HeadlessRenderer();
+
+    HeadlessRenderer(const HeadlessRenderer&) = delete;
+    HeadlessRenderer& operator=(const HeadlessRenderer&) = delete;
+
+    HeadlessFrameStats RenderFrame(float delta_seconds = 1.0f / 60.0f);
+
+private:
+    // Plays the renderer's part of the texture protocol so ImGui keeps
+    // building its font atlas without a GPU.
+    static void AcknowledgeTextures();
+
+    const SubWindowRegistry& windows_;
+    ImGuiContext* context_ = nullptr;
+};
+
+}  // namespace debugglass
@@ -4,36 +4,47 @@
 
 #include <imgui.h>
 
+#include "debugglass/util/profiler.h"
+#include "debugglass/util/redraw_signal.h"
+#include "debugglass/util/slab_pool.h"
 
 namespace debugglass {
 
-SubWindow::SubWindow(std::string name) : name_(std::move(name)), tabs(*this) {}
+SubWindow::SubWindow(std::string name, WidgetPath path)
+    : name_(std::move(name)), tabs(*this), path_(std::move(path)) {
+    path_.set_owner(this);
+}
 
 void SubWindow::SetRenderCallback(RenderCallback callback) {
-    std::lock_guard<std::mutex> lock(content_mutex_);
-    callback_ = std::move(callback);
+    callback_.Store(std::move(callback));
+    RedrawSignal::Raise();
 }
 
 Tab& SubWindow::AddTab(std::string label) {
-    auto tab = std::make_shared<Tab>(std::move(label));
-    std::lock_guard<std::mutex> lock(content_mutex_);
-    tabs_.push_back(tab);
-    return *tab;
+    auto tab = MakePooled<Tab>(label, path_.Child(label));
+    auto& ref = *tab;
+    path_.Register(ref.label(), &ref);
+    {
+        std::lock_guard<std::mutex> lock(mirror_mutex_);
+        if (UpdateSink* sink = remote_.sink()) {
+            ref.MirrorTo(*sink, remote_.id());
+        }
+        tabs_.PushBack(std::move(tab));
+    }
+    RedrawSignal::Raise();
+    return ref;
 }
 
 Tab* SubWindow::FindTab(const std::string& label) {
-    std::lock_guard<std::mutex> lock(content_mutex_);
-    for (const auto& tab : tabs_) {
-        if (tab && tab->label() == label) {
-            return tab.get();
-        }
-    }
-    return nullptr;
+    return const_cast<Tab*>(static_cast<const SubWindow&>(*this).FindTab(label));
 }
 
 const Tab* SubWindow::FindTab(const std::string& label) const {
-    std::lock_guard<std::mutex> lock(content_mutex_);
-    for (const auto& tab : tabs_) {
+    if (path_.indexed()) {
+        return path_.Find<Tab>(label);
+    }
+    Rcu::ReadGuard guard;
+    for (const auto& tab : tabs_.Read()) {
         if (tab && tab->label() == label) {
             return tab.get();
         }
@@ -41,17 +52,37 @@ const Tab* SubWindow::FindTab(const std::string& label) const {
     return nullptr;
 }
 
-void SubWindow::Render() const {
-    SubWindow::RenderCallback callback_copy;
-    std::vector<std::shared_ptr<Tab>> tabs_snapshot;
-    {
-        std::lock_guard<std::mutex> lock(content_mutex_);
-        callback_copy = callback_;
-        tabs_snapshot = tabs_;
+bool SubWindow::RemoveTab(const Tab& tab) {
+    path_.Unregister(tab.label(), &tab);
+    std::lock_guard<std::mutex> lock(mirror_mutex_);
+    UpdateSink* sink = tab.remote().sink();
+    const std::uint32_t remote_id = tab.remote().id();
+    const auto removed = tabs_.RemoveIf([&](const auto& entry) { return entry.get() == &tab; });
+    if (removed == 0) {
+        return false;
+    }
+    SendRemove(sink, remote_id);
+    RedrawSignal::Raise();
+    return true;
+}
+
+void SubWindow::MirrorTo(UpdateSink& sink) {
+    std::lock_guard<std::mutex> lock(mirror_mutex_);
+    const std::uint32_t id = DefineNode(sink, remote_, RecordType::kWindow, 0, name_);
+    Rcu::ReadGuard guard;
+    for (const auto& tab : tabs_.Read()) {
+        tab->MirrorTo(sink, id);
     }
+}
 
-    if (callback_copy) {
-        callback_copy();
+void SubWindow::Render() const {
+    Rcu::ReadGuard guard;
+    const RenderCallback* callback = callback_.Read();
+    const auto tabs_snapshot = tabs_.Read();
+
+    if (callback != nullptr && *callback) {
+        DEBUGGLASS_PROFILE_SCOPE(ProfileKind::kCallback, callback, "callback");
+        (*callback)();
     }
 
     if (tabs_snapshot.empty()) {
@@ -83,9 +114,15 @@ SubWindow& SubWindowRegistry::Add(std::string name) {
         return *existing;
     }
 
-    auto window = std::make_shared<SubWindow>(std::move(name));
+    auto window = MakePooled<SubWindow>(name, WidgetPath(&index_, name));
     auto& ref = *window;
-    windows_.emplace(ref.name(), std::move(window));
+    index_.Register(ref.name(), &ref);
+    if (sink_ != nullptr) {
+        ref.MirrorTo(*sink_);
+    }
+    windows_by_name_.emplace(ref.name(), window);
+    windows_.PushBack(std::move(window));
+    RedrawSignal::Raise();
     return ref;
 }
 
@@ -105,19 +142,66 @@ const SubWindow* SubWindowRegistry::TryGet(const std::string& name) const {
     return window.get();
 }
 
-std::vector<std::shared_ptr<SubWindow>> SubWindowRegistry::Snapshot() const {
+bool SubWindowRegistry::Remove(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = windows_by_name_.find(name);
+    if (it == windows_by_name_.end()) {
+        return false;
+    }
+    const SubWindow* window = it->second.get();
+    index_.Unregister(name, window);
+    windows_.RemoveIf([&](const auto& entry) { return entry.get() == window; });
+    SendRemove(window->remote().sink(), window->remote().id());
+    windows_by_name_.erase(it);
+    RedrawSignal::Raise();
+    return true;
+}
+
+void SubWindowRegistry::MirrorTo(UpdateSink& sink) {
     std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<std::shared_ptr<SubWindow>> snapshot;
-    snapshot.reserve(windows_.size());
-    for (const auto& [_, window] : windows_) {
-        snapshot.push_back(window);
+    if (sink_ != nullptr) {
+        return;
+    }
+    sink_ = &sink;
+    Rcu::ReadGuard guard;
+    for (const auto& window : windows_.Read()) {
+        window->MirrorTo(sink);
+    }
+}
+
+std::vector<std::shared_ptr<SubWindow>> SubWindowRegistry::Snapshot() const {
+    return windows_.Copy();
+}
+
+void SubWindowRegistry::Render() const {
+    {
+        Rcu::ReadGuard guard;
+        const auto windows_snapshot = windows_.Read();
+        if (windows_snapshot.empty()) {
+            ImGui::Begin("DebugGlass");
+            ImGui::TextUnformatted("DebugGlass overlay running...");
+            ImGui::End();
+        }
+
+        for (const auto& window : windows_snapshot) {
+            if (!window) {
+                continue;
+            }
+            const std::string& window_name = window->name();
+            const char* title = window_name.empty() ? "Window" : window_name.c_str();
+            DEBUGGLASS_PROFILE_SCOPE(ProfileKind::kWindow, window.get(), title);
+            ImGui::Begin(title);
+            window->Render();
+            ImGui::End();
+        }
     }
-    return snapshot;
+    // Frees lists that were replaced while this frame was reading them.
+    Rcu::Reclaim();
 }
 
 std::shared_ptr<SubWindow> SubWindowRegistry::FindLocked(const std::string& name) const {
-    auto it = windows_.find(name);
-    if (it == windows_.end()) {
+    auto it = windows_by_name_.find(name);
+    if (it == windows_by_name_.end()) {
         return nullptr;
     }
     return it->second;
@@ -7,7 +7,9 @@
 #include <unordered_map>
 #include <vector>
 
+#include "debugglass/util/rcu.h"
 #include "debugglass/widgets/tab.h"
+#include "debugglass/widgets/widget_index.h"
 
 namespace debugglass {
 
@@ -28,7 +30,7 @@ public:
         SubWindow& owner_;
     };
 
-    explicit SubWindow(std::string name);
+    explicit SubWindow(std::string name, WidgetPath path = {});
 
     const std::string& name() const noexcept { return name_; }
 
@@ -37,16 +39,28 @@ public:
     void SetRenderCallback(RenderCallback callback);
 
     Tab& AddTab(std::string label);
+    // O(1) through the WidgetIndex when the window belongs to a registry.
     Tab* FindTab(const std::string& label);
     const Tab* FindTab(const std::string& label) const;
 
+    // Detaches a tab; see Tab::Remove.
+    bool RemoveTab(const Tab& tab);
+
     void Render() const;
 
+    // See SubWindowRegistry::MirrorTo.
+    void MirrorTo(UpdateSink& sink);
+    const RemoteBinding& remote() const noexcept { return remote_; }
+
 private:
     std::string name_;
-    mutable std::mutex content_mutex_;
-    RenderCallback callback_;
-    std::vector<std::shared_ptr<Tab>> tabs_;
+    WidgetPath path_;
+    RemoteBinding remote_;
+    RcuBox<RenderCallback> callback_;
+    RcuList<std::shared_ptr<Tab>> tabs_;
+    // Held while mirroring and while adding or removing tabs, so every
+    // tab is announced exactly once and none is missed.
+    std::mutex mirror_mutex_;
 };
 
 class SubWindowRegistry {
@@ -62,13 +76,51 @@ public:
     SubWindow* find(const std::string& name) { return TryGet(name); }
     const SubWindow* find(const std::string& name) const { return TryGet(name); }
 
+    // Windows in the order they were added.
     std::vector<std::shared_ptr<SubWindow>> Snapshot() const;
 
+    // Closes a window and everything in it. The window is destroyed once no
+    // reader can still see it. Returns false if there is no such window.
+    bool Remove(const std::string& name);
+
+    // Looks a widget up by "Window/Tab/Structure/.../Label" in O(1). Returns
+    // null if nothing of type T was added at that path.
+    template <typename T>
+    T* Find(const std::string& path) const {
+        return index_.Find<T>(path);
+    }
+
+    // Cacheable lookup: the handle stays valid for the registry's lifetime
+    // and resolves as soon as a widget of type T appears at `path`.
+    template <typename T>
+    WidgetHandle<T> Handle(const std::string& path) {
+        return WidgetHandle<T>(&index_.SlotFor(path));
+    }
+
+    // Mirrors the tree to another process: every window, existing or added
+    // later, is announced to `sink` and its widgets forward their writes
+    // there instead of storing them. Watches and render callbacks are not
+    // mirrored. Call once, before producers start writing; `sink` must
+    // outlive the registry. Nodes may be added or removed concurrently:
+    // each is announced exactly once.
+    void MirrorTo(UpdateSink& sink);
+
+    // Emits every window with ImGui::Begin/End. Must be called between
+    // ImGui::NewFrame and ImGui::Render. Takes no locks: child lists are read
+    // under an Rcu::ReadGuard.
+    void Render() const;
+
 private:
     std::shared_ptr<SubWindow> FindLocked(const std::string& name) const;
 
+    // Declared first so it outlives the windows that point into it.
+    WidgetIndex index_;
+    // Guards windows_by_name_ and keeps Add from racing itself; rendering
+    // only reads windows_.
     mutable std::mutex mutex_;
-    std::unordered_map<std::string, std::shared_ptr<SubWindow>> windows_;
+    std::unordered_map<std::string, std::shared_ptr<SubWindow>> windows_by_name_;
+    RcuList<std::shared_ptr<SubWindow>> windows_;
+    UpdateSink* sink_ = nullptr;
 };
 
 }  // namespace debugglass
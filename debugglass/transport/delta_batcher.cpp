@@ -0,0 +1,373 @@
+#include "debugglass/transport/delta_batcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace debugglass {
+namespace {
+bool IsMessageRecord(std::uint16_t type) {
+    return type >= static_cast<std::uint16_t>(RecordType::kMessageRegister) &&
+           type <= static_cast<std::uint16_t>(RecordType::kMessageClear);
+}
+
+std::size_t SnapshotSamples(std::uint64_t capacity) {
+    return static_cast<std::size_t>(std::min<std::uint64_t>(capacity, DeltaBatcher::kMaxSnapshotSamples));
+}
+
+bool ReadMessageKey(const RecordHeader& header, const unsigned char* payload, MessageKey& key) {
+    RecordReader reader(payload, header.size);
+    return reader.Get(key);
+}
+}  // namespace
+
+std::size_t DeltaBatcher::ValueKeyHash::operator()(const ValueKey& key) const noexcept {
+    std::size_t hash = std::hash<std::string>{}(key.id);
+    hash ^= (static_cast<std::size_t>(key.widget) << 16 ^ key.type) * 0x9E3779B97F4A7C15ull;
+    hash ^= static_cast<std::size_t>(key.handle ^ (std::uint64_t{key.generation} << 40)) * 0xC2B2AE3D27D4EB4Full;
+    return hash;
+}
+
+bool DeltaBatcher::KeyFor(const RecordHeader& header, const unsigned char* payload, ValueKey& key) {
+    key.widget = header.widget;
+    key.type = header.type;
+    switch (static_cast<RecordType>(header.type)) {
+    case RecordType::kGraphRange:
+    case RecordType::kText:
+    case RecordType::kNumber:
+    case RecordType::kBytes:
+        return true;
+    case RecordType::kMessageRegister:
+    case RecordType::kMessageUpsert: {
+        // Registrations are keyed by ID as well, so removing an ID finds its
+        // handle.
+        RecordReader reader(payload, header.size);
+        MessageKey handle;
+        if (header.type == static_cast<std::uint16_t>(RecordType::kMessageRegister) && !reader.Get(handle)) {
+            return false;
+        }
+        return reader.GetString(key.id);
+    }
+    case RecordType::kMessageHandleUpsert: {
+        MessageKey handle;
+        if (!ReadMessageKey(header, payload, handle)) {
+            return false;
+        }
+        key.handle = handle.key;
+        key.generation = handle.generation;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void DeltaBatcher::Add(const RecordHeader& header, const unsigned char* payload) {
+    ValueKey key;
+    const bool keyed = KeyFor(header, payload, key);
+    UpdateState(header, payload, keyed ? &key : nullptr);
+    if (collect_deltas_) {
+        AddToDelta(header, payload, keyed ? &key : nullptr);
+    }
+}
+
+void DeltaBatcher::AddToDelta(const RecordHeader& header, const unsigned char* payload, const ValueKey* key) {
+    if (header.type == static_cast<std::uint16_t>(RecordType::kGraphValues)) {
+        std::vector<float>& samples = samples_[header.widget];
+        if (samples.empty()) {
+            // The merged block goes where the frame's first samples were.
+            delta_.push_back(Pending{header, 0, true});
+        }
+        const std::size_t count = header.size / sizeof(float);
+        const std::size_t offset = samples.size();
+        samples.resize(offset + count);
+        std::memcpy(samples.data() + offset, payload, count * sizeof(float));
+
+        // A graph only shows its last `capacity` samples; keep the frame
+        // from growing far past that under a burst.
+        auto node = nodes_.find(header.widget);
+        if (node != nodes_.end() && node->second.graph_capacity != 0 &&
+            samples.size() > 2 * node->second.graph_capacity) {
+            samples.erase(samples.begin(), samples.end() - static_cast<std::ptrdiff_t>(node->second.graph_capacity));
+        }
+        return;
+    }
+
+    // Registrations are never coalesced: later handle upserts depend on
+    // every one of them.
+    if (key != nullptr && header.type != static_cast<std::uint16_t>(RecordType::kMessageRegister)) {
+        auto [slot, inserted] = delta_index_.try_emplace(*key, delta_.size());
+        if (!inserted) {
+            // Move the value to the end rather than overwrite in place, so
+            // it stays behind any removal written in between.
+            delta_[slot->second].live = false;
+            slot->second = delta_.size();
+            ++coalesced_;
+        }
+    }
+    delta_.push_back(Pending{header, delta_bytes_.size(), true});
+    delta_bytes_.append(reinterpret_cast<const char*>(payload), header.size);
+}
+
+void DeltaBatcher::UpdateState(const RecordHeader& header, const unsigned char* payload, const ValueKey* key) {
+    const auto type = static_cast<RecordType>(header.type);
+    if (type == RecordType::kRemove) {
+        RemoveSubtree(header.widget);
+        return;
+    }
+    if (IsDefinition(type)) {
+        auto [it, inserted] = nodes_.try_emplace(header.widget);
+        Node& node = it->second;
+        if (!inserted) {
+            UnlinkNode(node);
+        }
+        node.header = header;
+        LinkNode(header.widget, node);
+        node.payload.assign(reinterpret_cast<const char*>(payload), header.size);
+        RecordReader reader(payload, header.size);
+        std::string label;
+        if (type == RecordType::kGraph) {
+            GraphParams params;
+            if (reader.GetString(label) && reader.Get(params)) {
+                node.graph_capacity = params.capacity;
+                node.history_capacity = SnapshotSamples(params.capacity);
+            }
+        } else if (type == RecordType::kHistoryGraph) {
+            HistoryGraphParams params;
+            if (reader.GetString(label) && reader.Get(params)) {
+                node.history_capacity = SnapshotSamples(params.history);
+            }
+        }
+        return;
+    }
+    auto node = nodes_.find(header.widget);
+    if (node == nodes_.end()) {
+        return;
+    }
+
+    switch (type) {
+    case RecordType::kGraphValues: {
+        Node& graph = node->second;
+        if (graph.history_capacity == 0) {
+            return;
+        }
+        const std::size_t count = header.size / sizeof(float);
+        const std::size_t offset = graph.history.size();
+        graph.history.resize(offset + count);
+        std::memcpy(graph.history.data() + offset, payload, count * sizeof(float));
+        if (graph.history.size() > 2 * graph.history_capacity) {
+            graph.history.erase(graph.history.begin(),
+                                graph.history.end() - static_cast<std::ptrdiff_t>(graph.history_capacity));
+        }
+        return;
+    }
+    case RecordType::kMessageRemove: {
+        const std::string id(reinterpret_cast<const char*>(payload), header.size);
+        EraseMessage(header.widget, id);
+        return;
+    }
+    case RecordType::kMessageHandleRemove: {
+        MessageKey handle;
+        auto values = latest_.find(header.widget);
+        if (values == latest_.end() || !ReadMessageKey(header, payload, handle)) {
+            return;
+        }
+        const auto registration = values->second.registrations.find(handle.key);
+        if (registration == values->second.registrations.end() ||
+            registration->second.generation != handle.generation) {
+            return;
+        }
+        const std::string id = registration->second.id;
+        EraseMessage(header.widget, id);
+        return;
+    }
+    case RecordType::kMessageClear: {
+        auto values = latest_.find(header.widget);
+        if (values == latest_.end()) {
+            return;
+        }
+        auto& latest = values->second.latest;
+        for (auto it = latest.begin(); it != latest.end();) {
+            it = IsMessageRecord(it->first.type) ? latest.erase(it) : std::next(it);
+        }
+        values->second.registrations.clear();
+        return;
+    }
+    default:
+        break;
+    }
+
+    if (key != nullptr) {
+        WidgetValues& values = latest_[header.widget];
+        Latest& latest = values.latest[*key];
+        if (type == RecordType::kMessageRegister) {
+            MessageKey handle;
+            if (latest.header.size != 0 &&
+                ReadMessageKey(latest.header, reinterpret_cast<const unsigned char*>(latest.payload.data()), handle)) {
+                values.registrations.erase(handle.key);
+            }
+            if (ReadMessageKey(header, payload, handle)) {
+                values.registrations[handle.key] = Registration{handle.generation, key->id};
+            }
+        }
+        latest.sequence = ++sequence_;
+        latest.header = header;
+        latest.payload.assign(reinterpret_cast<const char*>(payload), header.size);
+    }
+}
+
+void DeltaBatcher::EraseMessage(std::uint32_t widget, const std::string& id) {
+    auto values = latest_.find(widget);
+    if (values == latest_.end()) {
+        return;
+    }
+    auto& latest = values->second.latest;
+    ValueKey key;
+    key.widget = widget;
+    key.id = id;
+    key.type = static_cast<std::uint16_t>(RecordType::kMessageRegister);
+    if (auto registered = latest.find(key); registered != latest.end()) {
+        MessageKey handle;
+        if (ReadMessageKey(registered->second.header,
+                           reinterpret_cast<const unsigned char*>(registered->second.payload.data()), handle)) {
+            ValueKey handle_key;
+            handle_key.widget = widget;
+            handle_key.type = static_cast<std::uint16_t>(RecordType::kMessageHandleUpsert);
+            handle_key.handle = handle.key;
+            handle_key.generation = handle.generation;
+            latest.erase(handle_key);
+            values->second.registrations.erase(handle.key);
+        }
+        latest.erase(registered);
+    }
+    key.type = static_cast<std::uint16_t>(RecordType::kMessageUpsert);
+    latest.erase(key);
+}
+
+void DeltaBatcher::RemoveSubtree(std::uint32_t id) {
+    auto root = nodes_.find(id);
+    if (root == nodes_.end()) {
+        return;
+    }
+    UnlinkNode(root->second);
+    std::vector<std::uint32_t> pending{id};
+    while (!pending.empty()) {
+        const auto node = nodes_.find(pending.back());
+        pending.pop_back();
+        for (std::uint32_t child = node->second.first_child; child != 0;
+             child = nodes_.find(child)->second.next_sibling) {
+            pending.push_back(child);
+        }
+        latest_.erase(node->first);
+        nodes_.erase(node);
+    }
+}
+
+void DeltaBatcher::LinkNode(std::uint32_t id, Node& node) {
+    node.prev_sibling = 0;
+    node.next_sibling = 0;
+    auto parent = nodes_.find(node.header.parent);
+    if (node.header.parent == id || parent == nodes_.end()) {
+        return;
+    }
+    node.next_sibling = parent->second.first_child;
+    if (node.next_sibling != 0) {
+        nodes_.find(node.next_sibling)->second.prev_sibling = id;
+    }
+    parent->second.first_child = id;
+}
+
+void DeltaBatcher::UnlinkNode(const Node& node) {
+    if (node.prev_sibling != 0) {
+        nodes_.find(node.prev_sibling)->second.next_sibling = node.next_sibling;
+    } else if (auto parent = nodes_.find(node.header.parent);
+               parent != nodes_.end() && parent->second.first_child == node.header.widget) {
+        parent->second.first_child = node.next_sibling;
+    }
+    if (node.next_sibling != 0) {
+        nodes_.find(node.next_sibling)->second.prev_sibling = node.prev_sibling;
+    }
+}
+
+bool DeltaBatcher::EncodeDelta(FrameEncoder& encoder) {
+    for (const Pending& pending : delta_) {
+        if (!pending.live) {
+            continue;
+        }
+        if (pending.header.type == static_cast<std::uint16_t>(RecordType::kGraphValues)) {
+            auto samples = samples_.find(pending.header.widget);
+            if (samples != samples_.end()) {
+                auto node = nodes_.find(pending.header.widget);
+                EncodeSamples(encoder, pending.header.widget, samples->second,
+                              node != nodes_.end() ? static_cast<std::size_t>(node->second.graph_capacity) : 0);
+            }
+            continue;
+        }
+        encoder.Add(pending.header, reinterpret_cast<const unsigned char*>(delta_bytes_.data()) + pending.offset);
+    }
+    return !delta_.empty();
+}
+
+void DeltaBatcher::EncodeSamples(FrameEncoder& encoder,
+                                 std::uint32_t widget,
+                                 const std::vector<float>& samples,
+                                 std::size_t capacity) {
+    std::size_t first = 0;
+    if (capacity != 0 && samples.size() > capacity) {
+        first = samples.size() - capacity;
+    }
+    constexpr std::size_t kChunk = kMaxRecordPayload / sizeof(float);
+    RecordHeader header;
+    header.type = static_cast<std::uint16_t>(RecordType::kGraphValues);
+    header.widget = widget;
+    while (first < samples.size()) {
+        const std::size_t count = std::min(kChunk, samples.size() - first);
+        header.size = static_cast<std::uint32_t>(count * sizeof(float));
+        std::memcpy(encoder.AddUninitialized(header), samples.data() + first, header.size);
+        first += count;
+    }
+}
+
+void DeltaBatcher::ClearDelta() {
+    delta_.clear();
+    delta_bytes_.clear();
+    delta_index_.clear();
+    for (auto it = samples_.begin(); it != samples_.end();) {
+        if (nodes_.count(it->first) == 0) {
+            it = samples_.erase(it);
+        } else {
+            it->second.clear();
+            ++it;
+        }
+    }
+}
+
+void DeltaBatcher::EncodeSnapshot(FrameEncoder& encoder) const {
+    std::vector<const Node*> nodes;
+    nodes.reserve(nodes_.size());
+    for (const auto& [id, node] : nodes_) {
+        nodes.push_back(&node);
+    }
+    std::sort(nodes.begin(), nodes.end(),
+              [](const Node* a, const Node* b) { return a->header.widget < b->header.widget; });
+    for (const Node* node : nodes) {
+        encoder.Add(node->header, reinterpret_cast<const unsigned char*>(node->payload.data()));
+    }
+    for (const Node* node : nodes) {
+        EncodeSamples(encoder, node->header.widget, node->history, node->history_capacity);
+    }
+
+    std::vector<const Latest*> values;
+    for (const auto& [widget, widget_values] : latest_) {
+        for (const auto& [key, latest] : widget_values.latest) {
+            values.push_back(&latest);
+        }
+    }
+    std::sort(values.begin(), values.end(),
+              [](const Latest* a, const Latest* b) { return a->sequence < b->sequence; });
+    for (const Latest* latest : values) {
+        encoder.Add(latest->header, reinterpret_cast<const unsigned char*>(latest->payload.data()));
+    }
+}
+
+}  // namespace debugglass
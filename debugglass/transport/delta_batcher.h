@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "debugglass/transport/frame_codec.h"
+#include "debugglass/transport/record.h"
+
+namespace debugglass {
+
+// Folds the records of a mirrored tree into per-frame deltas and a current
+// snapshot. Within one frame only the last value written to a variable,
+// range, structure or message row is kept, and graph samples are merged
+// into one block per graph, trimmed to what the graph can show. Snapshots
+// also carry each graph's recent samples, up to kMaxSnapshotSamples. Single
+// threaded.
+class DeltaBatcher {
+public:
+    // Bounds the samples a snapshot holds for one (history) graph.
+    static constexpr std::size_t kMaxSnapshotSamples = std::size_t{1} << 16;
+
+    // Whether Add should also collect the current frame's delta. Off while
+    // nobody is listening, leaving only the snapshot state to maintain.
+    void set_collect_deltas(bool collect) noexcept { collect_deltas_ = collect; }
+
+    void Add(const RecordHeader& header, const unsigned char* payload);
+
+    // Encodes the records added since the last call and starts a new frame.
+    // Returns false if nothing changed.
+    bool EncodeDelta(FrameEncoder& encoder);
+    void ClearDelta();
+
+    // Encodes every live node and graph history followed by the latest
+    // values, in the order they were written.
+    void EncodeSnapshot(FrameEncoder& encoder) const;
+
+    std::size_t node_count() const noexcept { return nodes_.size(); }
+    // Records replaced by a later value within the same frame.
+    std::uint64_t coalesced() const noexcept { return coalesced_; }
+
+private:
+    // Identifies what a last-value-wins record overwrites: the widget and
+    // record type, plus the message ID or handle for monitor rows.
+    struct ValueKey {
+        std::uint32_t widget = 0;
+        std::uint16_t type = 0;
+        std::uint64_t handle = 0;
+        std::uint32_t generation = 0;
+        std::string id;
+
+        bool operator==(const ValueKey& other) const {
+            return widget == other.widget && type == other.type && handle == other.handle &&
+                   generation == other.generation && id == other.id;
+        }
+    };
+
+    struct ValueKeyHash {
+        std::size_t operator()(const ValueKey& key) const noexcept;
+    };
+
+    struct Node {
+        RecordHeader header;
+        std::string payload;
+        std::uint64_t graph_capacity = 0;
+        // Recent samples kept for snapshots; holds up to twice
+        // history_capacity so trimming is amortised.
+        std::size_t history_capacity = 0;
+        std::vector<float> history;
+        // Children in the snapshot tree, so removing a subtree only visits
+        // the nodes it removes. Zero, the root, ends a list.
+        std::uint32_t first_child = 0;
+        std::uint32_t prev_sibling = 0;
+        std::uint32_t next_sibling = 0;
+    };
+
+    struct Latest {
+        std::uint64_t sequence = 0;
+        RecordHeader header;
+        std::string payload;
+    };
+
+    // A registered message row, found by its handle's key.
+    struct Registration {
+        std::uint32_t generation = 0;
+        std::string id;
+    };
+
+    // The latest values of one widget, and its message registrations by
+    // handle key, so removals do not scan other widgets' values.
+    struct WidgetValues {
+        std::unordered_map<ValueKey, Latest, ValueKeyHash> latest;
+        std::unordered_map<std::uint64_t, Registration> registrations;
+    };
+
+    // One record of the frame being collected; its payload lives in
+    // delta_bytes_, or in samples_ for merged graph blocks.
+    struct Pending {
+        RecordHeader header;
+        std::size_t offset = 0;
+        bool live = true;
+    };
+
+    // Fills `key` for records that only matter through their last value.
+    static bool KeyFor(const RecordHeader& header, const unsigned char* payload, ValueKey& key);
+
+    void AddToDelta(const RecordHeader& header, const unsigned char* payload, const ValueKey* key);
+    void UpdateState(const RecordHeader& header, const unsigned char* payload, const ValueKey* key);
+    void RemoveSubtree(std::uint32_t id);
+    void LinkNode(std::uint32_t id, Node& node);
+    void UnlinkNode(const Node& node);
+    void EraseMessage(std::uint32_t widget, const std::string& id);
+    // Encodes the last `capacity` of `samples` (all of them if zero).
+    static void EncodeSamples(FrameEncoder& encoder,
+                              std::uint32_t widget,
+                              const std::vector<float>& samples,
+                              std::size_t capacity);
+
+    bool collect_deltas_ = false;
+    std::uint64_t sequence_ = 0;
+    std::uint64_t coalesced_ = 0;
+
+    // Snapshot state: nodes by id, which is also definition order, and the
+    // latest value of everything that has one, by widget.
+    std::unordered_map<std::uint32_t, Node> nodes_;
+    std::unordered_map<std::uint32_t, WidgetValues> latest_;
+
+    std::vector<Pending> delta_;
+    std::string delta_bytes_;
+    std::unordered_map<ValueKey, std::size_t, ValueKeyHash> delta_index_;
+    std::unordered_map<std::uint32_t, std::vector<float>> samples_;
+};
+
+}  // namespace debugglass
@@ -0,0 +1,164 @@
+#include "debugglass/transport/frame_codec.h"
+
+#include <cstring>
+
+namespace debugglass {
+namespace {
+void AppendVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool ReadVarint(const unsigned char*& data, const unsigned char* end, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && data < end; shift += 7) {
+        const unsigned char byte = *data++;
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::uint64_t ZigZag(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t UnZigZag(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+}  // namespace
+
+void FrameEncoder::Begin(std::uint32_t flags, std::uint64_t sequence, std::uint64_t dropped) {
+    start_ = out_.size();
+    records_ = 0;
+    previous_widget_ = 0;
+    flags_ = flags;
+    sequence_ = sequence;
+    dropped_ = dropped;
+    FrameHeader frame;
+    frame.magic = kFrameMagic;
+    frame.flags = flags;
+    frame.sequence = sequence;
+    frame.dropped = dropped;
+    AppendRaw(out_, frame);
+}
+
+void FrameEncoder::AddHeader(const RecordHeader& header) {
+    // Type, flags and three varints take at most this much.
+    constexpr std::size_t kMaxPackedHeader = 2 + 3 * 10;
+    if (split_ && records_ != 0 &&
+        out_.size() - start_ - sizeof(FrameHeader) + kMaxPackedHeader + header.size > kMaxFrameSize) {
+        Finish();
+        const std::uint32_t continued = (flags_ & kFrameSnapshot) != 0 ? kFrameSnapshotContinued : 0;
+        Begin((flags_ & ~kFrameSnapshot) | continued, sequence_, dropped_);
+    }
+    out_.push_back(static_cast<char>(header.type));
+    out_.push_back(static_cast<char>(header.flags));
+    AppendVarint(out_, ZigZag(static_cast<std::int64_t>(header.widget) - previous_widget_));
+    previous_widget_ = header.widget;
+    if (IsDefinition(static_cast<RecordType>(header.type))) {
+        AppendVarint(out_, header.parent);
+    }
+    AppendVarint(out_, header.size);
+    ++records_;
+}
+
+void FrameEncoder::Add(const RecordHeader& header, const unsigned char* payload) {
+    AddHeader(header);
+    out_.append(reinterpret_cast<const char*>(payload), header.size);
+}
+
+unsigned char* FrameEncoder::AddUninitialized(const RecordHeader& header) {
+    AddHeader(header);
+    const std::size_t offset = out_.size();
+    out_.resize(offset + header.size);
+    return reinterpret_cast<unsigned char*>(&out_[offset]);
+}
+
+bool FrameEncoder::Finish() {
+    const std::size_t size = out_.size() - start_ - sizeof(FrameHeader);
+    if (size > kMaxFrameSize) {
+        out_.resize(start_);
+        return false;
+    }
+    FrameHeader frame;
+    std::memcpy(&frame, out_.data() + start_, sizeof(frame));
+    frame.size = static_cast<std::uint32_t>(size);
+    frame.records = records_;
+    std::memcpy(&out_[start_], &frame, sizeof(frame));
+    return true;
+}
+
+bool FrameDecoder::Feed(const unsigned char* data,
+                        std::size_t size,
+                        const FrameVisitor& on_frame,
+                        const RecordVisitor& on_record) {
+    if (corrupt_) {
+        return false;
+    }
+    buffer_.append(reinterpret_cast<const char*>(data), size);
+    std::size_t offset = 0;
+    while (buffer_.size() - offset >= sizeof(FrameHeader)) {
+        FrameHeader frame;
+        std::memcpy(&frame, buffer_.data() + offset, sizeof(frame));
+        if (frame.magic != kFrameMagic || frame.size > kMaxFrameSize) {
+            corrupt_ = true;
+            return false;
+        }
+        if (buffer_.size() - offset - sizeof(frame) < frame.size) {
+            break;
+        }
+        const auto* body = reinterpret_cast<const unsigned char*>(buffer_.data() + offset + sizeof(frame));
+        if (!DecodeFrame(frame, body, on_frame, on_record)) {
+            corrupt_ = true;
+            return false;
+        }
+        offset += sizeof(frame) + frame.size;
+    }
+    buffer_.erase(0, offset);
+    return true;
+}
+
+bool FrameDecoder::DecodeFrame(const FrameHeader& frame,
+                               const unsigned char* body,
+                               const FrameVisitor& on_frame,
+                               const RecordVisitor& on_record) {
+    on_frame(frame);
+    const unsigned char* cursor = body;
+    const unsigned char* end = body + frame.size;
+    std::uint32_t previous_widget = 0;
+    for (std::uint32_t i = 0; i < frame.records; ++i) {
+        if (end - cursor < 2) {
+            return false;
+        }
+        RecordHeader header;
+        header.type = *cursor++;
+        header.flags = *cursor++;
+        std::uint64_t delta = 0;
+        std::uint64_t parent = 0;
+        std::uint64_t size = 0;
+        if (!ReadVarint(cursor, end, delta)) {
+            return false;
+        }
+        header.widget = static_cast<std::uint32_t>(previous_widget + UnZigZag(delta));
+        previous_widget = header.widget;
+        if (IsDefinition(static_cast<RecordType>(header.type)) && !ReadVarint(cursor, end, parent)) {
+            return false;
+        }
+        if (!ReadVarint(cursor, end, size) || size > static_cast<std::uint64_t>(end - cursor)) {
+            return false;
+        }
+        header.parent = static_cast<std::uint32_t>(parent);
+        header.size = static_cast<std::uint32_t>(size);
+        on_record(header, cursor);
+        cursor += size;
+    }
+    return cursor == end;
+}
+
+}  // namespace debugglass
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "debugglass/transport/record.h"
+
+namespace debugglass {
+
+// Stream format used by SocketSink: a sequence of frames, each a FrameHeader
+// followed by `size` bytes of records. Records are RecordHeader + payload
+// with the header packed into a few bytes:
+//
+//   u8 type, u8 flags, varint zigzag(widget - previous widget in frame),
+//   varint parent (definitions only), varint payload size, payload.
+struct FrameHeader {
+    std::uint32_t magic = 0;
+    std::uint32_t flags = 0;
+    std::uint32_t size = 0;
+    std::uint32_t records = 0;
+    std::uint64_t sequence = 0;
+    // Updates the producer lost to overload since it started.
+    std::uint64_t dropped = 0;
+};
+static_assert(sizeof(FrameHeader) == 32, "FrameHeader is part of the wire format");
+
+inline constexpr std::uint32_t kFrameMagic = 0x31464744;  // "DGF1"
+
+// The frame carries the whole tree and the latest value of everything in
+// it; receivers discard what they had before applying it.
+inline constexpr std::uint32_t kFrameSnapshot = 1;
+// The frame continues a snapshot split across frames; receivers apply it on
+// top of the frames before it.
+inline constexpr std::uint32_t kFrameSnapshotContinued = 2;
+
+// Frames larger than this are treated as a corrupt stream.
+inline constexpr std::size_t kMaxFrameSize = std::size_t{64} << 20;
+
+// Appends one frame to a caller-owned buffer.
+class FrameEncoder {
+public:
+    explicit FrameEncoder(std::string& out) : out_(out) {}
+
+    void Begin(std::uint32_t flags, std::uint64_t sequence, std::uint64_t dropped);
+    // Lets a frame that would exceed kMaxFrameSize go on in further frames
+    // with the same sequence. They trade kFrameSnapshot for
+    // kFrameSnapshotContinued, so a receiver applies them on top of the
+    // first. Off by default.
+    void set_split(bool split) noexcept { split_ = split; }
+    void Add(const RecordHeader& header, const unsigned char* payload);
+    // Adds a record whose payload is written by the caller straight into
+    // the buffer: `size` bytes are reserved and returned.
+    unsigned char* AddUninitialized(const RecordHeader& header);
+    // Completes the frame. Returns false, removing it from the buffer again,
+    // if it would exceed kMaxFrameSize.
+    bool Finish();
+
+    // Records in the current frame.
+    std::uint32_t records() const noexcept { return records_; }
+
+private:
+    void AddHeader(const RecordHeader& header);
+
+    std::string& out_;
+    std::size_t start_ = 0;
+    std::uint32_t records_ = 0;
+    std::uint32_t previous_widget_ = 0;
+    bool split_ = false;
+    std::uint32_t flags_ = 0;
+    std::uint64_t sequence_ = 0;
+    std::uint64_t dropped_ = 0;
+};
+
+// Reassembles frames from stream bytes arriving in arbitrary pieces.
+class FrameDecoder {
+public:
+    using FrameVisitor = std::function<void(const FrameHeader& frame)>;
+    using RecordVisitor = std::function<void(const RecordHeader& header, const unsigned char* payload)>;
+
+    // Visits every frame completed by `data`: `on_frame` first, then each of
+    // its records. Returns false once the stream is corrupt; the decoder is
+    // then unusable.
+    bool Feed(const unsigned char* data,
+              std::size_t size,
+              const FrameVisitor& on_frame,
+              const RecordVisitor& on_record);
+
+    // Decodes one frame whose `frame.size` body bytes are already in
+    // memory, e.g. in a mapped recording. Returns false if it is malformed.
+    static bool DecodeFrame(const FrameHeader& frame,
+                            const unsigned char* body,
+                            const FrameVisitor& on_frame,
+                            const RecordVisitor& on_record);
+
+private:
+
+    std::string buffer_;
+    bool corrupt_ = false;
+};
+
+}  // namespace debugglass
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace debugglass {
+
+// Wire format shared by every transport that mirrors a widget tree out of
+// process. A record is a RecordHeader followed by `size` payload bytes in
+// host byte order; both ends are expected to run on the same architecture.
+enum class RecordType : std::uint16_t {
+    // Definitions: announce node `widget` under node `parent` (0 is the
+    // root). The payload starts with the label, then type-specific fields.
+    kWindow = 1,
+    kTab,
+    kStructure,
+    kGraph,
+    kHistoryGraph,
+    kVariable,
+    kTypedVariable,
+    kMessageMonitor,
+    kBoundStructure,
+    kRemove,
+
+    // Updates to an existing node.
+    kGraphValues = 32,
+    kGraphRange,
+    kText,
+    kNumber,
+    kBytes,
+    kMessageRegister,
+    kMessageUpsert,
+    kMessageHandleUpsert,
+    kMessageRemove,
+    kMessageHandleRemove,
+    kMessageClear,
+};
+
+struct RecordHeader {
+    std::uint32_t size = 0;
+    std::uint16_t type = 0;
+    std::uint16_t flags = 0;
+    std::uint32_t widget = 0;
+    std::uint32_t parent = 0;
+};
+static_assert(sizeof(RecordHeader) == 16, "RecordHeader is part of the wire format");
+
+// Largest payload a producer emits in one record; longer graph blocks are
+// split and longer text is truncated.
+inline constexpr std::size_t kMaxRecordPayload = 32 * 1024;
+
+inline bool IsDefinition(RecordType type) noexcept {
+    return static_cast<std::uint16_t>(type) < static_cast<std::uint16_t>(RecordType::kGraphValues);
+}
+
+// Type-specific definition fields, following the label.
+struct GraphParams {
+    std::uint64_t capacity = 0;
+    std::uint32_t producers = 0;  // GraphProducerMode
+    std::uint32_t reserved = 0;
+};
+
+struct HistoryGraphParams {
+    std::uint64_t history = 0;
+};
+
+struct MessageMonitorParams {
+    std::uint64_t shards = 0;
+    std::int64_t ttl_ns = 0;
+    std::uint64_t max_entries = 0;
+};
+
+// Set on message upserts whose value is text rather than a NumberPayload.
+inline constexpr std::uint16_t kRecordFlagText = 1;
+
+// Prefix of kMessageRegister, kMessageHandleUpsert and kMessageHandleRemove:
+// a producer-side MessageMonitor::Handle. kMessageRegister follows it with
+// the ID, the upsert with the value.
+struct MessageKey {
+    std::uint64_t key = 0;  // shard << 32 | index
+    std::uint32_t generation = 0;
+    std::uint32_t reserved = 0;
+};
+
+// kGraphRange payload.
+struct GraphRange {
+    float min_value = 0.0f;
+    float max_value = 0.0f;
+};
+
+// A value of any arithmetic type as carried by kNumber, kTypedVariable and
+// message upserts.
+struct NumberPayload {
+    enum class Kind : std::uint8_t { kBool, kChar, kSigned, kUnsigned, kFloat };
+
+    Kind kind = Kind::kSigned;
+    std::uint8_t reserved[7] = {};
+    std::uint64_t bits = 0;
+
+    template <typename T>
+    static NumberPayload From(T value) noexcept {
+        static_assert(std::is_arithmetic_v<T>, "NumberPayload carries arithmetic types only");
+        NumberPayload payload;
+        payload.kind = KindOf<T>();
+        if constexpr (std::is_floating_point_v<T>) {
+            const double widened = static_cast<double>(value);
+            std::memcpy(&payload.bits, &widened, sizeof(widened));
+        } else if constexpr (std::is_signed_v<T>) {
+            payload.bits = static_cast<std::uint64_t>(static_cast<std::int64_t>(value));
+        } else {
+            payload.bits = static_cast<std::uint64_t>(value);
+        }
+        return payload;
+    }
+
+    template <typename T>
+    static constexpr Kind KindOf() noexcept {
+        if constexpr (std::is_same_v<T, bool>) {
+            return Kind::kBool;
+        } else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+                             std::is_same_v<T, unsigned char>) {
+            return Kind::kChar;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            return Kind::kFloat;
+        } else if constexpr (std::is_signed_v<T>) {
+            return Kind::kSigned;
+        } else {
+            return Kind::kUnsigned;
+        }
+    }
+
+    std::int64_t as_signed() const noexcept { return static_cast<std::int64_t>(bits); }
+    std::uint64_t as_unsigned() const noexcept { return bits; }
+    double as_double() const noexcept {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+static_assert(sizeof(NumberPayload) == 16, "NumberPayload is part of the wire format");
+
+// Sequential decoder for a record payload. Every getter fails, leaving the
+// output untouched, once the payload is exhausted.
+class RecordReader {
+public:
+    RecordReader(const unsigned char* data, std::size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    bool Get(T& out) noexcept {
+        static_assert(std::is_trivially_copyable_v<T>, "RecordReader::Get copies raw bytes");
+        if (size_ - offset_ < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&out, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    // Length-prefixed string as written by AppendString.
+    bool GetString(std::string& out) {
+        std::uint32_t length = 0;
+        if (!Get(length) || size_ - offset_ < length) {
+            return false;
+        }
+        out.assign(reinterpret_cast<const char*>(data_ + offset_), length);
+        offset_ += length;
+        return true;
+    }
+
+    const unsigned char* remaining_data() const noexcept { return data_ + offset_; }
+    std::size_t remaining() const noexcept { return size_ - offset_; }
+
+private:
+    const unsigned char* data_;
+    std::size_t size_;
+    std::size_t offset_ = 0;
+};
+
+template <typename T>
+void AppendRaw(std::string& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "AppendRaw copies raw bytes");
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+inline void AppendString(std::string& out, const std::string& text) {
+    AppendRaw(out, static_cast<std::uint32_t>(text.size()));
+    out.append(text);
+}
+
+}  // namespace debugglass
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+namespace debugglass {
+
+// Session recording file written by SessionRecorder and read by
+// SessionPlayer:
+//
+//   RecordingHeader
+//   chunks   ChunkHeader followed by `size` bytes of frames (frame_codec.h)
+//   index    ChunkIndexEntry per chunk, appended when the recording closes
+//
+// Every frame is one writer tick; its sequence is the tick's time in ns
+// since the recording started. A keyframe chunk begins with a
+// kFrameSnapshot frame holding the whole tree as of its first tick, split
+// into kFrameSnapshotContinued frames when large, so replay can start at any
+// keyframe. A recording whose writer died has no
+// index; the player rebuilds it from the chunk headers.
+struct RecordingHeader {
+    std::uint64_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint32_t reserved = 0;
+    // Wall-clock time of the first tick.
+    std::uint64_t start_unix_ns = 0;
+    // Zero until the recording is closed.
+    std::uint64_t index_offset = 0;
+    std::uint64_t chunk_count = 0;
+    std::uint64_t duration_ns = 0;
+    std::uint64_t records = 0;
+    // Updates the producer wrote faster than the writer could stage them,
+    // or that were too large to encode.
+    std::uint64_t dropped = 0;
+};
+static_assert(sizeof(RecordingHeader) == 64, "RecordingHeader is part of the file format");
+
+inline constexpr std::uint64_t kRecordingMagic = 0x3130304345524744;  // "DGREC001"
+inline constexpr std::uint32_t kRecordingVersion = 1;
+
+struct ChunkHeader {
+    std::uint32_t magic = 0;
+    std::uint32_t flags = 0;
+    std::uint64_t size = 0;
+    std::uint64_t first_time_ns = 0;
+    std::uint64_t last_time_ns = 0;
+    // Number of the keyframe chunk replay must start from to reach this
+    // one; its own number for keyframes.
+    std::uint64_t keyframe = 0;
+};
+static_assert(sizeof(ChunkHeader) == 40, "ChunkHeader is part of the file format");
+
+inline constexpr std::uint32_t kChunkMagic = 0x4B434744;  // "DGCK"
+inline constexpr std::uint32_t kChunkKeyframe = 1;
+
+struct ChunkIndexEntry {
+    std::uint64_t offset = 0;
+    std::uint64_t first_time_ns = 0;
+    std::uint64_t last_time_ns = 0;
+    std::uint64_t keyframe = 0;
+};
+static_assert(sizeof(ChunkIndexEntry) == 32, "ChunkIndexEntry is part of the file format");
+
+}  // namespace debugglass
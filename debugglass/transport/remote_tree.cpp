@@ -0,0 +1,436 @@
+#include "debugglass/transport/remote_tree.h"
+
+#include <chrono>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "debugglass/widgets/bound_structure.h"
+#include "debugglass/widgets/graph.h"
+#include "debugglass/widgets/history_graph.h"
+#include "debugglass/widgets/message_monitor.h"
+#include "debugglass/widgets/structure.h"
+#include "debugglass/widgets/typed_variable.h"
+#include "debugglass/widgets/variable.h"
+
+namespace debugglass {
+namespace {
+template <typename Fn>
+void VisitNumber(const NumberPayload& number, Fn&& fn) {
+    switch (number.kind) {
+    case NumberPayload::Kind::kBool:
+        fn(number.bits != 0);
+        break;
+    case NumberPayload::Kind::kChar:
+        fn(static_cast<char>(number.bits));
+        break;
+    case NumberPayload::Kind::kSigned:
+        fn(number.as_signed());
+        break;
+    case NumberPayload::Kind::kUnsigned:
+        fn(number.as_unsigned());
+        break;
+    case NumberPayload::Kind::kFloat:
+        fn(number.as_double());
+        break;
+    }
+}
+
+bool ValidKind(NumberPayload::Kind kind) {
+    return static_cast<std::uint8_t>(kind) <= static_cast<std::uint8_t>(NumberPayload::Kind::kFloat);
+}
+
+// Decodes a message value, text or number depending on the header flags,
+// and hands it to `fn`.
+template <typename Fn>
+bool WithMessageValue(const RecordHeader& header, RecordReader& reader, Fn&& fn) {
+    if ((header.flags & kRecordFlagText) != 0) {
+        fn(std::string(reinterpret_cast<const char*>(reader.remaining_data()), reader.remaining()));
+        return true;
+    }
+    NumberPayload number;
+    if (!reader.Get(number) || !ValidKind(number.kind)) {
+        return false;
+    }
+    VisitNumber(number, fn);
+    return true;
+}
+
+template <typename T>
+void SetTyped(WindowContent* widget, const NumberPayload& number) {
+    auto* variable = static_cast<TypedVariable<T>*>(widget);
+    VisitNumber(number, [&](auto value) { variable->SetValue(static_cast<T>(value)); });
+}
+
+template <typename Container>
+WindowContent* AddTypedVariable(Container& container, const std::string& label, NumberPayload::Kind kind) {
+    switch (kind) {
+    case NumberPayload::Kind::kBool:
+        return &container.template AddTypedVariable<bool>(label);
+    case NumberPayload::Kind::kChar:
+        return &container.template AddTypedVariable<char>(label);
+    case NumberPayload::Kind::kSigned:
+        return &container.template AddTypedVariable<std::int64_t>(label);
+    case NumberPayload::Kind::kUnsigned:
+        return &container.template AddTypedVariable<std::uint64_t>(label);
+    case NumberPayload::Kind::kFloat:
+        return &container.template AddTypedVariable<double>(label);
+    }
+    return nullptr;
+}
+
+// Widgets both tabs and structures can hold.
+template <typename Container>
+WindowContent* AddCommonWidget(Container& container,
+                               RecordType type,
+                               const std::string& label,
+                               RecordReader& reader,
+                               NumberPayload& initial) {
+    switch (type) {
+    case RecordType::kStructure:
+        return &container.AddStructure(label);
+    case RecordType::kVariable:
+        return &container.AddVariable(label);
+    case RecordType::kTypedVariable:
+        if (!reader.Get(initial) || !ValidKind(initial.kind)) {
+            return nullptr;
+        }
+        return AddTypedVariable(container, label, initial.kind);
+    case RecordType::kBoundStructure: {
+        std::uint64_t size = 0;
+        StructLayout layout;
+        if (!reader.Get(size) || size > kMaxRecordPayload ||
+            !StructLayout::Decode(reader, static_cast<std::size_t>(size), layout)) {
+            return nullptr;
+        }
+        return &container.AddLayoutStructure(label, std::move(layout), static_cast<std::size_t>(size));
+    }
+    default:
+        return nullptr;
+    }
+}
+}  // namespace
+
+RemoteTree::RemoteTree(SubWindowRegistry& windows) : windows_(windows) {}
+
+bool RemoteTree::Apply(const RecordHeader& header, const unsigned char* payload) {
+    RecordReader reader(payload, header.size);
+    const auto type = static_cast<RecordType>(header.type);
+    if (type == RecordType::kRemove) {
+        if (nodes_.count(header.widget) == 0) {
+            return false;
+        }
+        Remove(header.widget);
+        return true;
+    }
+    if (IsDefinition(type)) {
+        return Define(header, reader);
+    }
+    auto found = nodes_.find(header.widget);
+    if (found == nodes_.end()) {
+        return false;
+    }
+    return Update(found->second, header, reader);
+}
+
+void RemoteTree::Reset() {
+    std::vector<std::uint32_t> roots;
+    for (const auto& [id, node] : nodes_) {
+        if (node.parent == 0) {
+            roots.push_back(id);
+        }
+    }
+    for (std::uint32_t id : roots) {
+        Remove(id);
+    }
+    nodes_.clear();
+}
+
+bool RemoteTree::Define(const RecordHeader& header, RecordReader& reader) {
+    std::string label;
+    if (header.widget == 0 || nodes_.count(header.widget) != 0 || !reader.GetString(label)) {
+        return false;
+    }
+    const auto type = static_cast<RecordType>(header.type);
+    Node node;
+    node.type = type;
+    node.parent = header.parent;
+
+    if (type == RecordType::kWindow) {
+        // A window already in the registry belongs to its owner, e.g. the
+        // viewer's own; merging into it would let Remove delete it.
+        if (header.parent != 0 || windows_.TryGet(label) != nullptr) {
+            return false;
+        }
+        node.window = &windows_.Add(label);
+    } else {
+        auto parent = nodes_.find(header.parent);
+        if (parent == nodes_.end()) {
+            return false;
+        }
+        if (type == RecordType::kTab) {
+            if (parent->second.window == nullptr) {
+                return false;
+            }
+            node.tab = &parent->second.window->AddTab(label);
+        } else if (!AddWidget(parent->second, node, label, reader)) {
+            return false;
+        }
+        parent->second.children.push_back(header.widget);
+    }
+    nodes_.emplace(header.widget, std::move(node));
+    return true;
+}
+
+bool RemoteTree::AddWidget(Node& parent, Node& node, const std::string& label, RecordReader& reader) {
+    NumberPayload initial;
+    if (parent.structure != nullptr) {
+        node.widget = AddCommonWidget(*parent.structure, node.type, label, reader, initial);
+    } else if (parent.tab != nullptr) {
+        Tab& tab = *parent.tab;
+        switch (node.type) {
+        case RecordType::kGraph: {
+            GraphParams params;
+            if (!reader.Get(params) || params.capacity == 0 || params.capacity > (std::uint64_t{1} << 26)) {
+                return false;
+            }
+            // Only the viewer's apply thread writes the copy.
+            node.widget = &tab.AddGraph(label, static_cast<std::size_t>(params.capacity),
+                                        GraphProducerMode::kSingleProducer);
+            break;
+        }
+        case RecordType::kHistoryGraph: {
+            HistoryGraphParams params;
+            if (!reader.Get(params) || params.history == 0 || params.history > (std::uint64_t{1} << 28)) {
+                return false;
+            }
+            node.widget = &tab.AddHistoryGraph(label, static_cast<std::size_t>(params.history));
+            break;
+        }
+        case RecordType::kMessageMonitor: {
+            MessageMonitorParams params;
+            if (!reader.Get(params) || params.shards > 1024) {
+                return false;
+            }
+            MessageMonitorOptions options;
+            options.shards = static_cast<std::size_t>(params.shards);
+            options.ttl = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::nanoseconds(params.ttl_ns));
+            options.max_entries = static_cast<std::size_t>(params.max_entries);
+            node.widget = &tab.AddMessageMonitor(label, options);
+            node.messages = std::make_unique<MessageIds>();
+            break;
+        }
+        default:
+            node.widget = AddCommonWidget(tab, node.type, label, reader, initial);
+            break;
+        }
+    }
+    if (node.widget == nullptr) {
+        return false;
+    }
+    if (node.type == RecordType::kStructure) {
+        node.structure = static_cast<Structure*>(node.widget);
+    } else if (node.type == RecordType::kTypedVariable) {
+        node.number_kind = initial.kind;
+        RecordHeader number_header;
+        number_header.type = static_cast<std::uint16_t>(RecordType::kNumber);
+        number_header.size = sizeof(initial);
+        RecordReader initial_reader(reinterpret_cast<const unsigned char*>(&initial), sizeof(initial));
+        Update(node, number_header, initial_reader);
+    }
+    return true;
+}
+
+bool RemoteTree::Update(Node& node, const RecordHeader& header, RecordReader& reader) {
+    switch (static_cast<RecordType>(header.type)) {
+    case RecordType::kGraphValues: {
+        // Payloads carry no alignment guarantee, so the samples are copied
+        // out rather than read in place.
+        samples_.resize(reader.remaining() / sizeof(float));
+        std::memcpy(samples_.data(), reader.remaining_data(), samples_.size() * sizeof(float));
+        if (node.type == RecordType::kGraph) {
+            static_cast<Graph*>(node.widget)->AddValues(samples_.data(), samples_.size());
+        } else if (node.type == RecordType::kHistoryGraph) {
+            static_cast<HistoryGraph*>(node.widget)->AddValues(samples_.data(), samples_.size());
+        } else {
+            return false;
+        }
+        return true;
+    }
+    case RecordType::kGraphRange: {
+        GraphRange range;
+        if (!reader.Get(range)) {
+            return false;
+        }
+        if (node.type == RecordType::kGraph) {
+            static_cast<Graph*>(node.widget)->SetRange(range.min_value, range.max_value);
+        } else if (node.type == RecordType::kHistoryGraph) {
+            static_cast<HistoryGraph*>(node.widget)->SetRange(range.min_value, range.max_value);
+        } else {
+            return false;
+        }
+        return true;
+    }
+    case RecordType::kText:
+        if (node.type != RecordType::kVariable) {
+            return false;
+        }
+        static_cast<Variable*>(node.widget)
+            ->SetValue(std::string(reinterpret_cast<const char*>(reader.remaining_data()), reader.remaining()));
+        return true;
+    case RecordType::kNumber: {
+        NumberPayload number;
+        if (node.type != RecordType::kTypedVariable || !reader.Get(number) || !ValidKind(number.kind)) {
+            return false;
+        }
+        switch (node.number_kind) {
+        case NumberPayload::Kind::kBool:
+            SetTyped<bool>(node.widget, number);
+            break;
+        case NumberPayload::Kind::kChar:
+            SetTyped<char>(node.widget, number);
+            break;
+        case NumberPayload::Kind::kSigned:
+            SetTyped<std::int64_t>(node.widget, number);
+            break;
+        case NumberPayload::Kind::kUnsigned:
+            SetTyped<std::uint64_t>(node.widget, number);
+            break;
+        case NumberPayload::Kind::kFloat:
+            SetTyped<double>(node.widget, number);
+            break;
+        }
+        return true;
+    }
+    case RecordType::kBytes:
+        if (node.type != RecordType::kBoundStructure) {
+            return false;
+        }
+        static_cast<LayoutStructure*>(node.widget)->SetBytes(reader.remaining_data(), reader.remaining());
+        return true;
+    default:
+        return node.messages != nullptr && UpdateMessages(node, header, reader);
+    }
+}
+
+bool RemoteTree::UpdateMessages(Node& node, const RecordHeader& header, RecordReader& reader) {
+    auto* monitor = static_cast<MessageMonitor*>(node.widget);
+    MessageIds& ids = *node.messages;
+    switch (static_cast<RecordType>(header.type)) {
+    case RecordType::kMessageRegister: {
+        MessageKey key;
+        std::string id;
+        if (!reader.Get(key) || !reader.GetString(id)) {
+            return false;
+        }
+        auto& registered = ids.by_key[key.key];
+        if (!registered.id.empty() && registered.id != id) {
+            ids.key_by_id.erase(registered.id);
+        }
+        registered.generation = key.generation;
+        registered.handle = monitor->RegisterId(id);
+        registered.id = id;
+        ids.key_by_id[std::move(id)] = key.key;
+        return true;
+    }
+    case RecordType::kMessageUpsert: {
+        std::string id;
+        if (!reader.GetString(id)) {
+            return false;
+        }
+        return WithMessageValue(header, reader, [&](auto value) { monitor->UpsertMessage(id, std::move(value)); });
+    }
+    case RecordType::kMessageHandleUpsert: {
+        MessageKey key;
+        if (!reader.Get(key)) {
+            return false;
+        }
+        auto found = ids.by_key.find(key.key);
+        if (found == ids.by_key.end() || found->second.generation != key.generation) {
+            return false;
+        }
+        auto& registered = found->second;
+        return WithMessageValue(header, reader, [&](auto value) {
+            // The local copy may have expired the ID; the producer still
+            // holds a live handle, so bring it back.
+            if (!monitor->Upsert(registered.handle, value)) {
+                registered.handle = monitor->RegisterId(registered.id);
+                monitor->Upsert(registered.handle, std::move(value));
+            }
+        });
+    }
+    case RecordType::kMessageHandleRemove: {
+        MessageKey key;
+        if (!reader.Get(key)) {
+            return false;
+        }
+        auto found = ids.by_key.find(key.key);
+        if (found == ids.by_key.end() || found->second.generation != key.generation) {
+            return false;
+        }
+        monitor->RemoveMessage(found->second.id);
+        ids.key_by_id.erase(found->second.id);
+        ids.by_key.erase(found);
+        return true;
+    }
+    case RecordType::kMessageRemove: {
+        const std::string id(reinterpret_cast<const char*>(reader.remaining_data()), reader.remaining());
+        monitor->RemoveMessage(id);
+        if (auto key = ids.key_by_id.find(id); key != ids.key_by_id.end()) {
+            ids.by_key.erase(key->second);
+            ids.key_by_id.erase(key);
+        }
+        return true;
+    }
+    case RecordType::kMessageClear:
+        monitor->Clear();
+        ids.by_key.clear();
+        ids.key_by_id.clear();
+        return true;
+    default:
+        return false;
+    }
+}
+
+void RemoteTree::Remove(std::uint32_t id) {
+    auto found = nodes_.find(id);
+    if (found == nodes_.end()) {
+        return;
+    }
+    Node& node = found->second;
+    if (node.window != nullptr) {
+        windows_.Remove(node.window->name());
+    } else if (auto parent = nodes_.find(node.parent); parent != nodes_.end()) {
+        Node& owner = parent->second;
+        if (node.tab != nullptr && owner.window != nullptr) {
+            owner.window->RemoveTab(*node.tab);
+        } else if (owner.tab != nullptr) {
+            owner.tab->Remove(*node.widget);
+        } else if (owner.structure != nullptr) {
+            owner.structure->Remove(*node.widget);
+        }
+        auto& siblings = owner.children;
+        for (auto it = siblings.begin(); it != siblings.end(); ++it) {
+            if (*it == id) {
+                siblings.erase(it);
+                break;
+            }
+        }
+    }
+    Forget(id);
+}
+
+void RemoteTree::Forget(std::uint32_t id) {
+    auto found = nodes_.find(id);
+    if (found == nodes_.end()) {
+        return;
+    }
+    const std::vector<std::uint32_t> children = std::move(found->second.children);
+    nodes_.erase(found);
+    for (std::uint32_t child : children) {
+        Forget(child);
+    }
+}
+
+}  // namespace debugglass
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "debugglass/subwindow_registry.h"
+#include "debugglass/transport/record.h"
+
+namespace debugglass {
+
+// Rebuilds a widget tree mirrored through an UpdateSink inside a local
+// SubWindowRegistry, whatever transport carried the records. Apply must be
+// called from one thread; rendering may run concurrently, exactly as with an
+// in-process producer. Mirrored windows named like a window already in the
+// registry are ignored.
+class RemoteTree {
+public:
+    explicit RemoteTree(SubWindowRegistry& windows);
+
+    // Applies one record. Returns false, ignoring it, if it is malformed or
+    // refers to a node that was never defined.
+    bool Apply(const RecordHeader& header, const unsigned char* payload);
+
+    // Removes every window this tree created, e.g. when the producer
+    // restarts and node ids start over.
+    void Reset();
+
+    std::size_t node_count() const noexcept { return nodes_.size(); }
+
+private:
+    // Producer-side MessageMonitor handles mapped onto local ones.
+    struct MessageIds {
+        struct Registered {
+            std::uint32_t generation = 0;
+            std::string id;
+            MessageMonitor::Handle handle;
+        };
+        std::unordered_map<std::uint64_t, Registered> by_key;
+        std::unordered_map<std::string, std::uint64_t> key_by_id;
+    };
+
+    struct Node {
+        RecordType type = RecordType::kWindow;
+        std::uint32_t parent = 0;
+        std::vector<std::uint32_t> children;
+        SubWindow* window = nullptr;
+        Tab* tab = nullptr;
+        Structure* structure = nullptr;
+        // Everything that lives in a tab or structure, structures included.
+        WindowContent* widget = nullptr;
+        NumberPayload::Kind number_kind = NumberPayload::Kind::kSigned;
+        std::unique_ptr<MessageIds> messages;
+    };
+
+    bool Define(const RecordHeader& header, RecordReader& reader);
+    bool AddWidget(Node& parent, Node& node, const std::string& label, RecordReader& reader);
+    bool Update(Node& node, const RecordHeader& header, RecordReader& reader);
+    bool UpdateMessages(Node& node, const RecordHeader& header, RecordReader& reader);
+    void Remove(std::uint32_t id);
+    void Forget(std::uint32_t id);
+
+    SubWindowRegistry& windows_;
+    std::unordered_map<std::uint32_t, Node> nodes_;
+    // Scratch for graph samples copied out of unaligned payloads.
+    std::vector<float> samples_;
+};
+
+}  // namespace debugglass
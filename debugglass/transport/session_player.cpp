@@ -0,0 +1,200 @@
+#include "debugglass/transport/session_player.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "debugglass/transport/frame_codec.h"
+
+namespace debugglass {
+
+SessionPlayer::SessionPlayer(const unsigned char* data, std::size_t size) : data_(data), size_(size) {
+    std::memcpy(&header_, data_, sizeof(header_));
+}
+
+SessionPlayer::~SessionPlayer() {
+    munmap(const_cast<unsigned char*>(data_), size_);
+}
+
+std::unique_ptr<SessionPlayer> SessionPlayer::Open(const std::string& path, std::string* error) {
+    const auto fail = [&](const std::string& what) {
+        if (error != nullptr) {
+            *error = path + ": " + what;
+        }
+        return nullptr;
+    };
+
+    const int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        return fail(std::strerror(errno));
+    }
+    struct stat info {};
+    if (fstat(file, &info) != 0) {
+        const int saved = errno;
+        close(file);
+        return fail(std::strerror(saved));
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    if (size < sizeof(RecordingHeader)) {
+        close(file);
+        return fail("not a DebugGlass recording");
+    }
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    if (mapped == MAP_FAILED) {
+        return fail(std::strerror(errno));
+    }
+
+    auto player = std::unique_ptr<SessionPlayer>(new SessionPlayer(static_cast<const unsigned char*>(mapped), size));
+    if (player->header_.magic != kRecordingMagic || player->header_.version != kRecordingVersion) {
+        return fail("not a DebugGlass recording");
+    }
+    if (!player->LoadIndex()) {
+        player->header_.index_offset = 0;
+        player->ScanChunks();
+    }
+    return player;
+}
+
+bool SessionPlayer::LoadIndex() {
+    const std::uint64_t offset = header_.index_offset;
+    const std::uint64_t count = header_.chunk_count;
+    // Every check subtracts only what an earlier one bounded, so a corrupt
+    // header cannot wrap an offset around.
+    if (offset < sizeof(RecordingHeader) || offset > size_ ||
+        count > (size_ - offset) / sizeof(ChunkIndexEntry)) {
+        return false;
+    }
+    chunks_.resize(static_cast<std::size_t>(count));
+    std::memcpy(chunks_.data(), data_ + offset, chunks_.size() * sizeof(ChunkIndexEntry));
+    for (std::size_t i = 0; i < chunks_.size(); ++i) {
+        const ChunkIndexEntry& entry = chunks_[i];
+        ChunkHeader chunk;
+        if (entry.offset < sizeof(RecordingHeader) || entry.offset > offset ||
+            offset - entry.offset < sizeof(chunk) || entry.keyframe > i) {
+            chunks_.clear();
+            return false;
+        }
+        std::memcpy(&chunk, data_ + entry.offset, sizeof(chunk));
+        if (chunk.magic != kChunkMagic || chunk.size > offset - entry.offset - sizeof(chunk)) {
+            chunks_.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+void SessionPlayer::ScanChunks() {
+    // Chunks are whole once their header is, except a last one cut short
+    // by the writer dying; stop there.
+    std::size_t offset = sizeof(RecordingHeader);
+    while (size_ - offset >= sizeof(ChunkHeader)) {
+        ChunkHeader chunk;
+        std::memcpy(&chunk, data_ + offset, sizeof(chunk));
+        if (chunk.magic != kChunkMagic || chunk.size > size_ - offset - sizeof(chunk) ||
+            chunk.keyframe > chunks_.size()) {
+            break;
+        }
+        ChunkIndexEntry entry;
+        entry.offset = offset;
+        entry.first_time_ns = chunk.first_time_ns;
+        entry.last_time_ns = chunk.last_time_ns;
+        entry.keyframe = chunk.keyframe;
+        chunks_.push_back(entry);
+        offset += sizeof(chunk) + static_cast<std::size_t>(chunk.size);
+    }
+}
+
+std::size_t SessionPlayer::ChunkAt(std::uint64_t time_ns) const {
+    const auto after = std::upper_bound(
+        chunks_.begin(), chunks_.end(), time_ns,
+        [](std::uint64_t time, const ChunkIndexEntry& entry) { return time < entry.first_time_ns; });
+    return after == chunks_.begin() ? 0 : static_cast<std::size_t>(after - chunks_.begin() - 1);
+}
+
+void SessionPlayer::AdvanceTo(RemoteTree& tree, std::uint64_t time_ns) {
+    if (!positioned_ || time_ns < position_) {
+        SeekTo(tree, time_ns);
+        return;
+    }
+    if (chunks_.empty()) {
+        return;
+    }
+    // Starting over from a later keyframe is cheaper than playing through
+    // everything before it.
+    if (chunks_[ChunkAt(time_ns)].keyframe > chunk_) {
+        SeekTo(tree, time_ns);
+        return;
+    }
+    Play(tree, time_ns, false);
+}
+
+void SessionPlayer::SeekTo(RemoteTree& tree, std::uint64_t time_ns) {
+    tree.Reset();
+    corrupt_ = false;
+    positioned_ = true;
+    position_ = 0;
+    frame_offset_ = 0;
+    if (chunks_.empty()) {
+        return;
+    }
+    chunk_ = static_cast<std::size_t>(chunks_[ChunkAt(time_ns)].keyframe);
+    Play(tree, time_ns, true);
+}
+
+void SessionPlayer::Play(RemoteTree& tree, std::uint64_t time_ns, bool from_keyframe) {
+    const auto apply = [&](const RecordHeader& header, const unsigned char* payload) { tree.Apply(header, payload); };
+    const auto ignore_frame = [](const FrameHeader&) {};
+
+    while (chunk_ < chunks_.size() && !corrupt_) {
+        const ChunkIndexEntry& entry = chunks_[chunk_];
+        ChunkHeader chunk;
+        std::memcpy(&chunk, data_ + entry.offset, sizeof(chunk));
+        const unsigned char* body = data_ + entry.offset + sizeof(chunk);
+        const auto body_size = static_cast<std::size_t>(chunk.size);
+
+        // A keyframe's snapshot may be split over several leading frames.
+        bool leading = frame_offset_ == 0;
+        while (frame_offset_ < body_size) {
+            FrameHeader frame;
+            if (body_size - frame_offset_ < sizeof(frame)) {
+                corrupt_ = true;
+                break;
+            }
+            std::memcpy(&frame, body + frame_offset_, sizeof(frame));
+            if (frame.magic != kFrameMagic || frame.size > body_size - frame_offset_ - sizeof(frame)) {
+                corrupt_ = true;
+                break;
+            }
+            const bool snapshot = (frame.flags & (kFrameSnapshot | kFrameSnapshotContinued)) != 0;
+            leading = leading && snapshot;
+            if (!snapshot && frame.sequence > time_ns) {
+                position_ = time_ns;
+                return;
+            }
+            // Snapshots only matter when starting from them; in sequence
+            // playback the tree already holds the same state.
+            if (!snapshot || (from_keyframe && leading)) {
+                if (!FrameDecoder::DecodeFrame(frame, body + frame_offset_ + sizeof(frame), ignore_frame, apply)) {
+                    corrupt_ = true;
+                    break;
+                }
+            }
+            frame_offset_ += sizeof(frame) + frame.size;
+        }
+        if (corrupt_) {
+            break;
+        }
+        ++chunk_;
+        frame_offset_ = 0;
+        from_keyframe = false;
+    }
+    position_ = time_ns;
+}
+
+}  // namespace debugglass
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "debugglass/transport/recording.h"
+#include "debugglass/transport/remote_tree.h"
+
+namespace debugglass {
+
+// Replays a SessionRecorder file into a RemoteTree. The file is mapped, not
+// read, so opening a multi-gigabyte recording costs nothing up front, and a
+// seek is a binary search over the chunk index followed by at most one
+// keyframe interval of records. Single threaded, like RemoteTree::Apply.
+class SessionPlayer {
+public:
+    ~SessionPlayer();
+
+    SessionPlayer(const SessionPlayer&) = delete;
+    SessionPlayer& operator=(const SessionPlayer&) = delete;
+
+    // Returns null and fills `error` if `path` is not a recording.
+    static std::unique_ptr<SessionPlayer> Open(const std::string& path, std::string* error = nullptr);
+
+    // Applies every tick up to `time_ns` after the start of the recording.
+    // Moving backwards, or forward past a keyframe, seeks instead.
+    void AdvanceTo(RemoteTree& tree, std::uint64_t time_ns);
+
+    // Resets `tree` and rebuilds it as of `time_ns` from the nearest
+    // keyframe at or before it.
+    void SeekTo(RemoteTree& tree, std::uint64_t time_ns);
+
+    std::uint64_t position_ns() const noexcept { return position_; }
+    std::uint64_t duration_ns() const noexcept { return chunks_.empty() ? 0 : chunks_.back().last_time_ns; }
+    std::uint64_t start_unix_ns() const noexcept { return header_.start_unix_ns; }
+    std::size_t chunk_count() const noexcept { return chunks_.size(); }
+    // Totals the recorder wrote on close; zero for unfinished recordings.
+    std::uint64_t records() const noexcept { return header_.records; }
+    std::uint64_t dropped() const noexcept { return header_.dropped; }
+    // False when the recorder did not close the file and the index was
+    // rebuilt from the chunk headers.
+    bool indexed() const noexcept { return header_.index_offset != 0; }
+    // True once playback stopped at a malformed frame, until the next seek.
+    bool corrupt() const noexcept { return corrupt_; }
+
+private:
+    SessionPlayer(const unsigned char* data, std::size_t size);
+
+    bool LoadIndex();
+    void ScanChunks();
+    // Last chunk whose first tick is at or before `time_ns`.
+    std::size_t ChunkAt(std::uint64_t time_ns) const;
+    // Applies ticks from the current position through `time_ns`. With
+    // `from_keyframe`, the snapshot the current chunk starts with is applied
+    // first.
+    void Play(RemoteTree& tree, std::uint64_t time_ns, bool from_keyframe);
+
+    const unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+    RecordingHeader header_;
+    std::vector<ChunkIndexEntry> chunks_;
+
+    std::size_t chunk_ = 0;
+    // Offset of the next frame within the current chunk's body.
+    std::size_t frame_offset_ = 0;
+    std::uint64_t position_ = 0;
+    bool positioned_ = false;
+    bool corrupt_ = false;
+};
+
+}  // namespace debugglass
@@ -0,0 +1,229 @@
+#include "debugglass/transport/session_recorder.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "debugglass/transport/frame_codec.h"
+
+namespace debugglass {
+namespace {
+// Longest stretch of ticks held back in memory before being written.
+constexpr std::uint64_t kMaxChunkDurationNs = 1000000000;
+}  // namespace
+
+SessionRecorder::SessionRecorder(SessionRecorderOptions options, std::unique_ptr<SharedMemoryRing> staging, int file)
+    : options_(std::move(options)),
+      staging_(std::move(staging)),
+      file_(file),
+      start_(std::chrono::steady_clock::now()) {
+    header_.magic = kRecordingMagic;
+    header_.version = kRecordingVersion;
+    header_.start_unix_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                           std::chrono::system_clock::now().time_since_epoch())
+                                                           .count());
+    WriteAll(&header_, sizeof(header_));
+    offset_ = sizeof(header_);
+    StartChunk();
+    writer_ = std::thread(&SessionRecorder::WriterMain, this);
+}
+
+SessionRecorder::~SessionRecorder() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    Finish();
+    close(file_);
+}
+
+std::unique_ptr<SessionRecorder> SessionRecorder::Create(const SessionRecorderOptions& options, std::string* error) {
+    auto staging = SharedMemoryRing::CreatePrivate(options.staging, error);
+    if (!staging) {
+        return nullptr;
+    }
+    const int file = open(options.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file < 0) {
+        if (error != nullptr) {
+            *error = options.path + ": " + std::strerror(errno);
+        }
+        return nullptr;
+    }
+    auto recorder = std::unique_ptr<SessionRecorder>(new SessionRecorder(options, std::move(staging), file));
+    if (!recorder->ok()) {
+        if (error != nullptr) {
+            *error = options.path + ": cannot write";
+        }
+        return nullptr;
+    }
+    return recorder;
+}
+
+void SessionRecorder::WriteDefinition(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    if (!staging_->AppendDefinition(header, parts, part_count)) {
+        staging_->CountCatalogOverflow();
+        staging_->Publish(header, parts, part_count);
+    }
+}
+
+void SessionRecorder::WriteUpdate(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) {
+    staging_->Publish(header, parts, part_count);
+}
+
+void SessionRecorder::WriterMain() {
+    auto next_tick = std::chrono::steady_clock::now();
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stop_mutex_);
+            if (stop_cv_.wait_until(lock, next_tick, [this] { return stop_; })) {
+                return;
+            }
+        }
+        const auto now = std::chrono::steady_clock::now();
+        next_tick += options_.tick_interval;
+        if (next_tick < now) {
+            next_tick = now + options_.tick_interval;
+        }
+        Tick(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_).count()));
+    }
+}
+
+void SessionRecorder::Tick(std::uint64_t time_ns) {
+    tick_.clear();
+    FrameEncoder encoder(tick_);
+    // A busy tick goes on in further frames with the same time.
+    encoder.set_split(true);
+    encoder.Begin(0, time_ns, cursor_.lost);
+    std::uint64_t records = 0;
+    staging_->Read(
+        cursor_,
+        [&](const RecordHeader& header, const unsigned char* payload) {
+            batcher_.Add(header, payload);
+            encoder.Add(header, payload);
+            ++records;
+        },
+        std::numeric_limits<std::size_t>::max());
+    {
+        std::lock_guard<std::mutex> lock(catalog_mutex_);
+        staging_->RewindCatalog(cursor_);
+    }
+
+    if (records != 0 && !encoder.Finish()) {
+        // Only a single record over the frame limit gets here; the tick's
+        // last frame is lost and counted as dropped.
+        unrecorded_ += encoder.records();
+        records -= encoder.records();
+    }
+    dropped_.store(cursor_.lost + unrecorded_, std::memory_order_relaxed);
+    if (records == 0) {
+        return;
+    }
+    if (chunk_ticks_ == 0) {
+        chunk_header_.first_time_ns = time_ns;
+    }
+    chunk_.append(tick_);
+    ++chunk_ticks_;
+    last_time_ns_ = time_ns;
+    since_keyframe_ += tick_.size();
+    records_.fetch_add(records, std::memory_order_relaxed);
+
+    if (chunk_.size() >= options_.chunk_bytes || time_ns - chunk_header_.first_time_ns >= kMaxChunkDurationNs) {
+        WriteChunk();
+        StartChunk();
+    }
+}
+
+void SessionRecorder::StartChunk() {
+    chunk_.clear();
+    chunk_ticks_ = 0;
+    chunk_header_ = ChunkHeader{};
+    chunk_header_.magic = kChunkMagic;
+    if (keyframe_due_) {
+        // The tree as of the end of the previous chunk, i.e. just before
+        // this chunk's first tick.
+        FrameEncoder snapshot(chunk_);
+        snapshot.set_split(true);
+        snapshot.Begin(kFrameSnapshot, last_time_ns_, cursor_.lost);
+        batcher_.EncodeSnapshot(snapshot);
+        if (!snapshot.Finish()) {
+            // Only a single record over the frame limit gets here; drop the
+            // frames already split off and try again at the next chunk.
+            chunk_.clear();
+        } else {
+            chunk_header_.flags = kChunkKeyframe;
+            keyframe_ = index_.size();
+            last_snapshot_ = chunk_.size();
+            since_keyframe_ = 0;
+            keyframe_due_ = false;
+        }
+    }
+    chunk_header_.keyframe = keyframe_;
+}
+
+void SessionRecorder::WriteChunk() {
+    if (chunk_ticks_ == 0) {
+        return;
+    }
+    chunk_header_.size = chunk_.size();
+    chunk_header_.last_time_ns = last_time_ns_;
+    if (WriteAll(&chunk_header_, sizeof(chunk_header_)) && WriteAll(chunk_.data(), chunk_.size())) {
+        ChunkIndexEntry entry;
+        entry.offset = offset_;
+        entry.first_time_ns = chunk_header_.first_time_ns;
+        entry.last_time_ns = chunk_header_.last_time_ns;
+        entry.keyframe = chunk_header_.keyframe;
+        index_.push_back(entry);
+        offset_ += sizeof(chunk_header_) + chunk_.size();
+    }
+    keyframe_due_ = since_keyframe_ >= std::max<std::uint64_t>(options_.keyframe_bytes, 4 * last_snapshot_);
+}
+
+bool SessionRecorder::WriteAll(const void* data, std::size_t size) {
+    if (!ok_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t written = write(file_, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ok_.store(false, std::memory_order_relaxed);
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+        bytes_written_.fetch_add(static_cast<std::uint64_t>(written), std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void SessionRecorder::Finish() {
+    Tick(static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count()));
+    WriteChunk();
+    if (!WriteAll(index_.data(), index_.size() * sizeof(ChunkIndexEntry))) {
+        return;
+    }
+    header_.index_offset = offset_;
+    header_.chunk_count = index_.size();
+    header_.duration_ns = last_time_ns_;
+    header_.records = records_.load(std::memory_order_relaxed);
+    header_.dropped = cursor_.lost + unrecorded_;
+    if (pwrite(file_, &header_, sizeof(header_), 0) != static_cast<ssize_t>(sizeof(header_))) {
+        ok_.store(false, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace debugglass
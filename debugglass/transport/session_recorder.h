@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "debugglass/transport/delta_batcher.h"
+#include "debugglass/transport/recording.h"
+#include "debugglass/transport/shm_ring.h"
+#include "debugglass/transport/update_sink.h"
+
+namespace debugglass {
+
+struct SessionRecorderOptions {
+    std::string path = "debugglass.dgrec";
+
+    // Staged updates are written once per tick; it is also the time
+    // resolution of the recording.
+    std::chrono::milliseconds tick_interval{5};
+
+    // Lock-free buffer between producers and the writer thread; see
+    // SocketSinkOptions::staging.
+    SharedMemoryOptions staging;
+
+    // A chunk is written once it holds this many bytes or one second of
+    // ticks, whichever comes first.
+    std::size_t chunk_bytes = std::size_t{1} << 20;
+
+    // Bytes of ticks between keyframes, which bounds the work of a seek.
+    // Raised to four times the size of the last snapshot so keyframes of a
+    // large tree never take up more than a fifth of the file.
+    std::size_t keyframe_bytes = std::size_t{16} << 20;
+};
+
+// UpdateSink that records every write of a mirrored tree to an append-only,
+// chunk-indexed file for SessionPlayer; see recording.h. Producers only
+// copy records into a lock-free staging ring; a background thread encodes
+// them and does all file I/O. Unlike the socket transport nothing is
+// coalesced: every staged update is kept.
+class SessionRecorder : public UpdateSink {
+public:
+    // Writes the remaining ticks and the chunk index.
+    ~SessionRecorder() override;
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    // Creates or truncates options.path and starts the writer thread.
+    // Returns null and fills `error` if the file cannot be created.
+    static std::unique_ptr<SessionRecorder> Create(const SessionRecorderOptions& options,
+                                                   std::string* error = nullptr);
+
+    void WriteDefinition(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) override;
+    void WriteUpdate(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) override;
+
+    std::uint64_t records() const noexcept { return records_.load(std::memory_order_relaxed); }
+    std::uint64_t bytes_written() const noexcept { return bytes_written_.load(std::memory_order_relaxed); }
+    // Staged updates overwritten before the writer thread got to them, or
+    // too large to encode.
+    std::uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+    // False once a write to the file failed; nothing more is recorded.
+    bool ok() const noexcept { return ok_.load(std::memory_order_relaxed); }
+
+private:
+    SessionRecorder(SessionRecorderOptions options, std::unique_ptr<SharedMemoryRing> staging, int file);
+
+    void WriterMain();
+    // Drains the staging ring into one tick frame stamped `time_ns`.
+    void Tick(std::uint64_t time_ns);
+    void StartChunk();
+    void WriteChunk();
+    bool WriteAll(const void* data, std::size_t size);
+    void Finish();
+
+    SessionRecorderOptions options_;
+    std::unique_ptr<SharedMemoryRing> staging_;
+    std::mutex catalog_mutex_;
+    int file_ = -1;
+    std::chrono::steady_clock::time_point start_;
+    RecordingHeader header_;
+
+    // Writer thread state.
+    SharedMemoryCursor cursor_;
+    DeltaBatcher batcher_;
+    std::string tick_;
+    std::string chunk_;
+    ChunkHeader chunk_header_;
+    std::uint64_t chunk_ticks_ = 0;
+    std::uint64_t offset_ = 0;
+    std::uint64_t last_time_ns_ = 0;
+    std::uint64_t keyframe_ = 0;
+    std::uint64_t since_keyframe_ = 0;
+    std::uint64_t last_snapshot_ = 0;
+    // Records read from staging but lost because they could not be encoded.
+    std::uint64_t unrecorded_ = 0;
+    bool keyframe_due_ = true;
+    std::vector<ChunkIndexEntry> index_;
+
+    std::atomic<std::uint64_t> records_{0};
+    std::atomic<std::uint64_t> bytes_written_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<bool> ok_{true};
+
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool stop_ = false;
+    std::thread writer_;
+};
+
+}  // namespace debugglass
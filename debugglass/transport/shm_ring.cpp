@@ -0,0 +1,765 @@
+#include "debugglass/transport/shm_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <random>
+#include <unordered_map>
+#include <utility>
+
+namespace debugglass {
+namespace {
+constexpr std::uint64_t kMagic = 0x5353414c47474244ull;  // "DBGGLASS"
+constexpr std::uint32_t kVersion = 2;
+constexpr std::size_t kSlotWords = 7;
+constexpr std::size_t kSlotPayload = kSlotWords * sizeof(std::uint64_t);
+constexpr std::size_t kCatalogAlignment = 8;
+
+constexpr std::size_t RoundUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+constexpr std::uint64_t SlotsFor(std::size_t payload_size) {
+    return (sizeof(RecordHeader) + payload_size + kSlotPayload - 1) / kSlotPayload;
+}
+
+// The largest record must fit in well under half the ring, where a viewer
+// starts giving up on slots a producer has not finished.
+constexpr std::size_t kMinSlots = 8 * SlotsFor(kMaxRecordPayload);
+
+// A slot's sequence: the ring position it holds plus one, shifted, with the
+// low bit marking the first slot of a record. Zero while being written.
+constexpr std::uint64_t Stamp(std::uint64_t position, bool first) {
+    return ((position + 1) << 1) | (first ? 1u : 0u);
+}
+
+// Share of the catalog kept free for removals, so compaction can learn
+// about them once definitions no longer fit.
+constexpr std::size_t kRemovalReserve = 16;
+
+// Catalog records that let a compaction drop earlier definitions.
+bool FreesCatalog(RecordType type) {
+    return type == RecordType::kRemove || type == RecordType::kMessageRemove ||
+           type == RecordType::kMessageHandleRemove || type == RecordType::kMessageClear;
+}
+
+std::size_t NextPowerOfTwo(std::size_t value) {
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Walks a gathered payload in arbitrary-sized steps.
+class PayloadCursor {
+public:
+    PayloadCursor(const PayloadPart* parts, std::size_t count) : parts_(parts), count_(count) {}
+
+    void CopyTo(unsigned char* out, std::size_t size) {
+        while (size > 0 && part_ < count_) {
+            const PayloadPart& part = parts_[part_];
+            const std::size_t chunk = std::min(size, part.size - offset_);
+            std::memcpy(out, static_cast<const unsigned char*>(part.data) + offset_, chunk);
+            out += chunk;
+            size -= chunk;
+            offset_ += chunk;
+            if (offset_ == part.size) {
+                ++part_;
+                offset_ = 0;
+            }
+        }
+    }
+
+private:
+    const PayloadPart* parts_;
+    std::size_t count_;
+    std::size_t part_ = 0;
+    std::size_t offset_ = 0;
+};
+
+void SetError(std::string* error, std::string message) {
+    if (error != nullptr) {
+        *error = std::move(message);
+    }
+}
+
+std::string ErrnoMessage(const char* what, const std::string& name) {
+    return std::string(what) + " " + name + ": " + std::strerror(errno);
+}
+}  // namespace
+
+struct SharedMemoryRing::Header {
+    // Stored last by the creator, so a viewer never attaches to a half
+    // initialised segment.
+    std::atomic<std::uint64_t> magic;
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t session;
+    std::uint64_t slot_count;
+    // Of each catalog half.
+    std::uint64_t catalog_capacity;
+    std::uint64_t catalog_offset;
+    std::uint64_t slots_offset;
+
+    // catalog_epoch & 1 selects the catalog half definitions are appended
+    // to. Compaction stores epoch + 1 to catalog_writing, fills the other
+    // half, then stores it to catalog_epoch; a viewer that finds the two
+    // different from the epoch it reads starts over.
+    alignas(64) std::atomic<std::uint64_t> catalog_epoch;
+    std::atomic<std::uint64_t> catalog_writing;
+    std::atomic<std::uint64_t> catalog_size[2];
+    std::atomic<std::uint64_t> catalog_overflows;
+
+    // Producers contend on this line only.
+    alignas(64) std::atomic<std::uint64_t> head;
+};
+
+struct alignas(64) SharedMemoryRing::Slot {
+    std::atomic<std::uint64_t> seq;
+    std::atomic<std::uint64_t> words[kSlotWords];
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "shared-memory atomics must not depend on process-local locks");
+
+SharedMemoryRing::~SharedMemoryRing() {
+    if (base_ != nullptr) {
+        munmap(base_, size_);
+    }
+    if (!unlink_name_.empty()) {
+        shm_unlink(unlink_name_.c_str());
+    }
+}
+
+std::string SharedMemoryRing::SegmentName(const std::string& name) {
+    return !name.empty() && name[0] == '/' ? name : "/" + name;
+}
+
+SharedMemoryRing::Layout SharedMemoryRing::LayoutFor(const SharedMemoryOptions& options) {
+    static_assert(sizeof(Slot) == 64, "one slot per cache line");
+    Layout layout;
+    layout.slot_count = NextPowerOfTwo(std::max(options.ring_slots, kMinSlots));
+    layout.catalog_offset = RoundUp(sizeof(Header), 64);
+    layout.catalog_capacity = RoundUp(options.catalog_bytes / 2, 64);
+    layout.slots_offset = layout.catalog_offset + 2 * layout.catalog_capacity;
+    layout.size = layout.slots_offset + layout.slot_count * sizeof(Slot);
+    return layout;
+}
+
+std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Create(const std::string& name,
+                                                           const SharedMemoryOptions& options,
+                                                           std::string* error) {
+    const std::string segment = SegmentName(name);
+    const Layout layout = LayoutFor(options);
+
+    int fd = shm_open(segment.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        // Left behind by a producer that did not shut down cleanly.
+        shm_unlink(segment.c_str());
+        fd = shm_open(segment.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        SetError(error, ErrnoMessage("shm_open", segment));
+        return nullptr;
+    }
+    if (ftruncate(fd, static_cast<off_t>(layout.size)) != 0) {
+        SetError(error, ErrnoMessage("ftruncate", segment));
+        close(fd);
+        shm_unlink(segment.c_str());
+        return nullptr;
+    }
+    void* base = mmap(nullptr, layout.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        SetError(error, ErrnoMessage("mmap", segment));
+        shm_unlink(segment.c_str());
+        return nullptr;
+    }
+
+    auto ring = Format(base, layout);
+    ring->unlink_name_ = segment;
+    return ring;
+}
+
+std::unique_ptr<SharedMemoryRing> SharedMemoryRing::CreatePrivate(const SharedMemoryOptions& options,
+                                                                  std::string* error) {
+    const Layout layout = LayoutFor(options);
+    void* base = mmap(nullptr, layout.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        SetError(error, ErrnoMessage("mmap", "staging ring"));
+        return nullptr;
+    }
+    return Format(base, layout);
+}
+
+std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Format(void* base, const Layout& layout) {
+    std::unique_ptr<SharedMemoryRing> ring(new SharedMemoryRing());
+    ring->base_ = base;
+    ring->size_ = layout.size;
+
+    auto* header = new (base) Header();
+    header->version = kVersion;
+    header->session = (static_cast<std::uint64_t>(std::random_device{}()) << 32) ^
+                      static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    header->slot_count = layout.slot_count;
+    header->catalog_capacity = layout.catalog_capacity;
+    header->catalog_offset = layout.catalog_offset;
+    header->slots_offset = layout.slots_offset;
+    auto* slots = reinterpret_cast<Slot*>(static_cast<unsigned char*>(base) + layout.slots_offset);
+    for (std::size_t i = 0; i < layout.slot_count; ++i) {
+        new (&slots[i]) Slot();
+    }
+    header->magic.store(kMagic, std::memory_order_release);
+
+    ring->Attach(base, layout.size, nullptr);
+    return ring;
+}
+
+std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Open(const std::string& name, std::string* error) {
+    const std::string segment = SegmentName(name);
+    const int fd = shm_open(segment.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        SetError(error, ErrnoMessage("shm_open", segment));
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        SetError(error, ErrnoMessage("fstat", segment));
+        close(fd);
+        return nullptr;
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void* base = size == 0 ? MAP_FAILED : mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        SetError(error, size == 0 ? segment + " is not initialised yet" : ErrnoMessage("mmap", segment));
+        return nullptr;
+    }
+
+    std::unique_ptr<SharedMemoryRing> ring(new SharedMemoryRing());
+    ring->base_ = base;
+    ring->size_ = size;
+    if (!ring->Attach(base, size, error)) {
+        return nullptr;
+    }
+    return ring;
+}
+
+bool SharedMemoryRing::Attach(void* base, std::size_t size, std::string* error) {
+    auto* bytes = static_cast<unsigned char*>(base);
+    auto* header = static_cast<Header*>(base);
+    if (size < sizeof(Header) || header->magic.load(std::memory_order_acquire) != kMagic) {
+        SetError(error, "not a DebugGlass segment, or not initialised yet");
+        return false;
+    }
+    if (header->version != kVersion) {
+        SetError(error, "unsupported segment version " + std::to_string(header->version));
+        return false;
+    }
+    const std::uint64_t slot_count = header->slot_count;
+    if (slot_count < kMinSlots || (slot_count & (slot_count - 1)) != 0 ||
+        header->catalog_offset < sizeof(Header) ||
+        header->catalog_capacity > (size - header->catalog_offset) / 2 ||
+        header->slots_offset < header->catalog_offset + 2 * header->catalog_capacity ||
+        header->slots_offset > size || slot_count > (size - header->slots_offset) / sizeof(Slot)) {
+        SetError(error, "corrupt segment layout");
+        return false;
+    }
+    header_ = header;
+    catalog_ = bytes + header->catalog_offset;
+    slots_ = reinterpret_cast<Slot*>(bytes + header->slots_offset);
+    slot_mask_ = slot_count - 1;
+    return true;
+}
+
+bool SharedMemoryRing::AppendDefinition(const RecordHeader& header,
+                                        const PayloadPart* parts,
+                                        std::size_t part_count,
+                                        std::size_t reserve) {
+    const std::uint64_t epoch = header_->catalog_epoch.load(std::memory_order_relaxed);
+    std::atomic<std::uint64_t>& catalog_size = header_->catalog_size[epoch & 1];
+    const std::uint64_t used = catalog_size.load(std::memory_order_relaxed);
+    const std::uint64_t appended_at = header_->head.load(std::memory_order_relaxed);
+    const std::size_t total = RoundUp(sizeof(appended_at) + sizeof(RecordHeader) + header.size, kCatalogAlignment);
+    if (total + reserve > header_->catalog_capacity - used) {
+        return false;
+    }
+    // Stamped with the ring position so viewers apply it after every update
+    // claimed before it, e.g. an upsert followed by removing the same ID.
+    unsigned char* out = CatalogHalf(epoch) + used;
+    std::memcpy(out, &appended_at, sizeof(appended_at));
+    std::memcpy(out + sizeof(appended_at), &header, sizeof(header));
+    PayloadCursor(parts, part_count).CopyTo(out + sizeof(appended_at) + sizeof(header), header.size);
+    catalog_size.store(used + total, std::memory_order_release);
+    return true;
+}
+
+void SharedMemoryRing::CountCatalogOverflow() noexcept {
+    header_->catalog_overflows.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool SharedMemoryRing::CompactCatalog(std::size_t min_freed) {
+    struct Entry {
+        const unsigned char* data = nullptr;
+        std::uint64_t appended_at = 0;
+        RecordHeader header;
+        bool live = true;
+    };
+    // Message rows of one monitor: registration entries by ID, and the ID
+    // and generation each handle key was registered with.
+    struct Rows {
+        std::unordered_map<std::string, std::size_t> by_id;
+        std::unordered_map<std::uint64_t, std::pair<std::uint32_t, std::string>> by_handle;
+    };
+
+    const std::uint64_t epoch = header_->catalog_epoch.load(std::memory_order_relaxed);
+    const std::uint64_t size = header_->catalog_size[epoch & 1].load(std::memory_order_relaxed);
+    const unsigned char* catalog = CatalogHalf(epoch);
+    std::vector<Entry> entries;
+    for (std::uint64_t offset = 0; offset < size;) {
+        Entry entry;
+        entry.data = catalog + offset;
+        std::memcpy(&entry.appended_at, entry.data, sizeof(entry.appended_at));
+        std::memcpy(&entry.header, entry.data + sizeof(entry.appended_at), sizeof(entry.header));
+        offset += RoundUp(sizeof(entry.appended_at) + sizeof(entry.header) + entry.header.size, kCatalogAlignment);
+        entries.push_back(entry);
+    }
+
+    std::unordered_map<std::uint32_t, std::size_t> nodes;
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> children;
+    std::unordered_map<std::uint32_t, Rows> rows;
+    const auto clear_rows = [&](std::uint32_t widget) {
+        auto found = rows.find(widget);
+        if (found == rows.end()) {
+            return;
+        }
+        for (const auto& [id, index] : found->second.by_id) {
+            entries[index].live = false;
+        }
+        rows.erase(found);
+    };
+    const auto remove_row = [&](std::uint32_t widget, const std::string& id) {
+        auto found = rows.find(widget);
+        if (found == rows.end()) {
+            return;
+        }
+        if (auto row = found->second.by_id.find(id); row != found->second.by_id.end()) {
+            entries[row->second].live = false;
+            found->second.by_id.erase(row);
+        }
+    };
+    const auto remove_node = [&](std::uint32_t root) {
+        std::vector<std::uint32_t> pending{root};
+        while (!pending.empty()) {
+            const std::uint32_t id = pending.back();
+            pending.pop_back();
+            auto node = nodes.find(id);
+            if (node == nodes.end()) {
+                continue;
+            }
+            entries[node->second].live = false;
+            nodes.erase(node);
+            clear_rows(id);
+            if (auto found = children.find(id); found != children.end()) {
+                for (std::uint32_t child : found->second) {
+                    // Skip children since redefined under another parent.
+                    auto child_node = nodes.find(child);
+                    if (child_node != nodes.end() && entries[child_node->second].header.parent == id) {
+                        pending.push_back(child);
+                    }
+                }
+                children.erase(found);
+            }
+        }
+    };
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        Entry& entry = entries[i];
+        const auto type = static_cast<RecordType>(entry.header.type);
+        const std::uint32_t widget = entry.header.widget;
+        RecordReader reader(entry.data + sizeof(entry.appended_at) + sizeof(entry.header), entry.header.size);
+        switch (type) {
+        case RecordType::kRemove:
+            entry.live = false;
+            remove_node(widget);
+            break;
+        case RecordType::kMessageRegister: {
+            MessageKey key;
+            std::string id;
+            if (nodes.count(widget) == 0 || !reader.Get(key) || !reader.GetString(id)) {
+                entry.live = false;
+                break;
+            }
+            Rows& widget_rows = rows[widget];
+            auto [row, inserted] = widget_rows.by_id.try_emplace(id, i);
+            if (!inserted) {
+                entries[row->second].live = false;
+                row->second = i;
+            }
+            widget_rows.by_handle[key.key] = {key.generation, std::move(id)};
+            break;
+        }
+        case RecordType::kMessageRemove:
+            remove_row(widget, std::string(reinterpret_cast<const char*>(reader.remaining_data()), entry.header.size));
+            break;
+        case RecordType::kMessageHandleRemove: {
+            // Handle upserts of a removed row find no registration anyway.
+            entry.live = false;
+            MessageKey key;
+            auto found = rows.find(widget);
+            if (found == rows.end() || !reader.Get(key)) {
+                break;
+            }
+            auto handle = found->second.by_handle.find(key.key);
+            if (handle != found->second.by_handle.end() && handle->second.first == key.generation) {
+                remove_row(widget, handle->second.second);
+                found->second.by_handle.erase(handle);
+            }
+            break;
+        }
+        case RecordType::kMessageClear:
+            clear_rows(widget);
+            break;
+        default:
+            if (!IsDefinition(type)) {
+                break;
+            }
+            if (auto node = nodes.find(widget); node != nodes.end()) {
+                entries[node->second].live = false;
+                if (entries[node->second].header.parent != entry.header.parent) {
+                    children[entry.header.parent].push_back(widget);
+                }
+                node->second = i;
+            } else {
+                nodes.emplace(widget, i);
+                children[entry.header.parent].push_back(widget);
+            }
+            break;
+        }
+    }
+
+    // Removals by ID only matter while the ring may still hold an upsert
+    // of that ID from before them, which a new viewer would replay.
+    const std::uint64_t head = header_->head.load(std::memory_order_relaxed);
+    const std::uint64_t slot_count = slot_mask_ + 1;
+    std::uint64_t compacted = 0;
+    for (Entry& entry : entries) {
+        const auto type = static_cast<RecordType>(entry.header.type);
+        if (entry.live && (type == RecordType::kMessageRemove || type == RecordType::kMessageClear)) {
+            entry.live = nodes.count(entry.header.widget) != 0 && entry.appended_at + slot_count > head;
+        }
+        if (entry.live) {
+            compacted += RoundUp(sizeof(entry.appended_at) + sizeof(entry.header) + entry.header.size,
+                                 kCatalogAlignment);
+        }
+    }
+    if (size - compacted < min_freed) {
+        return false;
+    }
+
+    // Entries keep their stamps and order, so viewers apply them exactly as
+    // they would have the full catalog.
+    const std::uint64_t next = epoch + 1;
+    header_->catalog_writing.store(next, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    unsigned char* out = CatalogHalf(next);
+    std::uint64_t used = 0;
+    for (const Entry& entry : entries) {
+        if (!entry.live) {
+            continue;
+        }
+        const std::size_t bytes = sizeof(entry.appended_at) + sizeof(entry.header) + entry.header.size;
+        std::memcpy(out + used, entry.data, bytes);
+        used += RoundUp(bytes, kCatalogAlignment);
+    }
+    header_->catalog_size[next & 1].store(used, std::memory_order_relaxed);
+    header_->catalog_epoch.store(next, std::memory_order_release);
+    return true;
+}
+
+void SharedMemoryRing::Publish(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) {
+    if (header.size > kMaxRecordPayload) {
+        return;
+    }
+    const std::uint64_t count = SlotsFor(header.size);
+    const std::uint64_t first = header_->head.fetch_add(count, std::memory_order_relaxed);
+    WriteSlots(first, count, header, parts, part_count);
+}
+
+void SharedMemoryRing::WriteSlots(std::uint64_t first,
+                                  std::uint64_t count,
+                                  const RecordHeader& header,
+                                  const PayloadPart* parts,
+                                  std::size_t part_count) {
+    // Same three phases as SampleRing::PushBatchConcurrent: invalidate,
+    // fill, stamp. A viewer that copied a slot while it was refilled sees
+    // its sequence change and drops the record.
+    for (std::uint64_t i = 0; i < count; ++i) {
+        slots_[(first + i) & slot_mask_].seq.store(0, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    PayloadCursor payload(parts, part_count);
+    std::size_t remaining = sizeof(RecordHeader) + header.size;
+    for (std::uint64_t i = 0; i < count; ++i) {
+        unsigned char bytes[kSlotPayload] = {};
+        std::size_t used = 0;
+        if (i == 0) {
+            std::memcpy(bytes, &header, sizeof(header));
+            used = sizeof(header);
+        }
+        const std::size_t chunk = std::min(kSlotPayload, remaining) - used;
+        payload.CopyTo(bytes + used, chunk);
+        remaining -= used + chunk;
+
+        Slot& slot = slots_[(first + i) & slot_mask_];
+        for (std::size_t w = 0; w < kSlotWords; ++w) {
+            std::uint64_t word;
+            std::memcpy(&word, bytes + w * sizeof(word), sizeof(word));
+            slot.words[w].store(word, std::memory_order_relaxed);
+        }
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::uint64_t i = 0; i < count; ++i) {
+        slots_[(first + i) & slot_mask_].seq.store(Stamp(first + i, i == 0), std::memory_order_relaxed);
+    }
+}
+
+std::size_t SharedMemoryRing::Read(SharedMemoryCursor& cursor, const RecordVisitor& visit, std::size_t max_records) const {
+    const std::uint64_t writing = header_->catalog_writing.load(std::memory_order_acquire);
+    if (cursor.attached && writing != cursor.catalog_epoch) {
+        // The catalog was compacted: start over as a newly attached viewer,
+        // once the caller has discarded its tree.
+        cursor.attached = false;
+        cursor.catalog_offset = 0;
+        ++cursor.catalog_resets;
+        return 0;
+    }
+    if (!cursor.attached) {
+        const std::uint64_t epoch = header_->catalog_epoch.load(std::memory_order_acquire);
+        if (epoch != writing) {
+            // Compaction in progress.
+            return 0;
+        }
+        cursor.catalog_epoch = epoch;
+    }
+
+    const std::uint64_t slot_count = slot_mask_ + 1;
+    const std::uint64_t head = header_->head.load(std::memory_order_acquire);
+    if (!cursor.attached || head - cursor.tail > slot_count) {
+        // First read, or lapped: start half a ring back, where slots are
+        // long finished but not about to be overwritten.
+        const std::uint64_t start = head > slot_count / 2 ? head - slot_count / 2 : 0;
+        if (cursor.attached) {
+            cursor.lost += start - cursor.tail;
+        }
+        cursor.tail = start;
+        cursor.attached = true;
+    }
+    cursor.scratch.resize(SlotsFor(kMaxRecordPayload) * kSlotPayload);
+
+    std::size_t visited = 0;
+    std::size_t updates = 0;
+    while (updates < max_records) {
+        std::uint64_t count = 0;
+        const SlotRead read = cursor.tail < head ? ReadRecord(cursor, head, count) : SlotRead::kWait;
+        if (read == SlotRead::kSkipped) {
+            ++cursor.tail;
+            ++cursor.lost;
+            continue;
+        }
+        // Definitions appended before this record was claimed come first.
+        // Checked after ReadRecord, whose acquire makes every definition the
+        // record's producer appended before it visible here.
+        if (!ReadDefinitions(cursor, cursor.tail, visit, visited) || read == SlotRead::kWait) {
+            break;
+        }
+        RecordHeader header;
+        std::memcpy(&header, cursor.scratch.data(), sizeof(header));
+        visit(header, cursor.scratch.data() + sizeof(header));
+        cursor.tail += count;
+        ++updates;
+    }
+    return visited + updates;
+}
+
+bool SharedMemoryRing::ReadDefinitions(SharedMemoryCursor& cursor,
+                                       std::uint64_t position,
+                                       const RecordVisitor& visit,
+                                       std::size_t& visited) const {
+    const std::uint64_t size = header_->catalog_size[cursor.catalog_epoch & 1].load(std::memory_order_acquire);
+    if (size > header_->catalog_capacity) {
+        return true;
+    }
+    const unsigned char* catalog = CatalogHalf(cursor.catalog_epoch);
+    while (cursor.catalog_offset + sizeof(std::uint64_t) + sizeof(RecordHeader) <= size) {
+        const unsigned char* entry = catalog + cursor.catalog_offset;
+        std::uint64_t appended_at;
+        std::memcpy(&appended_at, entry, sizeof(appended_at));
+        RecordHeader header;
+        std::memcpy(&header, entry + sizeof(appended_at), sizeof(header));
+        const std::uint64_t end = cursor.catalog_offset + sizeof(appended_at) + sizeof(header) + header.size;
+        if (end <= size) {
+            cursor.definition.resize(std::max<std::size_t>(cursor.definition.size(), header.size));
+            std::memcpy(cursor.definition.data(), entry + sizeof(appended_at) + sizeof(header), header.size);
+        }
+        // Compaction may be rewriting this half if the cursor is an epoch
+        // behind; what was copied is only valid if it has not started.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header_->catalog_writing.load(std::memory_order_relaxed) != cursor.catalog_epoch) {
+            return false;
+        }
+        if (appended_at > position) {
+            break;
+        }
+        if (end > size) {
+            cursor.catalog_offset = size;
+            break;
+        }
+        visit(header, cursor.definition.data());
+        cursor.catalog_offset = RoundUp(end, kCatalogAlignment);
+        ++visited;
+    }
+    return true;
+}
+
+unsigned char* SharedMemoryRing::CatalogHalf(std::uint64_t epoch) const noexcept {
+    return catalog_ + (epoch & 1) * header_->catalog_capacity;
+}
+
+SharedMemoryRing::SlotRead SharedMemoryRing::ReadRecord(SharedMemoryCursor& cursor,
+                                                        std::uint64_t head,
+                                                        std::uint64_t& count) const {
+    const std::uint64_t tail = cursor.tail;
+    // A slot still unwritten this far behind head belongs to a producer
+    // that stalled or died mid-record; skip it rather than wait forever.
+    const bool abandoned = head - tail > (slot_mask_ + 1) / 2;
+    const auto unwritten = [&](std::uint64_t seq, std::uint64_t position) {
+        return (seq >> 1) < position + 1 && !abandoned;
+    };
+    const auto copy_slot = [&](std::uint64_t index) {
+        const Slot& slot = slots_[(tail + index) & slot_mask_];
+        for (std::size_t w = 0; w < kSlotWords; ++w) {
+            const std::uint64_t word = slot.words[w].load(std::memory_order_relaxed);
+            std::memcpy(cursor.scratch.data() + index * kSlotPayload + w * sizeof(word), &word, sizeof(word));
+        }
+    };
+
+    const std::uint64_t seq = slots_[tail & slot_mask_].seq.load(std::memory_order_acquire);
+    if (seq != Stamp(tail, true)) {
+        // Unless not yet written, it was overwritten, abandoned, or is the
+        // rest of a record whose start was lost.
+        return unwritten(seq, tail) ? SlotRead::kWait : SlotRead::kSkipped;
+    }
+    copy_slot(0);
+    RecordHeader header;
+    std::memcpy(&header, cursor.scratch.data(), sizeof(header));
+    if (header.size > kMaxRecordPayload) {
+        return SlotRead::kSkipped;
+    }
+    count = SlotsFor(header.size);
+    if (tail + count > head) {
+        return abandoned ? SlotRead::kSkipped : SlotRead::kWait;
+    }
+    for (std::uint64_t i = 1; i < count; ++i) {
+        const std::uint64_t slot_seq = slots_[(tail + i) & slot_mask_].seq.load(std::memory_order_acquire);
+        if (slot_seq != Stamp(tail + i, false)) {
+            return unwritten(slot_seq, tail + i) ? SlotRead::kWait : SlotRead::kSkipped;
+        }
+        copy_slot(i);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    for (std::uint64_t i = 0; i < count; ++i) {
+        if (slots_[(tail + i) & slot_mask_].seq.load(std::memory_order_relaxed) != Stamp(tail + i, i == 0)) {
+            return SlotRead::kSkipped;
+        }
+    }
+    return SlotRead::kRecord;
+}
+
+void SharedMemoryRing::RewindCatalog(SharedMemoryCursor& cursor) {
+    std::atomic<std::uint64_t>& catalog_size =
+        header_->catalog_size[header_->catalog_epoch.load(std::memory_order_relaxed) & 1];
+    if (cursor.catalog_offset != catalog_size.load(std::memory_order_relaxed)) {
+        return;
+    }
+    catalog_size.store(0, std::memory_order_relaxed);
+    cursor.catalog_offset = 0;
+}
+
+std::uint64_t SharedMemoryRing::session() const noexcept {
+    return header_->session;
+}
+
+std::uint64_t SharedMemoryRing::published() const noexcept {
+    return header_->head.load(std::memory_order_relaxed);
+}
+
+std::uint64_t SharedMemoryRing::catalog_used() const noexcept {
+    return header_->catalog_size[header_->catalog_epoch.load(std::memory_order_relaxed) & 1].load(
+        std::memory_order_relaxed);
+}
+
+std::uint64_t SharedMemoryRing::catalog_capacity() const noexcept {
+    return header_->catalog_capacity;
+}
+
+std::uint64_t SharedMemoryRing::catalog_overflows() const noexcept {
+    return header_->catalog_overflows.load(std::memory_order_relaxed);
+}
+
+std::uint64_t SharedMemoryRing::catalog_compactions() const noexcept {
+    return header_->catalog_epoch.load(std::memory_order_relaxed);
+}
+
+std::unique_ptr<SharedMemorySink> SharedMemorySink::Create(const std::string& name,
+                                                           const SharedMemoryOptions& options,
+                                                           std::string* error) {
+    auto ring = SharedMemoryRing::Create(name, options, error);
+    if (!ring) {
+        return nullptr;
+    }
+    return std::make_unique<SharedMemorySink>(std::move(ring));
+}
+
+void SharedMemorySink::WriteDefinition(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    const bool removal = FreesCatalog(static_cast<RecordType>(header.type));
+    const std::size_t removal_reserve = ring_->catalog_capacity() / kRemovalReserve;
+    const std::size_t reserve = removal ? 0 : removal_reserve;
+    bool appended = ring_->AppendDefinition(header, parts, part_count, reserve);
+    // Definitions compact only when that frees a quarter of the catalog,
+    // and give up until the next cataloged removal if it does not. A
+    // removal compacts whenever that refills its reserve, which its
+    // predecessors, dropped by the compaction, used up.
+    if (!appended && (removal || !catalog_full_)) {
+        const bool compacted =
+            ring_->CompactCatalog(removal ? removal_reserve : ring_->catalog_capacity() / 4);
+        catalog_full_ = !compacted;
+        appended = compacted && ring_->AppendDefinition(header, parts, part_count, reserve);
+    }
+    if (appended) {
+        if (removal) {
+            catalog_full_ = false;
+        }
+        return;
+    }
+    // Viewers attached now still get it; later ones will miss it.
+    ring_->CountCatalogOverflow();
+    ring_->Publish(header, parts, part_count);
+}
+
+void SharedMemorySink::WriteUpdate(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) {
+    ring_->Publish(header, parts, part_count);
+}
+
+}  // namespace debugglass
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "debugglass/transport/record.h"
+#include "debugglass/transport/update_sink.h"
+
+namespace debugglass {
+
+struct SharedMemoryOptions {
+    // 64-byte slots in the update ring, rounded up to a power of two. Each
+    // slot carries 56 bytes of record; the default holds about 3.5 MiB of
+    // updates before the oldest are overwritten.
+    std::size_t ring_slots = std::size_t{1} << 16;
+
+    // Bytes reserved for node definitions, which a viewer attaching late
+    // replays to rebuild the tree. Split in two halves so the catalog can be
+    // compacted into one while viewers read the other.
+    std::size_t catalog_bytes = std::size_t{1} << 20;
+};
+
+// Read position of one viewer.
+struct SharedMemoryCursor {
+    std::uint64_t catalog_offset = 0;
+    std::uint64_t catalog_epoch = 0;
+    std::uint64_t tail = 0;
+    bool attached = false;
+    // Ring slots skipped because the producer overwrote them, or never
+    // finished them, before this viewer got there.
+    std::uint64_t lost = 0;
+    // Times the producer compacted the catalog under this cursor. When it
+    // changes the viewer must discard its tree before the next Read, which
+    // starts over as if newly attached.
+    std::uint64_t catalog_resets = 0;
+    std::vector<unsigned char> scratch;
+    std::vector<unsigned char> definition;
+};
+
+// POSIX shared-memory segment carrying a mirrored widget tree from one
+// producer process to any number of viewers.
+//
+// Definitions go to an append-only catalog so every viewer sees the whole
+// tree whenever it attaches. When it fills up, the producer compacts it,
+// dropping definitions of removed nodes and message rows. Updates go to a ring of fixed-size slots that
+// producers claim with one fetch_add and fill without locks; once the ring
+// is full the oldest updates are overwritten, so a slow or absent viewer
+// never stalls the producer.
+class SharedMemoryRing {
+public:
+    using RecordVisitor = std::function<void(const RecordHeader& header, const unsigned char* payload)>;
+
+    ~SharedMemoryRing();
+
+    SharedMemoryRing(const SharedMemoryRing&) = delete;
+    SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+    // Creates segment `name`, replacing a stale one left by a producer that
+    // crashed. The segment is unlinked again when the ring is destroyed.
+    // Returns null and fills `error` on failure.
+    static std::unique_ptr<SharedMemoryRing> Create(const std::string& name,
+                                                     const SharedMemoryOptions& options,
+                                                     std::string* error = nullptr);
+
+    // Same layout in anonymous private memory, for a reader in this process
+    // such as SocketSink's sender thread.
+    static std::unique_ptr<SharedMemoryRing> CreatePrivate(const SharedMemoryOptions& options,
+                                                            std::string* error = nullptr);
+
+    // Maps an existing segment read-only.
+    static std::unique_ptr<SharedMemoryRing> Open(const std::string& name, std::string* error = nullptr);
+
+    // Producer side. AppendDefinition needs external serialisation and
+    // returns false when the catalog is full, or would be left with less
+    // than `reserve` bytes free; Publish may be called from any number of
+    // threads.
+    bool AppendDefinition(const RecordHeader& header,
+                          const PayloadPart* parts,
+                          std::size_t part_count,
+                          std::size_t reserve = 0);
+    void Publish(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count);
+    // Notes a definition published to the ring because the catalog was full.
+    void CountCatalogOverflow() noexcept;
+
+    // Rewrites the catalog without the definitions of removed nodes and
+    // message rows, and without removals the ring no longer holds updates
+    // from before. Returns false, leaving it as it was, unless that frees at
+    // least `min_freed` bytes. Attached viewers start over from the compacted
+    // catalog. Needs the same serialisation as AppendDefinition; not for
+    // private rings, whose reader rewinds the catalog instead.
+    bool CompactCatalog(std::size_t min_freed);
+
+    // Viewer side. Visits definitions and updates published since the last
+    // call in the order producers wrote them, and returns how many it
+    // visited. The first call replays the whole catalog and starts on the
+    // ring half a ring behind the producer. Stops after `max_records`
+    // updates so a busy producer cannot starve the caller.
+    std::size_t Read(SharedMemoryCursor& cursor, const RecordVisitor& visit, std::size_t max_records) const;
+
+    // For a private ring with the single reader `cursor`: once that reader
+    // has consumed the whole catalog, empties it so definitions never spill
+    // into the ring. Needs the same serialisation as AppendDefinition.
+    void RewindCatalog(SharedMemoryCursor& cursor);
+
+    // Random per-Create value; a viewer that re-opens the name and finds a
+    // different session knows the producer restarted.
+    std::uint64_t session() const noexcept;
+    std::size_t ring_slots() const noexcept { return slot_mask_ + 1; }
+    std::uint64_t published() const noexcept;
+    std::uint64_t catalog_used() const noexcept;
+    std::uint64_t catalog_capacity() const noexcept;
+    // Definitions that did not fit in the catalog and went to the ring.
+    std::uint64_t catalog_overflows() const noexcept;
+    std::uint64_t catalog_compactions() const noexcept;
+
+private:
+    struct Header;
+    struct Slot;
+
+    enum class SlotRead { kRecord, kSkipped, kWait };
+
+    struct Layout {
+        std::size_t slot_count = 0;
+        std::size_t catalog_offset = 0;
+        std::size_t catalog_capacity = 0;
+        std::size_t slots_offset = 0;
+        std::size_t size = 0;
+    };
+
+    SharedMemoryRing() = default;
+
+    static Layout LayoutFor(const SharedMemoryOptions& options);
+    // Initialises a freshly mapped, zeroed region.
+    static std::unique_ptr<SharedMemoryRing> Format(void* base, const Layout& layout);
+    static std::string SegmentName(const std::string& name);
+    // Validates the header of a mapped segment of `size` bytes.
+    bool Attach(void* base, std::size_t size, std::string* error);
+    // Visits catalog entries appended while the ring head was at or before
+    // `position`. Returns false, visiting nothing more, once the producer
+    // has started replacing the catalog the cursor reads.
+    bool ReadDefinitions(SharedMemoryCursor& cursor,
+                         std::uint64_t position,
+                         const RecordVisitor& visit,
+                         std::size_t& visited) const;
+    unsigned char* CatalogHalf(std::uint64_t epoch) const noexcept;
+    // Copies the record at cursor.tail into cursor.scratch and sets `count`
+    // to the slots it spans.
+    SlotRead ReadRecord(SharedMemoryCursor& cursor, std::uint64_t head, std::uint64_t& count) const;
+    // Stores the words of a record occupying slots [first, first + count).
+    void WriteSlots(std::uint64_t first,
+                    std::uint64_t count,
+                    const RecordHeader& header,
+                    const PayloadPart* parts,
+                    std::size_t part_count);
+
+    void* base_ = nullptr;
+    std::size_t size_ = 0;
+    std::string unlink_name_;
+    Header* header_ = nullptr;
+    unsigned char* catalog_ = nullptr;
+    Slot* slots_ = nullptr;
+    std::uint64_t slot_mask_ = 0;
+};
+
+// UpdateSink that writes a mirrored tree into a SharedMemoryRing. Each update
+// costs one fetch_add and a copy into the ring; no allocation, lock or
+// system call.
+class SharedMemorySink : public UpdateSink {
+public:
+    explicit SharedMemorySink(std::unique_ptr<SharedMemoryRing> ring) : ring_(std::move(ring)) {}
+
+    static std::unique_ptr<SharedMemorySink> Create(const std::string& name,
+                                                    const SharedMemoryOptions& options = {},
+                                                    std::string* error = nullptr);
+
+    void WriteDefinition(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) override;
+    void WriteUpdate(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) override;
+
+    const SharedMemoryRing& ring() const noexcept { return *ring_; }
+
+private:
+    std::unique_ptr<SharedMemoryRing> ring_;
+    std::mutex catalog_mutex_;
+    // Set when compaction frees too little; definitions then overflow into
+    // the ring without scanning the catalog again until a removal is
+    // cataloged. Removals may use the last sixteenth of the catalog, and
+    // compact it when that runs out, so they still reach it then.
+    bool catalog_full_ = false;
+};
+
+}  // namespace debugglass
@@ -0,0 +1,71 @@
+#include "debugglass/transport/socket_client.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include "debugglass/transport/socket_util.h"
+
+namespace debugglass {
+namespace {
+constexpr std::size_t kReadSize = std::size_t{1} << 20;
+// Bounds one Poll so a producer that sends faster than the viewer applies
+// cannot starve rendering.
+constexpr int kMaxReadsPerPoll = 64;
+}  // namespace
+
+SocketClient::SocketClient(int socket) : socket_(socket), buffer_(kReadSize, '\0') {}
+
+SocketClient::~SocketClient() {
+    close(socket_);
+}
+
+std::unique_ptr<SocketClient> SocketClient::Connect(const std::string& endpoint, std::string* error) {
+    const int socket = ConnectTo(endpoint, error);
+    if (socket < 0) {
+        return nullptr;
+    }
+    return std::unique_ptr<SocketClient>(new SocketClient(socket));
+}
+
+bool SocketClient::Poll(RemoteTree& tree, std::chrono::milliseconds timeout) {
+    pollfd descriptor{};
+    descriptor.fd = socket_;
+    descriptor.events = POLLIN;
+    if (poll(&descriptor, 1, static_cast<int>(timeout.count())) <= 0) {
+        return true;
+    }
+
+    const auto on_frame = [&](const FrameHeader& frame) {
+        if ((frame.flags & kFrameSnapshot) != 0) {
+            tree.Reset();
+        }
+        ++frames_;
+        dropped_ = frame.dropped;
+    };
+    const auto on_record = [&](const RecordHeader& header, const unsigned char* payload) {
+        tree.Apply(header, payload);
+        ++records_;
+    };
+
+    // Drain what is there without waiting for more.
+    for (int reads = 0; reads < kMaxReadsPerPoll; ++reads) {
+        const ssize_t received = recv(socket_, &buffer_[0], buffer_.size(), 0);
+        if (received == 0) {
+            return false;
+        }
+        if (received < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        bytes_ += static_cast<std::uint64_t>(received);
+        if (!decoder_.Feed(reinterpret_cast<const unsigned char*>(buffer_.data()), static_cast<std::size_t>(received),
+                           on_frame, on_record)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace debugglass
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "debugglass/transport/frame_codec.h"
+#include "debugglass/transport/remote_tree.h"
+
+namespace debugglass {
+
+// Viewer end of a SocketSink stream: reads frames and applies them to a
+// RemoteTree.
+class SocketClient {
+public:
+    ~SocketClient();
+
+    SocketClient(const SocketClient&) = delete;
+    SocketClient& operator=(const SocketClient&) = delete;
+
+    // Returns null and fills `error` if nothing is listening at `endpoint`.
+    static std::unique_ptr<SocketClient> Connect(const std::string& endpoint, std::string* error = nullptr);
+
+    // Waits up to `timeout` for data, then applies every frame that has
+    // arrived. Returns false once the connection is closed or the stream is
+    // corrupt; the client must then be discarded.
+    bool Poll(RemoteTree& tree, std::chrono::milliseconds timeout);
+
+    std::uint64_t frames() const noexcept { return frames_; }
+    std::uint64_t records() const noexcept { return records_; }
+    std::uint64_t bytes() const noexcept { return bytes_; }
+    // Producer-side drops reported by the latest frame.
+    std::uint64_t dropped() const noexcept { return dropped_; }
+
+private:
+    explicit SocketClient(int socket);
+
+    int socket_ = -1;
+    FrameDecoder decoder_;
+    std::string buffer_;
+    std::uint64_t frames_ = 0;
+    std::uint64_t records_ = 0;
+    std::uint64_t bytes_ = 0;
+    std::uint64_t dropped_ = 0;
+};
+
+}  // namespace debugglass
@@ -0,0 +1,204 @@
+#include "debugglass/transport/socket_sink.h"
+
+#include <unistd.h>
+
+#include <limits>
+#include <utility>
+
+#include "debugglass/transport/socket_util.h"
+
+namespace debugglass {
+
+SocketSink::SocketSink(SocketSinkOptions options, std::unique_ptr<SharedMemoryRing> staging, int listener)
+    : options_(std::move(options)), staging_(std::move(staging)), listener_(listener) {
+    sender_ = std::thread(&SocketSink::SenderMain, this);
+}
+
+SocketSink::~SocketSink() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+    if (sender_.joinable()) {
+        sender_.join();
+    }
+    for (Client& client : clients_) {
+        close(client.socket);
+    }
+    close(listener_);
+    RemoveEndpoint(options_.endpoint);
+}
+
+std::unique_ptr<SocketSink> SocketSink::Create(const SocketSinkOptions& options, std::string* error) {
+    auto staging = SharedMemoryRing::CreatePrivate(options.staging, error);
+    if (!staging) {
+        return nullptr;
+    }
+    const int listener = ListenOn(options.endpoint, error);
+    if (listener < 0) {
+        return nullptr;
+    }
+    return std::unique_ptr<SocketSink>(new SocketSink(options, std::move(staging), listener));
+}
+
+void SocketSink::WriteDefinition(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    if (!staging_->AppendDefinition(header, parts, part_count)) {
+        staging_->CountCatalogOverflow();
+        staging_->Publish(header, parts, part_count);
+    }
+}
+
+void SocketSink::WriteUpdate(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) {
+    staging_->Publish(header, parts, part_count);
+}
+
+void SocketSink::SenderMain() {
+    auto next_frame = std::chrono::steady_clock::now();
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stop_mutex_);
+            if (stop_cv_.wait_until(lock, next_frame, [this] { return stop_; })) {
+                return;
+            }
+        }
+        const auto now = std::chrono::steady_clock::now();
+        next_frame += options_.frame_interval;
+        if (next_frame < now) {
+            next_frame = now + options_.frame_interval;
+        }
+
+        AcceptClients();
+        Drain();
+        SendFrames();
+    }
+}
+
+void SocketSink::AcceptClients() {
+    for (int socket = AcceptFrom(listener_); socket >= 0; socket = AcceptFrom(listener_)) {
+        Client client;
+        client.socket = socket;
+        clients_.push_back(std::move(client));
+    }
+    client_count_.store(clients_.size(), std::memory_order_relaxed);
+}
+
+void SocketSink::Drain() {
+    // Without viewers only the snapshot state is kept current.
+    batcher_.set_collect_deltas(!clients_.empty());
+    staging_->Read(
+        cursor_, [this](const RecordHeader& header, const unsigned char* payload) { batcher_.Add(header, payload); },
+        std::numeric_limits<std::size_t>::max());
+    {
+        std::lock_guard<std::mutex> lock(catalog_mutex_);
+        staging_->RewindCatalog(cursor_);
+    }
+    dropped_.store(cursor_.lost, std::memory_order_relaxed);
+}
+
+void SocketSink::SendFrames() {
+    if (clients_.empty()) {
+        batcher_.ClearDelta();
+        return;
+    }
+
+    delta_frame_.clear();
+    FrameEncoder delta(delta_frame_);
+    delta.Begin(0, ++sequence_, cursor_.lost);
+    const bool changed = batcher_.EncodeDelta(delta);
+    const bool encoded = delta.Finish();
+    batcher_.ClearDelta();
+    snapshot_frame_.clear();
+
+    for (auto it = clients_.begin(); it != clients_.end();) {
+        Client& client = *it;
+        if (changed && !encoded) {
+            // Too large to send as one frame; start everyone over.
+            client.needs_snapshot = true;
+        }
+        if (client.needs_snapshot) {
+            // Only once what was queued before has gone out, so a viewer
+            // that keeps falling behind gets at most one snapshot in flight.
+            if (client.sent == client.out.size()) {
+                if (snapshot_frame_.empty()) {
+                    // A tree too large for one frame is sent as several.
+                    FrameEncoder snapshot(snapshot_frame_);
+                    snapshot.set_split(true);
+                    snapshot.Begin(kFrameSnapshot, sequence_, cursor_.lost);
+                    batcher_.EncodeSnapshot(snapshot);
+                    snapshot.Finish();
+                }
+                Queue(client, snapshot_frame_);
+                client.needs_snapshot = false;
+                frames_sent_.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else if (changed && encoded) {
+            Queue(client, delta_frame_);
+            frames_sent_.fetch_add(1, std::memory_order_relaxed);
+            if (client.out.size() - client.sent > options_.max_client_backlog) {
+                DropQueued(client);
+                client.needs_snapshot = true;
+                resyncs_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        if (!Flush(client)) {
+            close(client.socket);
+            it = clients_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    client_count_.store(clients_.size(), std::memory_order_relaxed);
+}
+
+void SocketSink::Queue(Client& client, const std::string& frame) {
+    if (frame.empty()) {
+        return;
+    }
+    if (client.sent == client.out.size()) {
+        client.out.clear();
+        client.sent = 0;
+        client.frame_starts.clear();
+    } else if (client.sent > client.out.size() / 2) {
+        client.out.erase(0, client.sent);
+        std::vector<std::size_t> starts;
+        for (std::size_t start : client.frame_starts) {
+            if (start >= client.sent) {
+                starts.push_back(start - client.sent);
+            }
+        }
+        client.frame_starts = std::move(starts);
+        client.sent = 0;
+    }
+    client.frame_starts.push_back(client.out.size());
+    client.out.append(frame);
+}
+
+void SocketSink::DropQueued(Client& client) {
+    // Keep the frame being sent, if any; the stream must stay whole.
+    for (std::size_t i = 0; i < client.frame_starts.size(); ++i) {
+        if (client.frame_starts[i] >= client.sent) {
+            client.out.resize(client.frame_starts[i]);
+            client.frame_starts.resize(i);
+            return;
+        }
+    }
+}
+
+bool SocketSink::Flush(Client& client) {
+    while (client.sent < client.out.size()) {
+        const long written = SendSome(client.socket, client.out.data() + client.sent, client.out.size() - client.sent);
+        if (written < 0) {
+            return false;
+        }
+        if (written == 0) {
+            return true;
+        }
+        client.sent += static_cast<std::size_t>(written);
+    }
+    return !PeerClosed(client.socket);
+}
+
+}  // namespace debugglass
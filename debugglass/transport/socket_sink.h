@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "debugglass/transport/delta_batcher.h"
+#include "debugglass/transport/shm_ring.h"
+#include "debugglass/transport/update_sink.h"
+
+namespace debugglass {
+
+struct SocketSinkOptions {
+    // "tcp://host:port" or "unix:///path"; see socket_util.h.
+    std::string endpoint = "tcp://127.0.0.1:7777";
+
+    // Deltas are collected and sent once per interval.
+    std::chrono::milliseconds frame_interval{16};
+
+    // Lock-free buffer between producers and the sender thread. It must
+    // hold one frame interval of updates; past that the oldest are dropped.
+    SharedMemoryOptions staging;
+
+    // A viewer with more unsent bytes than this is skipped until its
+    // socket drains, then sent a fresh snapshot instead of the deltas it
+    // missed.
+    std::size_t max_client_backlog = std::size_t{16} << 20;
+};
+
+// UpdateSink that streams a mirrored tree to viewers over TCP or a Unix
+// socket. Producers only copy records into a lock-free staging ring; a
+// background thread folds them into per-frame deltas with DeltaBatcher and
+// sends each connected viewer a snapshot followed by one delta frame per
+// interval. Nothing a viewer or the network does can block a producer:
+// overload drops the oldest staged updates, and a slow viewer is
+// resynchronised with a snapshot.
+class SocketSink : public UpdateSink {
+public:
+    ~SocketSink() override;
+
+    SocketSink(const SocketSink&) = delete;
+    SocketSink& operator=(const SocketSink&) = delete;
+
+    // Starts listening and the sender thread. Returns null and fills
+    // `error` if the endpoint cannot be bound.
+    static std::unique_ptr<SocketSink> Create(const SocketSinkOptions& options, std::string* error = nullptr);
+
+    void WriteDefinition(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) override;
+    void WriteUpdate(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) override;
+
+    std::size_t clients() const noexcept { return client_count_.load(std::memory_order_relaxed); }
+    std::uint64_t frames_sent() const noexcept { return frames_sent_.load(std::memory_order_relaxed); }
+    // Staged updates overwritten before the sender thread got to them.
+    std::uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+    // Times a viewer fell behind and was sent a snapshot instead.
+    std::uint64_t resyncs() const noexcept { return resyncs_.load(std::memory_order_relaxed); }
+
+private:
+    struct Client {
+        int socket = -1;
+        std::string out;
+        std::size_t sent = 0;
+        // Offsets in `out` of the frames not yet started, so they can be
+        // discarded whole.
+        std::vector<std::size_t> frame_starts;
+        bool needs_snapshot = true;
+    };
+
+    SocketSink(SocketSinkOptions options, std::unique_ptr<SharedMemoryRing> staging, int listener);
+
+    void SenderMain();
+    void AcceptClients();
+    void Drain();
+    void SendFrames();
+    // Writes as much of the client's backlog as the socket takes; false
+    // once the peer is gone.
+    bool Flush(Client& client);
+    static void Queue(Client& client, const std::string& frame);
+    static void DropQueued(Client& client);
+
+    SocketSinkOptions options_;
+    std::unique_ptr<SharedMemoryRing> staging_;
+    std::mutex catalog_mutex_;
+    int listener_ = -1;
+
+    // Sender thread state.
+    SharedMemoryCursor cursor_;
+    DeltaBatcher batcher_;
+    std::vector<Client> clients_;
+    std::string delta_frame_;
+    std::string snapshot_frame_;
+    std::uint64_t sequence_ = 0;
+
+    std::atomic<std::size_t> client_count_{0};
+    std::atomic<std::uint64_t> frames_sent_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> resyncs_{0};
+
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool stop_ = false;
+    std::thread sender_;
+};
+
+}  // namespace debugglass
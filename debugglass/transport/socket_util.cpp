@@ -0,0 +1,253 @@
+#include "debugglass/transport/socket_util.h"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace debugglass {
+namespace {
+constexpr char kTcpScheme[] = "tcp://";
+constexpr char kUnixScheme[] = "unix://";
+
+struct Endpoint {
+    bool unix_socket = false;
+    std::string host;
+    std::string port;
+    std::string path;
+};
+
+bool StartsWith(const std::string& text, const char* prefix) {
+    return text.compare(0, std::strlen(prefix), prefix) == 0;
+}
+
+bool Parse(const std::string& text, Endpoint& endpoint, std::string* error) {
+    if (StartsWith(text, kUnixScheme)) {
+        endpoint.unix_socket = true;
+        endpoint.path = text.substr(std::strlen(kUnixScheme));
+        if (endpoint.path.empty() || endpoint.path.size() >= sizeof(sockaddr_un::sun_path)) {
+            if (error != nullptr) {
+                *error = "bad unix socket path in " + text;
+            }
+            return false;
+        }
+        return true;
+    }
+    const std::string address = StartsWith(text, kTcpScheme) ? text.substr(std::strlen(kTcpScheme)) : text;
+    const auto colon = address.rfind(':');
+    if (colon == std::string::npos || colon + 1 == address.size()) {
+        if (error != nullptr) {
+            *error = "expected tcp://host:port or unix:///path, got " + text;
+        }
+        return false;
+    }
+    endpoint.host = address.substr(0, colon);
+    endpoint.port = address.substr(colon + 1);
+    // Allow "[::1]:7777".
+    if (endpoint.host.size() >= 2 && endpoint.host.front() == '[' && endpoint.host.back() == ']') {
+        endpoint.host = endpoint.host.substr(1, endpoint.host.size() - 2);
+    }
+    return true;
+}
+
+void Fail(std::string* error, const std::string& what) {
+    if (error != nullptr) {
+        *error = what + ": " + std::strerror(errno);
+    }
+}
+
+bool SetNonBlocking(int socket) {
+    const int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+void Configure(int socket) {
+    SetNonBlocking(socket);
+    fcntl(socket, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+    const int one = 1;
+    setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+
+// Unlinks `path` if it is a socket. False if something else is there.
+bool UnlinkSocket(const std::string& path) {
+    struct stat status {};
+    if (lstat(path.c_str(), &status) != 0) {
+        return errno == ENOENT;
+    }
+    if (!S_ISSOCK(status.st_mode)) {
+        errno = EEXIST;
+        return false;
+    }
+    return unlink(path.c_str()) == 0 || errno == ENOENT;
+}
+
+sockaddr_un UnixAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+// Runs `attempt` on each resolved TCP address until it succeeds.
+template <typename Attempt>
+int ForEachAddress(const Endpoint& endpoint, bool passive, std::string* error, Attempt&& attempt) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+    addrinfo* addresses = nullptr;
+    const char* host = endpoint.host.empty() ? nullptr : endpoint.host.c_str();
+    const int status = getaddrinfo(host, endpoint.port.c_str(), &hints, &addresses);
+    if (status != 0) {
+        if (error != nullptr) {
+            *error = "cannot resolve " + endpoint.host + ":" + endpoint.port + ": " + gai_strerror(status);
+        }
+        return -1;
+    }
+    int result = -1;
+    for (addrinfo* address = addresses; address != nullptr && result < 0; address = address->ai_next) {
+        const int socket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (socket < 0) {
+            Fail(error, "socket");
+            continue;
+        }
+        if (attempt(socket, address->ai_addr, address->ai_addrlen)) {
+            result = socket;
+        } else {
+            close(socket);
+        }
+    }
+    freeaddrinfo(addresses);
+    return result;
+}
+}  // namespace
+
+int ListenOn(const std::string& text, std::string* error) {
+    Endpoint endpoint;
+    if (!Parse(text, endpoint, error)) {
+        return -1;
+    }
+    int socket = -1;
+    if (endpoint.unix_socket) {
+        socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (socket < 0) {
+            Fail(error, "socket");
+            return -1;
+        }
+        if (!UnlinkSocket(endpoint.path)) {
+            Fail(error, endpoint.path);
+            close(socket);
+            return -1;
+        }
+        const sockaddr_un address = UnixAddress(endpoint.path);
+        if (bind(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            Fail(error, "bind " + endpoint.path);
+            close(socket);
+            return -1;
+        }
+    } else {
+        socket = ForEachAddress(endpoint, true, error, [&](int candidate, const sockaddr* address, socklen_t size) {
+            const int one = 1;
+            setsockopt(candidate, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (bind(candidate, address, size) != 0) {
+                Fail(error, "bind " + text);
+                return false;
+            }
+            return true;
+        });
+        if (socket < 0) {
+            return -1;
+        }
+    }
+    if (listen(socket, 8) != 0) {
+        Fail(error, "listen " + text);
+        close(socket);
+        return -1;
+    }
+    Configure(socket);
+    return socket;
+}
+
+int ConnectTo(const std::string& text, std::string* error) {
+    Endpoint endpoint;
+    if (!Parse(text, endpoint, error)) {
+        return -1;
+    }
+    int socket = -1;
+    if (endpoint.unix_socket) {
+        socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (socket < 0) {
+            Fail(error, "socket");
+            return -1;
+        }
+        const sockaddr_un address = UnixAddress(endpoint.path);
+        if (connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            Fail(error, "connect " + endpoint.path);
+            close(socket);
+            return -1;
+        }
+    } else {
+        socket = ForEachAddress(endpoint, false, error, [&](int candidate, const sockaddr* address, socklen_t size) {
+            if (connect(candidate, address, size) != 0) {
+                Fail(error, "connect " + text);
+                return false;
+            }
+            return true;
+        });
+        if (socket < 0) {
+            return -1;
+        }
+    }
+    Configure(socket);
+    return socket;
+}
+
+int AcceptFrom(int listener) {
+    const int socket = accept(listener, nullptr, nullptr);
+    if (socket < 0) {
+        return -1;
+    }
+    Configure(socket);
+    // Frames are already batched; do not hold them back further.
+    const int one = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return socket;
+}
+
+long SendSome(int socket, const void* data, std::size_t size) {
+#ifdef MSG_NOSIGNAL
+    constexpr int kFlags = MSG_NOSIGNAL;
+#else
+    constexpr int kFlags = 0;
+#endif
+    const ssize_t sent = send(socket, data, size, kFlags);
+    if (sent >= 0) {
+        return static_cast<long>(sent);
+    }
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+}
+
+bool PeerClosed(int socket) {
+    char byte;
+    const ssize_t received = recv(socket, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    return received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+}
+
+void RemoveEndpoint(const std::string& text) {
+    Endpoint endpoint;
+    if (Parse(text, endpoint, nullptr) && endpoint.unix_socket) {
+        UnlinkSocket(endpoint.path);
+    }
+}
+
+}  // namespace debugglass
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace debugglass {
+
+// Endpoints are "tcp://host:port" or "unix:///path/to/socket"; a bare
+// "host:port" means TCP. Every function returns -1 or false and fills
+// `error` on failure.
+
+// Non-blocking listening socket. A stale Unix socket file is replaced; any
+// other file at the path makes it fail.
+int ListenOn(const std::string& endpoint, std::string* error);
+
+// Blocking connect; the returned socket is non-blocking.
+int ConnectTo(const std::string& endpoint, std::string* error);
+
+// Accepts one pending connection as a non-blocking socket, or returns -1.
+int AcceptFrom(int listener);
+
+// Sends without blocking or raising SIGPIPE. Returns the bytes written, 0
+// if the socket buffer is full, or -1 once the peer is gone.
+long SendSome(int socket, const void* data, std::size_t size);
+
+// True once the peer has closed a connection it never sends on.
+bool PeerClosed(int socket);
+
+// Removes the socket file of a Unix endpoint, but nothing else at its path.
+void RemoveEndpoint(const std::string& endpoint);
+
+}  // namespace debugglass
@@ -0,0 +1,62 @@
+#include "debugglass/transport/update_sink.h"
+
+#include <algorithm>
+
+namespace debugglass {
+
+void TeeSink::WriteDefinition(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) {
+    first_.WriteDefinition(header, parts, part_count);
+    second_.WriteDefinition(header, parts, part_count);
+}
+
+void TeeSink::WriteUpdate(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) {
+    first_.WriteUpdate(header, parts, part_count);
+    second_.WriteUpdate(header, parts, part_count);
+}
+
+std::uint32_t DefineNode(UpdateSink& sink,
+                         RemoteBinding& binding,
+                         RecordType type,
+                         std::uint32_t parent,
+                         const std::string& label,
+                         const void* params,
+                         std::size_t params_size) {
+    const std::uint32_t id = sink.NewNodeId();
+    const auto label_size = static_cast<std::uint32_t>(label.size());
+    const PayloadPart parts[] = {
+        {&label_size, sizeof(label_size)},
+        {label.data(), label.size()},
+        {params, params_size},
+    };
+
+    RecordHeader header;
+    header.size = static_cast<std::uint32_t>(sizeof(label_size) + label.size() + params_size);
+    header.type = static_cast<std::uint16_t>(type);
+    header.widget = id;
+    header.parent = parent;
+    sink.WriteDefinition(header, parts, params_size == 0 ? 2 : 3);
+    binding.Bind(sink, id);
+    return id;
+}
+
+void SendRemove(UpdateSink* sink, std::uint32_t id) {
+    if (sink == nullptr) {
+        return;
+    }
+    RecordHeader header;
+    header.type = static_cast<std::uint16_t>(RecordType::kRemove);
+    header.widget = id;
+    sink->WriteDefinition(header, nullptr, 0);
+}
+
+void SendGraphValues(UpdateSink& sink, std::uint32_t widget, const float* values, std::size_t count) {
+    constexpr std::size_t kChunk = kMaxRecordPayload / sizeof(float);
+    while (count > 0) {
+        const std::size_t chunk = std::min(count, kChunk);
+        SendUpdate(sink, widget, RecordType::kGraphValues, values, chunk * sizeof(float));
+        values += chunk;
+        count -= chunk;
+    }
+}
+
+}  // namespace debugglass
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "debugglass/transport/record.h"
+
+namespace debugglass {
+
+// One contiguous piece of a record payload; transports gather the parts so
+// producers never assemble a payload in a temporary buffer.
+struct PayloadPart {
+    const void* data;
+    std::size_t size;
+};
+
+// Destination for a mirrored widget tree. Widgets bound to a sink forward
+// every write to it instead of storing the value, so the producer pays for
+// encoding and the transport only.
+class UpdateSink {
+public:
+    virtual ~UpdateSink() = default;
+
+    // Node definitions, removals and other records later updates depend on.
+    // Rare, so transports must deliver them in order and must not drop them.
+    virtual void WriteDefinition(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) = 0;
+
+    // Value updates from any producer thread. Must not block; a saturated
+    // transport may drop them.
+    virtual void WriteUpdate(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) = 0;
+
+    // Identifier for a newly mirrored node. Zero is the root.
+    std::uint32_t NewNodeId() noexcept { return next_id_.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint32_t> next_id_{1};
+};
+
+// Forwards every record to two sinks, e.g. a live transport and a
+// SessionRecorder. Node ids come from the tee, so both see the same tree.
+class TeeSink : public UpdateSink {
+public:
+    TeeSink(UpdateSink& first, UpdateSink& second) : first_(first), second_(second) {}
+
+    void WriteDefinition(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) override;
+    void WriteUpdate(const RecordHeader& header, const PayloadPart* parts, std::size_t part_count) override;
+
+private:
+    UpdateSink& first_;
+    UpdateSink& second_;
+};
+
+// A node's place in a mirrored tree. Bound once, when the node is announced;
+// writers check sink() on every write and fall back to local storage while
+// it is null.
+class RemoteBinding {
+public:
+    UpdateSink* sink() const noexcept { return sink_.load(std::memory_order_acquire); }
+    std::uint32_t id() const noexcept { return id_; }
+
+    void Bind(UpdateSink& sink, std::uint32_t id) noexcept {
+        id_ = id;
+        sink_.store(&sink, std::memory_order_release);
+    }
+
+private:
+    std::atomic<UpdateSink*> sink_{nullptr};
+    std::uint32_t id_ = 0;
+};
+
+// Announces a node of `type` labelled `label` under `parent`, binds it and
+// returns its id. `params` follow the label in the payload.
+std::uint32_t DefineNode(UpdateSink& sink,
+                         RemoteBinding& binding,
+                         RecordType type,
+                         std::uint32_t parent,
+                         const std::string& label,
+                         const void* params = nullptr,
+                         std::size_t params_size = 0);
+
+// Tells the viewer that node `id` and everything below it is gone. No-op
+// when `sink` is null, i.e. the node was never mirrored. Callers read both
+// from the node's RemoteBinding before unpublishing it.
+void SendRemove(UpdateSink* sink, std::uint32_t id);
+
+inline void SendUpdate(UpdateSink& sink, std::uint32_t widget, RecordType type, const void* data, std::size_t size) {
+    RecordHeader header;
+    header.size = static_cast<std::uint32_t>(size);
+    header.type = static_cast<std::uint16_t>(type);
+    header.widget = widget;
+    const PayloadPart part{data, size};
+    sink.WriteUpdate(header, &part, size == 0 ? 0 : 1);
+}
+
+// SendUpdate for records later ones depend on, such as message ID
+// registrations and removals: sent through WriteDefinition so they are
+// neither dropped nor missed by a viewer that attaches late.
+inline void SendReliable(UpdateSink& sink, std::uint32_t widget, RecordType type, const void* data, std::size_t size) {
+    RecordHeader header;
+    header.size = static_cast<std::uint32_t>(size);
+    header.type = static_cast<std::uint16_t>(type);
+    header.widget = widget;
+    const PayloadPart part{data, size};
+    sink.WriteDefinition(header, &part, size == 0 ? 0 : 1);
+}
+
+// Sends graph samples as kGraphValues records of at most kMaxRecordPayload.
+void SendGraphValues(UpdateSink& sink, std::uint32_t widget, const float* values, std::size_t count);
+
+}  // namespace debugglass
@@ -0,0 +1,607 @@
+#include "debugglass/util/export.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <utility>
+
+#include "debugglass/util/redraw_signal.h"
+#include "debugglass/util/value_format.h"
+
+namespace debugglass {
+namespace {
+// Rows between progress updates and cancellation checks.
+constexpr std::size_t kProgressRows = 4096;
+// Formatted output is handed to the file in blocks of about this size.
+constexpr std::size_t kFlushBytes = std::size_t{1} << 20;
+
+using Kind = ExportTable::Kind;
+
+template <typename T>
+std::uint64_t Bits(T value) {
+    static_assert(sizeof(T) <= sizeof(std::uint64_t), "value must fit in a cell");
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(T));
+    return bits;
+}
+
+template <typename T>
+T FromBits(std::uint64_t bits) {
+    T value;
+    std::memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+
+bool LocalTime(std::time_t time, std::tm& out) {
+#if defined(_WIN32)
+    return localtime_s(&out, &time) == 0;
+#else
+    return localtime_r(&time, &out) != nullptr;
+#endif
+}
+
+bool UtcTime(std::time_t time, std::tm& out) {
+#if defined(_WIN32)
+    return gmtime_s(&out, &time) == 0;
+#else
+    return gmtime_r(&time, &out) != nullptr;
+#endif
+}
+
+// ISO 8601 in UTC with nanoseconds, e.g. 2024-05-01T12:00:00.000000001Z.
+std::string_view FormatTimestamp(std::int64_t unix_ns, NumberBuffer& buffer) {
+    constexpr std::int64_t kNanosPerSecond = 1000000000;
+    std::int64_t seconds = unix_ns / kNanosPerSecond;
+    std::int64_t nanos = unix_ns % kNanosPerSecond;
+    if (nanos < 0) {
+        nanos += kNanosPerSecond;
+        --seconds;
+    }
+    std::tm tm_snapshot;
+    if (!UtcTime(static_cast<std::time_t>(seconds), tm_snapshot)) {
+        return FormatSigned(unix_ns, buffer);
+    }
+    const std::size_t length = std::strftime(buffer.data(), buffer.size(), "%Y-%m-%dT%H:%M:%S", &tm_snapshot);
+    const int suffix = std::snprintf(buffer.data() + length, buffer.size() - length, ".%09lldZ",
+                                     static_cast<long long>(nanos));
+    return std::string_view(buffer.data(), length + static_cast<std::size_t>(std::max(suffix, 0)));
+}
+
+bool Finite(const ExportTable::Column& column, std::size_t row) {
+    switch (column.kinds[row]) {
+    case Kind::kFloat32:
+        return std::isfinite(FromBits<float>(column.values[row]));
+    case Kind::kFloat64:
+        return std::isfinite(FromBits<double>(column.values[row]));
+    default:
+        return true;
+    }
+}
+
+// Text of a cell that is neither null nor text.
+std::string_view FormatCell(const ExportTable::Column& column, std::size_t row, NumberBuffer& buffer) {
+    const std::uint64_t value = column.values[row];
+    switch (column.kinds[row]) {
+    case Kind::kBool:
+        return value != 0 ? "true" : "false";
+    case Kind::kSigned:
+        return FormatSigned(static_cast<std::int64_t>(value), buffer);
+    case Kind::kUnsigned:
+        return FormatUnsigned(value, buffer);
+    case Kind::kFloat32:
+        return FormatShortest(FromBits<float>(value), buffer);
+    case Kind::kFloat64:
+        return FormatShortest(FromBits<double>(value), buffer);
+    case Kind::kTimestamp:
+        return FormatTimestamp(static_cast<std::int64_t>(value), buffer);
+    case Kind::kNull:
+    case Kind::kText:
+        break;
+    }
+    return {};
+}
+
+void AppendCsvField(std::string& out, std::string_view text) {
+    if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+        out.append(text);
+        return;
+    }
+    out.push_back('"');
+    for (const char c : text) {
+        if (c == '"') {
+            out.push_back('"');
+        }
+        out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+void AppendJsonString(std::string& out, std::string_view text) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    out.push_back('"');
+    for (const char c : text) {
+        switch (c) {
+        case '"':
+            out.append("\\\"");
+            break;
+        case '\\':
+            out.append("\\\\");
+            break;
+        case '\n':
+            out.append("\\n");
+            break;
+        case '\r':
+            out.append("\\r");
+            break;
+        case '\t':
+            out.append("\\t");
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                out.append("\\u00");
+                out.push_back(kHex[(c >> 4) & 0xF]);
+                out.push_back(kHex[c & 0xF]);
+            } else {
+                out.push_back(c);
+            }
+            break;
+        }
+    }
+    out.push_back('"');
+}
+
+// Destination of the formatted output: a file, written in blocks, or the
+// progress text.
+class Output {
+public:
+    Output(std::FILE* file, std::string& memory) : file_(file), buffer_(file != nullptr ? block_ : memory) {}
+
+    std::string& buffer() noexcept { return buffer_; }
+
+    bool Write(const void* data, std::size_t size) {
+        buffer_.append(static_cast<const char*>(data), size);
+        written_ += size;
+        return MaybeFlush();
+    }
+
+    // Zero fill up to the next multiple of 8 bytes written through Write.
+    bool Pad() {
+        static constexpr char kZeros[8] = {};
+        return Write(kZeros, (8 - written_ % 8) % 8);
+    }
+
+    bool MaybeFlush() { return buffer_.size() < kFlushBytes || Flush(); }
+
+    bool Flush() {
+        if (file_ == nullptr || buffer_.empty()) {
+            return true;
+        }
+        const bool written = std::fwrite(buffer_.data(), 1, buffer_.size(), file_) == buffer_.size();
+        buffer_.clear();
+        return written;
+    }
+
+private:
+    std::FILE* file_;
+    std::string block_;
+    std::string& buffer_;
+    std::uint64_t written_ = 0;
+};
+
+// Calls `write_row` for every row, reporting progress and honouring
+// cancellation every kProgressRows rows.
+template <typename WriteRow>
+bool ForEachRow(std::size_t rows, Output& output, ExportProgress& progress, WriteRow&& write_row) {
+    for (std::size_t row = 0; row < rows; ++row) {
+        write_row(row);
+        if ((row + 1) % kProgressRows == 0) {
+            progress.rows_written.store(row + 1, std::memory_order_relaxed);
+            RedrawSignal::Raise();
+            if (progress.cancel.load(std::memory_order_relaxed)) {
+                return false;
+            }
+        }
+        if (!output.MaybeFlush()) {
+            return false;
+        }
+    }
+    progress.rows_written.store(rows, std::memory_order_relaxed);
+    return true;
+}
+
+bool WriteCsv(const ExportTable& table, Output& output, ExportProgress& progress) {
+    const auto& columns = table.columns();
+    std::string& out = output.buffer();
+    for (std::size_t c = 0; c < columns.size(); ++c) {
+        if (c > 0) {
+            out.push_back(',');
+        }
+        AppendCsvField(out, columns[c].name);
+    }
+    out.push_back('\n');
+
+    NumberBuffer buffer;
+    return ForEachRow(table.rows(), output, progress, [&](std::size_t row) {
+        for (std::size_t c = 0; c < columns.size(); ++c) {
+            if (c > 0) {
+                out.push_back(',');
+            }
+            const ExportTable::Column& column = columns[c];
+            switch (column.kinds[row]) {
+            case Kind::kNull:
+                break;
+            case Kind::kText:
+                AppendCsvField(out, table.TextAt(column, row));
+                break;
+            default:
+                out.append(FormatCell(column, row, buffer));
+                break;
+            }
+        }
+        out.push_back('\n');
+    });
+}
+
+bool WriteJsonLines(const ExportTable& table, Output& output, ExportProgress& progress) {
+    const auto& columns = table.columns();
+    // Keys are the same on every line; escape them once.
+    std::vector<std::string> keys(columns.size());
+    for (std::size_t c = 0; c < columns.size(); ++c) {
+        AppendJsonString(keys[c], columns[c].name);
+        keys[c].push_back(':');
+    }
+
+    std::string& out = output.buffer();
+    NumberBuffer buffer;
+    return ForEachRow(table.rows(), output, progress, [&](std::size_t row) {
+        out.push_back('{');
+        for (std::size_t c = 0; c < columns.size(); ++c) {
+            if (c > 0) {
+                out.push_back(',');
+            }
+            out.append(keys[c]);
+            const ExportTable::Column& column = columns[c];
+            switch (column.kinds[row]) {
+            case Kind::kNull:
+                out.append("null");
+                break;
+            case Kind::kText:
+                AppendJsonString(out, table.TextAt(column, row));
+                break;
+            case Kind::kTimestamp:
+                AppendJsonString(out, FormatCell(column, row, buffer));
+                break;
+            default:
+                // JSON has no NaN or infinity.
+                out.append(Finite(column, row) ? FormatCell(column, row, buffer) : "null");
+                break;
+            }
+        }
+        out.append("}\n");
+    });
+}
+
+bool WriteColumnar(const ExportTable& table, Output& output, ExportProgress& progress) {
+    const auto& columns = table.columns();
+    const std::size_t rows = table.rows();
+    ColumnarHeader header;
+    header.columns = static_cast<std::uint32_t>(columns.size());
+    header.rows = rows;
+    if (!output.Write(&header, sizeof(header))) {
+        return false;
+    }
+    for (std::size_t c = 0; c < columns.size(); ++c) {
+        const ExportTable::Column& column = columns[c];
+        const std::uint64_t name_size = column.name.size();
+        const std::uint64_t text_size = column.text.size();
+        // Cells past the last complete row are left out.
+        if (!output.Write(&name_size, sizeof(name_size)) || !output.Write(column.name.data(), column.name.size()) ||
+            !output.Pad() || !output.Write(column.kinds.data(), rows) || !output.Pad() ||
+            !output.Write(column.values.data(), rows * sizeof(std::uint64_t)) ||
+            !output.Write(&text_size, sizeof(text_size)) || !output.Write(column.text.data(), column.text.size()) ||
+            !output.Pad()) {
+            return false;
+        }
+        progress.rows_written.store(rows * (c + 1) / columns.size(), std::memory_order_relaxed);
+        RedrawSignal::Raise();
+        if (progress.cancel.load(std::memory_order_relaxed)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Finish(ExportProgress& progress, ExportProgress::State state, std::string error = {}) {
+    progress.error = std::move(error);
+    progress.state.store(state, std::memory_order_release);
+    RedrawSignal::Raise();
+}
+
+std::string SanitizeFileName(const std::string& name) {
+    std::string out;
+    for (const char c : name) {
+        const bool keep = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' ||
+                          c == '_' || c == '.';
+        out.push_back(keep ? c : '_');
+    }
+    return out.empty() ? "export" : out;
+}
+}  // namespace
+
+const char* ExportFormatName(ExportFormat format) noexcept {
+    switch (format) {
+    case ExportFormat::kCsv:
+        return "CSV";
+    case ExportFormat::kJsonLines:
+        return "JSON Lines";
+    case ExportFormat::kColumnar:
+        return "Columnar binary";
+    }
+    return "";
+}
+
+const char* ExportFormatExtension(ExportFormat format) noexcept {
+    switch (format) {
+    case ExportFormat::kCsv:
+        return ".csv";
+    case ExportFormat::kJsonLines:
+        return ".jsonl";
+    case ExportFormat::kColumnar:
+        return ".dgcol";
+    }
+    return "";
+}
+
+void ExportTable::SetColumns(std::vector<std::string> names) {
+    columns_.clear();
+    columns_.resize(names.size());
+    for (std::size_t c = 0; c < names.size(); ++c) {
+        columns_[c].name = std::move(names[c]);
+    }
+    cells_ = 0;
+}
+
+void ExportTable::Reserve(std::size_t rows) {
+    for (Column& column : columns_) {
+        column.kinds.reserve(rows);
+        column.values.reserve(rows);
+    }
+}
+
+ExportTable::Column* ExportTable::Next() {
+    if (columns_.empty()) {
+        return nullptr;
+    }
+    return &columns_[cells_++ % columns_.size()];
+}
+
+void ExportTable::Add(Kind kind, std::uint64_t value) {
+    if (Column* column = Next()) {
+        column->kinds.push_back(kind);
+        column->values.push_back(value);
+    }
+}
+
+void ExportTable::AddNull() {
+    Add(Kind::kNull, 0);
+}
+
+void ExportTable::AddBool(bool value) {
+    Add(Kind::kBool, value ? 1 : 0);
+}
+
+void ExportTable::AddSigned(std::int64_t value) {
+    Add(Kind::kSigned, static_cast<std::uint64_t>(value));
+}
+
+void ExportTable::AddUnsigned(std::uint64_t value) {
+    Add(Kind::kUnsigned, value);
+}
+
+void ExportTable::AddFloat(float value) {
+    Add(Kind::kFloat32, Bits(value));
+}
+
+void ExportTable::AddFloat(double value) {
+    Add(Kind::kFloat64, Bits(value));
+}
+
+void ExportTable::AddText(std::string_view value) {
+    Column* column = Next();
+    if (column == nullptr) {
+        return;
+    }
+    const auto size =
+        static_cast<std::uint32_t>(std::min<std::size_t>(value.size(), std::numeric_limits<std::uint32_t>::max()));
+    column->kinds.push_back(Kind::kText);
+    column->values.push_back(column->text.size());
+    column->text.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    column->text.append(value.data(), size);
+}
+
+void ExportTable::AddTimestamp(std::int64_t unix_ns) {
+    Add(Kind::kTimestamp, static_cast<std::uint64_t>(unix_ns));
+}
+
+std::string_view ExportTable::TextAt(const Column& column, std::size_t row) const {
+    const std::size_t offset = static_cast<std::size_t>(column.values[row]);
+    std::uint32_t size = 0;
+    std::memcpy(&size, column.text.data() + offset, sizeof(size));
+    return std::string_view(column.text.data() + offset + sizeof(size), size);
+}
+
+bool WriteExport(const ExportTable& table, ExportFormat format, const std::string& path, ExportProgress& progress) {
+    progress.rows.store(table.rows(), std::memory_order_relaxed);
+    progress.rows_written.store(0, std::memory_order_relaxed);
+    progress.path = path;
+    progress.state.store(ExportProgress::State::kWriting, std::memory_order_release);
+    RedrawSignal::Raise();
+
+    const std::string part_path = path + ".part";
+    std::FILE* file = nullptr;
+    if (!path.empty()) {
+        file = std::fopen(part_path.c_str(), "wb");
+        if (file == nullptr) {
+            Finish(progress, ExportProgress::State::kFailed, "cannot create " + part_path + ": " + std::strerror(errno));
+            return false;
+        }
+    }
+
+    progress.text.clear();
+    Output output(file, progress.text);
+    bool written = false;
+    switch (format) {
+    case ExportFormat::kCsv:
+        written = WriteCsv(table, output, progress);
+        break;
+    case ExportFormat::kJsonLines:
+        written = WriteJsonLines(table, output, progress);
+        break;
+    case ExportFormat::kColumnar:
+        written = WriteColumnar(table, output, progress);
+        break;
+    }
+    written = written && output.Flush();
+    const int write_errno = errno;
+    const bool cancelled = progress.cancel.load(std::memory_order_relaxed);
+
+    if (file == nullptr) {
+        if (cancelled) {
+            progress.text.clear();
+            Finish(progress, ExportProgress::State::kCancelled);
+            return false;
+        }
+        Finish(progress, ExportProgress::State::kDone);
+        return true;
+    }
+
+    const bool closed = std::fclose(file) == 0;
+    if (cancelled || !written || !closed) {
+        std::remove(part_path.c_str());
+        if (cancelled) {
+            Finish(progress, ExportProgress::State::kCancelled);
+        } else {
+            Finish(progress, ExportProgress::State::kFailed,
+                   "cannot write " + part_path + ": " + std::strerror(written ? errno : write_errno));
+        }
+        return false;
+    }
+    if (std::rename(part_path.c_str(), path.c_str()) != 0) {
+        const std::string error = "cannot rename " + part_path + ": " + std::strerror(errno);
+        std::remove(part_path.c_str());
+        Finish(progress, ExportProgress::State::kFailed, error);
+        return false;
+    }
+    Finish(progress, ExportProgress::State::kDone);
+    return true;
+}
+
+Exporter& Exporter::Instance() {
+    static Exporter exporter;
+    return exporter;
+}
+
+Exporter::~Exporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        if (running_) {
+            running_->cancel.store(true, std::memory_order_relaxed);
+        }
+        for (Pending& pending : queue_) {
+            pending.progress->state.store(ExportProgress::State::kCancelled, std::memory_order_release);
+        }
+        queue_.clear();
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+std::shared_ptr<ExportProgress> Exporter::Submit(ExportJob job) {
+    auto progress = std::make_shared<ExportProgress>();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(Pending{std::move(job), progress});
+        if (!worker_.joinable()) {
+            worker_ = std::thread(&Exporter::WorkerMain, this);
+        }
+    }
+    cv_.notify_one();
+    return progress;
+}
+
+void Exporter::set_directory(std::string directory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_ = std::move(directory);
+}
+
+std::string Exporter::PathFor(const std::string& name, ExportFormat format) const {
+    const auto now = std::chrono::system_clock::now();
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+    char stamp[32] = {};
+    std::tm tm_snapshot;
+    if (LocalTime(std::chrono::system_clock::to_time_t(now), tm_snapshot)) {
+        const std::size_t length = std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm_snapshot);
+        std::snprintf(stamp + length, sizeof(stamp) - length, "-%03d", static_cast<int>(ms));
+    }
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path = directory_;
+    }
+    if (!path.empty() && path.back() != '/') {
+        path.push_back('/');
+    }
+    path += SanitizeFileName(name);
+    path.push_back('-');
+    path += stamp;
+    path += ExportFormatExtension(format);
+    return path;
+}
+
+void Exporter::WorkerMain() {
+    while (true) {
+        Pending pending;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (stop_) {
+                return;
+            }
+            pending = std::move(queue_.front());
+            queue_.pop_front();
+            running_ = pending.progress;
+        }
+        Run(pending);
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.reset();
+    }
+}
+
+void Exporter::Run(Pending& pending) {
+    ExportProgress& progress = *pending.progress;
+    progress.state.store(ExportProgress::State::kSnapshot, std::memory_order_release);
+    RedrawSignal::Raise();
+
+    ExportTable table;
+    if (pending.job.snapshot) {
+        pending.job.snapshot(table);
+    }
+    // Release whatever the snapshot kept alive before the slow part.
+    pending.job.snapshot = nullptr;
+    if (progress.cancel.load(std::memory_order_relaxed)) {
+        Finish(progress, ExportProgress::State::kCancelled);
+        return;
+    }
+    WriteExport(table, pending.job.format, pending.job.path, progress);
+}
+
+}  // namespace debugglass
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace debugglass {
+
+enum class ExportFormat {
+    kCsv,
+    // One JSON object per row, keyed by column name.
+    kJsonLines,
+    // Typed column arrays; see ColumnarHeader.
+    kColumnar,
+};
+
+const char* ExportFormatName(ExportFormat format) noexcept;
+// File extension, including the dot.
+const char* ExportFormatExtension(ExportFormat format) noexcept;
+
+// Rows captured from a widget for export. Cells are appended row by row and
+// stored raw, per column, so taking the snapshot costs little more than
+// copying the data; all formatting happens when the table is written.
+class ExportTable {
+public:
+    enum class Kind : std::uint8_t { kNull, kBool, kSigned, kUnsigned, kFloat32, kFloat64, kText, kTimestamp };
+
+    struct Column {
+        std::string name;
+        std::vector<Kind> kinds;
+        // Per row: the value for numbers (IEEE bits for floats, nanoseconds
+        // since the Unix epoch for timestamps) or, for text, the offset in
+        // `text` of a u32 size followed by the bytes.
+        std::vector<std::uint64_t> values;
+        std::string text;
+    };
+
+    // Starts over with the given columns and no rows.
+    void SetColumns(std::vector<std::string> names);
+    void Reserve(std::size_t rows);
+
+    // Each call fills the next cell, left to right, then on to the next row.
+    void AddNull();
+    void AddBool(bool value);
+    void AddSigned(std::int64_t value);
+    void AddUnsigned(std::uint64_t value);
+    void AddFloat(float value);
+    void AddFloat(double value);
+    void AddText(std::string_view value);
+    void AddTimestamp(std::int64_t unix_ns);
+
+    // Adds an arithmetic value as the matching kind; characters as text.
+    template <typename T>
+    void AddArithmetic(T value) {
+        static_assert(std::is_arithmetic_v<T>, "AddArithmetic takes arithmetic types only");
+        if constexpr (std::is_same_v<T, bool>) {
+            AddBool(value);
+        } else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+                             std::is_same_v<T, unsigned char>) {
+            const char text = static_cast<char>(value);
+            AddText(std::string_view(&text, 1));
+        } else if constexpr (std::is_same_v<T, float>) {
+            AddFloat(value);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            AddFloat(static_cast<double>(value));
+        } else if constexpr (std::is_signed_v<T>) {
+            AddSigned(static_cast<std::int64_t>(value));
+        } else {
+            AddUnsigned(static_cast<std::uint64_t>(value));
+        }
+    }
+
+    const std::vector<Column>& columns() const noexcept { return columns_; }
+    // Complete rows; a partly filled last row is not counted.
+    std::size_t rows() const noexcept { return columns_.empty() ? 0 : cells_ / columns_.size(); }
+
+    std::string_view TextAt(const Column& column, std::size_t row) const;
+
+private:
+    // Column of the next cell, or null before SetColumns.
+    Column* Next();
+    void Add(Kind kind, std::uint64_t value);
+
+    std::vector<Column> columns_;
+    std::size_t cells_ = 0;
+};
+
+// Leading block of a columnar export. It is followed, per column and in
+// host byte order, by: u64 name size and the name; one ExportTable::Kind
+// byte per row; one u64 value per row as in ExportTable::Column; u64 text
+// size and the text. Every part is padded to a multiple of 8 bytes so the
+// value arrays can be mapped and read in place.
+struct ColumnarHeader {
+    static constexpr std::uint64_t kMagic = 0x3130304C4F434744ull;  // "DGCOL001"
+    static constexpr std::uint32_t kVersion = 1;
+
+    std::uint64_t magic = kMagic;
+    std::uint32_t version = kVersion;
+    std::uint32_t columns = 0;
+    std::uint64_t rows = 0;
+};
+
+static_assert(sizeof(ColumnarHeader) == 24, "ColumnarHeader layout is part of the file format");
+
+// Shared between an export job and whoever is watching it.
+struct ExportProgress {
+    enum class State { kQueued, kSnapshot, kWriting, kDone, kFailed, kCancelled };
+
+    bool finished() const noexcept { return state.load(std::memory_order_acquire) >= State::kDone; }
+
+    std::atomic<State> state{State::kQueued};
+    // Rows in the snapshot, and how many of them have been written so far.
+    std::atomic<std::uint64_t> rows{0};
+    std::atomic<std::uint64_t> rows_written{0};
+    // Set to stop the job at the next batch of rows.
+    std::atomic<bool> cancel{false};
+
+    // Filled in before the state becomes final; read them only after.
+    std::string path;
+    std::string error;
+    // The formatted output of jobs without a path.
+    std::string text;
+};
+
+struct ExportJob {
+    // Fills the table on the export thread. It must only touch data that is
+    // safe to read from there, and keep alive whatever it reads.
+    std::function<void(ExportTable&)> snapshot;
+    ExportFormat format = ExportFormat::kCsv;
+    // Destination file, written under a ".part" name and renamed when
+    // complete. Empty keeps the output in ExportProgress::text instead.
+    std::string path;
+};
+
+// Formats `table` into `path`, or into progress.text when `path` is empty,
+// updating `progress` as it goes and leaving it in kDone, kFailed or
+// kCancelled. Returns whether the export completed.
+bool WriteExport(const ExportTable& table, ExportFormat format, const std::string& path, ExportProgress& progress);
+
+// Process-wide background exporter. Jobs run one at a time, in order, on a
+// worker thread started by the first Submit, so neither taking large
+// snapshots nor formatting them ever holds up the render loop. The redraw
+// signal is raised as jobs progress so on-demand loops keep progress
+// displays moving.
+class Exporter {
+public:
+    static Exporter& Instance();
+
+    ~Exporter();
+
+    Exporter(const Exporter&) = delete;
+    Exporter& operator=(const Exporter&) = delete;
+
+    std::shared_ptr<ExportProgress> Submit(ExportJob job);
+
+    // Directory that PathFor places files in; the working directory unless
+    // set.
+    void set_directory(std::string directory);
+    // "<directory>/<name>-<local time>.<extension>", with characters that do
+    // not belong in a file name replaced by '_'.
+    std::string PathFor(const std::string& name, ExportFormat format) const;
+
+private:
+    struct Pending {
+        ExportJob job;
+        std::shared_ptr<ExportProgress> progress;
+    };
+
+    Exporter() = default;
+
+    void WorkerMain();
+    static void Run(Pending& pending);
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Pending> queue_;
+    std::shared_ptr<ExportProgress> running_;
+    std::string directory_;
+    bool stop_ = false;
+    std::thread worker_;
+};
+
+}  // namespace debugglass
@@ -0,0 +1,462 @@
+#include "debugglass/util/profiler.h"
+
+#if defined(DEBUGGLASS_ENABLE_PROFILER)
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdlib>
+#include <new>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+namespace debugglass {
+namespace {
+thread_local std::uint64_t t_allocations = 0;
+
+void* CountingAlloc(std::size_t size, void*) {
+    ++t_allocations;
+    return std::malloc(size);
+}
+
+void CountingFree(void* pointer, void*) {
+    std::free(pointer);
+}
+
+const char* KindName(ProfileKind kind) {
+    switch (kind) {
+    case ProfileKind::kPhase:
+        return "phase";
+    case ProfileKind::kWindow:
+        return "window";
+    case ProfileKind::kTab:
+        return "tab";
+    case ProfileKind::kCallback:
+        return "callback";
+    case ProfileKind::kWidget:
+        return "widget";
+    }
+    return "";
+}
+
+// Vertices in the draw list of `window` and of the child windows it began
+// this frame.
+std::int64_t WindowVertices(const ImGuiWindow* window) {
+    std::int64_t total = window->DrawList->VtxBuffer.Size;
+    for (const ImGuiWindow* child : window->DC.ChildWindows) {
+        total += WindowVertices(child);
+    }
+    return total;
+}
+
+enum TableColumn : int {
+    kColumnScope,
+    kColumnKind,
+    kColumnCpu,
+    kColumnSelf,
+    kColumnMax,
+    kColumnLock,
+    kColumnAllocations,
+    kColumnVertices,
+    kColumnHistory,
+    kColumnCount,
+};
+}  // namespace
+}  // namespace debugglass
+
+// Counts every heap allocation so scopes can report their own. Storage
+// still comes from malloc, as with the default operator new.
+void* operator new(std::size_t size) {
+    ++debugglass::t_allocations;
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace debugglass {
+
+Profiler& Profiler::Current() {
+    thread_local Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() {
+    // Both functions wrap malloc and free like ImGui's defaults, so blocks
+    // allocated before the switch are still freed correctly.
+    static std::once_flag install;
+    std::call_once(install, [] { ImGui::SetAllocatorFunctions(CountingAlloc, CountingFree, nullptr); });
+    open_.reserve(64);
+    frame_entry_.kind = ProfileKind::kPhase;
+    frame_entry_.name = "Frame";
+}
+
+std::uint64_t Profiler::ThreadAllocations() noexcept {
+    return t_allocations;
+}
+
+std::int64_t Profiler::VerticesOf(const OpenScope& scope) {
+    switch (scope.entry->kind) {
+    case ProfileKind::kPhase:
+        return scope.child_vertices;
+    case ProfileKind::kWindow:
+        // The scope wraps Begin, which clears the window's draw list, so
+        // read the list End left behind.
+        if (const ImGuiWindow* window = ImGui::FindWindowByName(scope.entry->name.c_str())) {
+            return WindowVertices(window);
+        }
+        return 0;
+    default:
+        break;
+    }
+    if (scope.window == nullptr) {
+        return 0;
+    }
+    // Child windows such as scrolling tables have draw lists of their own;
+    // only those begun inside the scope are counted.
+    const ImVector<ImGuiWindow*>& children = scope.window->DC.ChildWindows;
+    std::int64_t total = scope.window->DrawList->VtxBuffer.Size - scope.vertices;
+    for (int i = scope.child_windows; i < children.Size; ++i) {
+        total += WindowVertices(children[i]);
+    }
+    return total;
+}
+
+void Profiler::BeginFrame() {
+    ++frame_;
+    in_frame_ = true;
+    frame_start_ = Clock::now();
+    frame_allocations_ = ThreadAllocations();
+}
+
+void Profiler::EndFrame() {
+    if (!in_frame_) {
+        return;
+    }
+    in_frame_ = false;
+
+    Sample frame;
+    frame.cpu_us = std::chrono::duration<float, std::micro>(Clock::now() - frame_start_).count();
+    frame.self_us = frame.cpu_us;
+    frame.lock_us = static_cast<float>(frame_entry_.lock_ns) / 1e3f;
+    frame.allocations = static_cast<float>(ThreadAllocations() - frame_allocations_);
+    if (const ImDrawData* draw_data = ImGui::GetDrawData()) {
+        frame.vertices = static_cast<float>(draw_data->TotalVtxCount);
+    }
+    frame_entry_.lock_ns = 0;
+
+    if (!paused_) {
+        Record(frame_entry_, frame);
+        for (const void* key : touched_) {
+            const auto it = entries_.find(key);
+            if (it == entries_.end()) {
+                continue;
+            }
+            Entry& entry = it->second;
+            Sample sample;
+            sample.cpu_us = static_cast<float>(entry.cpu_ns) / 1e3f;
+            sample.self_us = static_cast<float>(entry.cpu_ns - entry.child_ns) / 1e3f;
+            sample.lock_us = static_cast<float>(entry.lock_ns) / 1e3f;
+            sample.allocations = static_cast<float>(entry.allocations);
+            sample.vertices = static_cast<float>(entry.vertices);
+            Record(entry, sample);
+        }
+    }
+    touched_.clear();
+
+    if (frame_ % kHistory == 0) {
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (frame_ - it->second.last_frame > kForgetAfterFrames) {
+                it = entries_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void Profiler::Record(Entry& entry, const Sample& sample) {
+    const Sample& old = entry.history[entry.next];
+    if (entry.count == kHistory) {
+        entry.sum.cpu_us -= old.cpu_us;
+        entry.sum.self_us -= old.self_us;
+        entry.sum.lock_us -= old.lock_us;
+        entry.sum.allocations -= old.allocations;
+        entry.sum.vertices -= old.vertices;
+    } else {
+        ++entry.count;
+    }
+    entry.sum.cpu_us += sample.cpu_us;
+    entry.sum.self_us += sample.self_us;
+    entry.sum.lock_us += sample.lock_us;
+    entry.sum.allocations += sample.allocations;
+    entry.sum.vertices += sample.vertices;
+    entry.history[entry.next] = sample;
+    entry.next = (entry.next + 1) % kHistory;
+}
+
+Profiler::Entry& Profiler::EntryFor(ProfileKind kind, const void* key) {
+    Entry& entry = entries_[key];
+    entry.kind = kind;
+    if (entry.last_frame != frame_) {
+        entry.last_frame = frame_;
+        entry.cpu_ns = 0;
+        entry.child_ns = 0;
+        entry.lock_ns = 0;
+        entry.allocations = 0;
+        entry.vertices = 0;
+        touched_.push_back(key);
+    }
+    entry.parent = open_.empty() ? nullptr : open_.back().key;
+    return entry;
+}
+
+void Profiler::Enter(ProfileKind kind, const void* key, const std::string& name) {
+    Entry& entry = EntryFor(kind, key);
+    if (entry.name != name) {
+        entry.name = name;
+    }
+    Open(entry, key);
+}
+
+void Profiler::Enter(ProfileKind kind, const void* key, const char* name) {
+    Entry& entry = EntryFor(kind, key);
+    if (entry.name != name) {
+        entry.name = name;
+    }
+    Open(entry, key);
+}
+
+void Profiler::Open(Entry& entry, const void* key) {
+    // Counters are read last so the bookkeeping above is not charged to
+    // the scope.
+    ImGuiWindow* window = ImGui::GetCurrentContext() != nullptr ? ImGui::GetCurrentWindowRead() : nullptr;
+    const int vertices = window != nullptr ? window->DrawList->VtxBuffer.Size : 0;
+    const int child_windows = window != nullptr ? window->DC.ChildWindows.Size : 0;
+    open_.push_back(OpenScope{&entry, key, ThreadAllocations(), window, vertices, child_windows, 0, Clock::now()});
+}
+
+void Profiler::Exit() {
+    const auto now = Clock::now();
+    const std::uint64_t allocations = ThreadAllocations();
+    const OpenScope scope = open_.back();
+    open_.pop_back();
+    const std::int64_t vertices = VerticesOf(scope);
+
+    const std::int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - scope.start).count();
+    Entry& entry = *scope.entry;
+    entry.cpu_ns += elapsed;
+    entry.allocations += allocations - scope.allocations;
+    entry.vertices += vertices;
+    if (!open_.empty()) {
+        open_.back().entry->child_ns += elapsed;
+        open_.back().child_vertices += vertices;
+    }
+}
+
+void Profiler::AddLockWait(std::chrono::nanoseconds wait) noexcept {
+    frame_entry_.lock_ns += wait.count();
+    if (!open_.empty()) {
+        open_.back().entry->lock_ns += wait.count();
+    }
+}
+
+float Profiler::MaxCpu(const Entry& entry) {
+    float max_us = 0.0f;
+    for (std::size_t i = 0; i < entry.count; ++i) {
+        max_us = std::max(max_us, entry.history[i].cpu_us);
+    }
+    return max_us;
+}
+
+Profiler::Sample Profiler::Mean(const Entry& entry) {
+    Sample mean;
+    if (entry.count == 0) {
+        return mean;
+    }
+    const float count = static_cast<float>(entry.count);
+    mean.cpu_us = static_cast<float>(entry.sum.cpu_us / count);
+    mean.self_us = static_cast<float>(entry.sum.self_us / count);
+    mean.lock_us = static_cast<float>(entry.sum.lock_us / count);
+    mean.allocations = static_cast<float>(entry.sum.allocations / count);
+    mean.vertices = static_cast<float>(entry.sum.vertices / count);
+    return mean;
+}
+
+std::size_t Profiler::History(const Entry& entry, float Sample::*field) {
+    plot_.resize(entry.count);
+    const std::size_t first = entry.count == kHistory ? entry.next : 0;
+    for (std::size_t i = 0; i < entry.count; ++i) {
+        plot_[i] = entry.history[(first + i) % kHistory].*field;
+    }
+    return entry.count;
+}
+
+std::string Profiler::PathOf(const void* key) const {
+    std::string path;
+    // Bounded in case a reused address made an entry its own ancestor.
+    for (int depth = 0; key != nullptr && depth < 32; ++depth) {
+        const auto it = entries_.find(key);
+        if (it == entries_.end() || it->second.kind == ProfileKind::kPhase) {
+            break;
+        }
+        const std::string& name = it->second.name.empty() ? std::string(KindName(it->second.kind)) : it->second.name;
+        path = path.empty() ? name : name + "/" + path;
+        key = it->second.parent;
+    }
+    return path;
+}
+
+void Profiler::RenderWindow() {
+    ImGui::SetNextWindowSize(ImVec2(760.0f, 480.0f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("DebugGlass Perf")) {
+        ImGui::End();
+        return;
+    }
+
+    const Sample frame = Mean(frame_entry_);
+    ImGui::Text("Frame %.2f ms (max %.2f)  allocs %.0f  vertices %.0f  lock wait %.1f us", frame.cpu_us / 1e3f,
+                MaxCpu(frame_entry_) / 1e3f, frame.allocations, frame.vertices, frame.lock_us);
+    ImGui::SameLine();
+    ImGui::Checkbox("Pause", &paused_);
+    const std::size_t points = History(frame_entry_, &Sample::cpu_us);
+    ImGui::PlotLines("##frame", plot_.data(), static_cast<int>(points), 0, "frame CPU (us)", 0.0f, FLT_MAX,
+                     ImVec2(-1.0f, 60.0f));
+
+    // Steps of the frame on one line each.
+    for (const auto& [key, entry] : entries_) {
+        if (entry.kind == ProfileKind::kPhase) {
+            const Sample mean = Mean(entry);
+            ImGui::Text("%-14s %8.1f us  %6.0f allocs", entry.name.c_str(), mean.cpu_us, mean.allocations);
+        }
+    }
+    ImGui::Separator();
+    RenderTable();
+    ImGui::End();
+}
+
+void Profiler::RenderTable() {
+    const ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable |
+                                  ImGuiTableFlags_ScrollY | ImGuiTableFlags_Sortable | ImGuiTableFlags_Hideable;
+    if (!ImGui::BeginTable("scopes", kColumnCount, flags)) {
+        return;
+    }
+    const ImGuiTableColumnFlags stat_flags = ImGuiTableColumnFlags_WidthFixed |
+                                             ImGuiTableColumnFlags_PreferSortDescending;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Kind", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("CPU us", stat_flags | ImGuiTableColumnFlags_DefaultSort);
+    ImGui::TableSetupColumn("Self us", stat_flags);
+    ImGui::TableSetupColumn("Max us", stat_flags);
+    ImGui::TableSetupColumn("Lock us", stat_flags);
+    ImGui::TableSetupColumn("Allocs", stat_flags);
+    ImGui::TableSetupColumn("Vertices", stat_flags);
+    ImGui::TableSetupColumn("History", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoSort, 120.0f);
+    ImGui::TableHeadersRow();
+
+    if (ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs()) {
+        if (specs->SpecsCount > 0) {
+            sort_column_ = specs->Specs[0].ColumnIndex;
+            sort_descending_ = specs->Specs[0].SortDirection == ImGuiSortDirection_Descending;
+        }
+        specs->SpecsDirty = false;
+    }
+
+    rows_.clear();
+    for (const auto& [key, entry] : entries_) {
+        if (entry.kind != ProfileKind::kPhase && entry.last_frame + kHistory >= frame_) {
+            rows_.push_back(&entry);
+        }
+    }
+    const auto sort_key = [this](const Entry* entry) -> float {
+        const Sample mean = Mean(*entry);
+        switch (sort_column_) {
+        case kColumnSelf:
+            return mean.self_us;
+        case kColumnMax:
+            return MaxCpu(*entry);
+        case kColumnLock:
+            return mean.lock_us;
+        case kColumnAllocations:
+            return mean.allocations;
+        case kColumnVertices:
+            return mean.vertices;
+        case kColumnKind:
+            return static_cast<float>(entry->kind);
+        default:
+            return mean.cpu_us;
+        }
+    };
+    if (sort_column_ == kColumnScope) {
+        std::sort(rows_.begin(), rows_.end(), [this](const Entry* a, const Entry* b) {
+            return sort_descending_ ? a->name > b->name : a->name < b->name;
+        });
+    } else {
+        std::vector<std::pair<float, const Entry*>> keyed;
+        keyed.reserve(rows_.size());
+        for (const Entry* entry : rows_) {
+            keyed.emplace_back(sort_key(entry), entry);
+        }
+        std::stable_sort(keyed.begin(), keyed.end(), [this](const auto& a, const auto& b) {
+            return sort_descending_ ? a.first > b.first : a.first < b.first;
+        });
+        for (std::size_t i = 0; i < keyed.size(); ++i) {
+            rows_[i] = keyed[i].second;
+        }
+    }
+
+    // Entries are keyed by address; map them back for paths.
+    std::unordered_map<const Entry*, const void*> keys;
+    keys.reserve(entries_.size());
+    for (const auto& [key, entry] : entries_) {
+        keys.emplace(&entry, key);
+    }
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(rows_.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            const Entry& entry = *rows_[static_cast<std::size_t>(row)];
+            const Sample mean = Mean(entry);
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(kColumnScope);
+            const std::string path = PathOf(keys[&entry]);
+            ImGui::TextUnformatted(path.c_str());
+            ImGui::TableSetColumnIndex(kColumnKind);
+            ImGui::TextUnformatted(KindName(entry.kind));
+            ImGui::TableSetColumnIndex(kColumnCpu);
+            ImGui::Text("%.1f", mean.cpu_us);
+            ImGui::TableSetColumnIndex(kColumnSelf);
+            ImGui::Text("%.1f", mean.self_us);
+            ImGui::TableSetColumnIndex(kColumnMax);
+            ImGui::Text("%.1f", MaxCpu(entry));
+            ImGui::TableSetColumnIndex(kColumnLock);
+            ImGui::Text("%.1f", mean.lock_us);
+            ImGui::TableSetColumnIndex(kColumnAllocations);
+            ImGui::Text("%.1f", mean.allocations);
+            ImGui::TableSetColumnIndex(kColumnVertices);
+            ImGui::Text("%.0f", mean.vertices);
+            ImGui::TableSetColumnIndex(kColumnHistory);
+            const std::size_t points = History(entry, &Sample::cpu_us);
+            ImGui::PushID(row);
+            ImGui::PlotLines("##history", plot_.data(), static_cast<int>(points), 0, nullptr, 0.0f, FLT_MAX,
+                             ImVec2(-1.0f, ImGui::GetTextLineHeight()));
+            ImGui::PopID();
+        }
+    }
+    clipper.End();
+    ImGui::EndTable();
+}
+
+}  // namespace debugglass
+
+#endif  // DEBUGGLASS_ENABLE_PROFILER
@@ -0,0 +1,210 @@
+#pragma once
+
+// Self-profiler for the render loop. Scoped timers around frame phases,
+// windows, tabs and widget Render calls record CPU time, time spent waiting
+// for widget locks, heap allocations and generated vertices, and
+// Profiler::RenderWindow draws them as the "DebugGlass Perf" window.
+//
+// Everything here is compiled in only when DEBUGGLASS_ENABLE_PROFILER is
+// defined (bazel build --config=profiler). Otherwise the macros expand to
+// nothing, or to a plain std::lock_guard, and their arguments are not
+// evaluated.
+
+#include <mutex>
+#include <type_traits>
+
+#if defined(DEBUGGLASS_ENABLE_PROFILER)
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ImGuiWindow;
+
+namespace debugglass {
+
+enum class ProfileKind : std::uint8_t { kPhase, kWindow, kTab, kCallback, kWidget };
+
+// Per-thread collector. Every render thread gets its own, so scopes need no
+// synchronisation; the Perf window shows the collector of the thread that
+// draws it.
+class Profiler {
+public:
+    // Frames of rolling history kept per scope.
+    static constexpr std::size_t kHistory = 120;
+    // Scopes not entered for this many frames are forgotten.
+    static constexpr std::uint64_t kForgetAfterFrames = 600;
+
+    static Profiler& Current();
+
+    void BeginFrame();
+    // Reads the vertex count of the frame from ImGui's draw data.
+    void EndFrame();
+
+    // Starts a scope nested in the innermost open one. `key` identifies the
+    // scope across frames, usually the object being drawn.
+    void Enter(ProfileKind kind, const void* key, const std::string& name);
+    void Enter(ProfileKind kind, const void* key, const char* name);
+    void Exit();
+
+    // Charges lock wait time to the innermost open scope.
+    void AddLockWait(std::chrono::nanoseconds wait) noexcept;
+
+    // Draws the "DebugGlass Perf" window. Call between ImGui::NewFrame and
+    // ImGui::Render, outside any scope.
+    void RenderWindow();
+
+    // Heap allocations made by the calling thread through operator new and
+    // ImGui's allocator since it started.
+    static std::uint64_t ThreadAllocations() noexcept;
+
+private:
+    struct Sample {
+        float cpu_us = 0.0f;
+        float self_us = 0.0f;
+        float lock_us = 0.0f;
+        float allocations = 0.0f;
+        float vertices = 0.0f;
+    };
+
+    struct Entry {
+        ProfileKind kind = ProfileKind::kWidget;
+        std::string name;
+        const void* parent = nullptr;
+        std::uint64_t last_frame = 0;
+        // Totals of the frame in progress.
+        std::int64_t cpu_ns = 0;
+        std::int64_t child_ns = 0;
+        std::int64_t lock_ns = 0;
+        std::uint64_t allocations = 0;
+        std::int64_t vertices = 0;
+        // Rolling history, oldest overwritten first.
+        std::array<Sample, kHistory> history{};
+        std::size_t next = 0;
+        std::size_t count = 0;
+        // Running sums over the history, for the means.
+        struct {
+            double cpu_us = 0.0;
+            double self_us = 0.0;
+            double lock_us = 0.0;
+            double allocations = 0.0;
+            double vertices = 0.0;
+        } sum;
+    };
+
+    struct OpenScope {
+        Entry* entry;
+        const void* key;
+        std::uint64_t allocations;
+        // Window current at Enter, with its draw list and child window
+        // counts then.
+        ImGuiWindow* window;
+        int vertices;
+        int child_windows;
+        // Vertices reported by nested scopes, summed for phases.
+        std::int64_t child_vertices;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    Profiler();
+
+    Entry& EntryFor(ProfileKind kind, const void* key);
+    void Open(Entry& entry, const void* key);
+    static void Record(Entry& entry, const Sample& sample);
+    static Sample Mean(const Entry& entry);
+    static float MaxCpu(const Entry& entry);
+    // Copies one field of the history into plot_, oldest first.
+    std::size_t History(const Entry& entry, float Sample::*field);
+    // Vertices the scope generated. Windows are counted from their final
+    // draw lists, since Begin clears them; other scopes from the growth of
+    // the window they started in plus any child windows they began.
+    static std::int64_t VerticesOf(const OpenScope& scope);
+    std::string PathOf(const void* key) const;
+    void RenderTable();
+
+    std::unordered_map<const void*, Entry> entries_;
+    std::vector<OpenScope> open_;
+    std::vector<const void*> touched_;
+    std::uint64_t frame_ = 0;
+    bool in_frame_ = false;
+
+    // The frame as a whole.
+    Entry frame_entry_;
+    Clock::time_point frame_start_;
+    std::uint64_t frame_allocations_ = 0;
+
+    // Perf window state.
+    std::vector<const Entry*> rows_;
+    std::vector<float> plot_;
+    int sort_column_ = 2;
+    bool sort_descending_ = true;
+    bool paused_ = false;
+};
+
+class ProfileScope {
+public:
+    template <typename Name>
+    ProfileScope(ProfileKind kind, const void* key, const Name& name) : profiler_(Profiler::Current()) {
+        profiler_.Enter(kind, key, name);
+    }
+    ~ProfileScope() { profiler_.Exit(); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    Profiler& profiler_;
+};
+
+// std::lock_guard that charges contended waits to the innermost scope.
+// Uncontended locks cost one try_lock and are not timed.
+template <typename Mutex>
+class ProfiledLockGuard {
+public:
+    explicit ProfiledLockGuard(Mutex& mutex) : mutex_(mutex) {
+        if (!mutex_.try_lock()) {
+            const auto start = std::chrono::steady_clock::now();
+            mutex_.lock();
+            Profiler::Current().AddLockWait(std::chrono::steady_clock::now() - start);
+        }
+    }
+    ~ProfiledLockGuard() { mutex_.unlock(); }
+
+    ProfiledLockGuard(const ProfiledLockGuard&) = delete;
+    ProfiledLockGuard& operator=(const ProfiledLockGuard&) = delete;
+
+private:
+    Mutex& mutex_;
+};
+
+}  // namespace debugglass
+
+#define DEBUGGLASS_PROFILE_CONCAT_INNER(a, b) a##b
+#define DEBUGGLASS_PROFILE_CONCAT(a, b) DEBUGGLASS_PROFILE_CONCAT_INNER(a, b)
+
+#define DEBUGGLASS_PROFILE_BEGIN_FRAME() ::debugglass::Profiler::Current().BeginFrame()
+#define DEBUGGLASS_PROFILE_END_FRAME() ::debugglass::Profiler::Current().EndFrame()
+#define DEBUGGLASS_PROFILE_SCOPE(kind, key, name) \
+    ::debugglass::ProfileScope DEBUGGLASS_PROFILE_CONCAT(debugglass_profile_scope_, __LINE__)(kind, key, name)
+// A named step of the frame; `name` must be a string literal.
+#define DEBUGGLASS_PROFILE_PHASE(name) DEBUGGLASS_PROFILE_SCOPE(::debugglass::ProfileKind::kPhase, name, name)
+#define DEBUGGLASS_PROFILED_LOCK(lock, mutex) \
+    ::debugglass::ProfiledLockGuard<std::remove_reference_t<decltype(mutex)>> lock(mutex)
+#define DEBUGGLASS_PROFILER_WINDOW() ::debugglass::Profiler::Current().RenderWindow()
+
+#else
+
+#define DEBUGGLASS_PROFILE_BEGIN_FRAME() static_cast<void>(0)
+#define DEBUGGLASS_PROFILE_END_FRAME() static_cast<void>(0)
+#define DEBUGGLASS_PROFILE_SCOPE(kind, key, name) static_cast<void>(0)
+#define DEBUGGLASS_PROFILE_PHASE(name) static_cast<void>(0)
+#define DEBUGGLASS_PROFILED_LOCK(lock, mutex) std::lock_guard<std::remove_reference_t<decltype(mutex)>> lock(mutex)
+#define DEBUGGLASS_PROFILER_WINDOW() static_cast<void>(0)
+
+#endif
@@ -0,0 +1,129 @@
+#include "debugglass/util/rcu.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace debugglass {
+namespace {
+// Epoch a reader announced on entry, or kQuiescent outside any guard.
+constexpr std::uint64_t kQuiescent = 0;
+
+struct alignas(64) ReaderSlot {
+    std::atomic<std::uint64_t> epoch{kQuiescent};
+    std::atomic<bool> in_use{false};
+    ReaderSlot* next = nullptr;
+};
+
+struct Retired {
+    void* object;
+    void (*deleter)(void*);
+    std::uint64_t epoch;
+};
+
+struct RcuState {
+    // Starts above kQuiescent so a live reader never announces zero.
+    std::atomic<std::uint64_t> epoch{1};
+    // Slots are never freed; a thread that exits hands its slot to the next
+    // one that needs it.
+    std::atomic<ReaderSlot*> slots{nullptr};
+    std::mutex retired_mutex;
+    std::vector<Retired> retired;
+    std::atomic<std::size_t> retired_count{0};
+};
+
+RcuState& State() {
+    static RcuState* state = new RcuState();
+    return *state;
+}
+
+ReaderSlot* AcquireSlot() {
+    RcuState& state = State();
+    for (ReaderSlot* slot = state.slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+        bool expected = false;
+        if (!slot->in_use.load(std::memory_order_relaxed) &&
+            slot->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return slot;
+        }
+    }
+    auto* slot = new ReaderSlot();
+    slot->in_use.store(true, std::memory_order_relaxed);
+    ReaderSlot* head = state.slots.load(std::memory_order_relaxed);
+    do {
+        slot->next = head;
+    } while (!state.slots.compare_exchange_weak(head, slot, std::memory_order_release, std::memory_order_relaxed));
+    return slot;
+}
+
+struct ThreadReader {
+    ThreadReader() : slot(AcquireSlot()) {}
+    ~ThreadReader() { slot->in_use.store(false, std::memory_order_release); }
+
+    ReaderSlot* slot;
+    int depth = 0;
+};
+
+ThreadReader& LocalReader() {
+    thread_local ThreadReader reader;
+    return reader;
+}
+}  // namespace
+
+Rcu::ReadGuard::ReadGuard() {
+    ThreadReader& reader = LocalReader();
+    if (reader.depth++ == 0) {
+        reader.slot->epoch.store(State().epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+}
+
+Rcu::ReadGuard::~ReadGuard() {
+    ThreadReader& reader = LocalReader();
+    if (--reader.depth == 0) {
+        reader.slot->epoch.store(kQuiescent, std::memory_order_release);
+    }
+}
+
+void Rcu::Retire(void* object, void (*deleter)(void*)) {
+    RcuState& state = State();
+    {
+        std::lock_guard<std::mutex> lock(state.retired_mutex);
+        // Readers that announce a later epoch entered after the object was
+        // unpublished and cannot see it.
+        const std::uint64_t epoch = state.epoch.fetch_add(1, std::memory_order_seq_cst);
+        state.retired.push_back(Retired{object, deleter, epoch});
+        state.retired_count.store(state.retired.size(), std::memory_order_relaxed);
+    }
+    Reclaim();
+}
+
+void Rcu::Reclaim() {
+    RcuState& state = State();
+    if (state.retired_count.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    std::vector<Retired> ready;
+    {
+        std::lock_guard<std::mutex> lock(state.retired_mutex);
+        std::uint64_t oldest_reader = std::numeric_limits<std::uint64_t>::max();
+        for (ReaderSlot* slot = state.slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+            const std::uint64_t epoch = slot->epoch.load(std::memory_order_seq_cst);
+            if (epoch != kQuiescent) {
+                oldest_reader = std::min(oldest_reader, epoch);
+            }
+        }
+        const auto still_visible = std::partition(state.retired.begin(), state.retired.end(),
+                                                  [&](const Retired& entry) { return entry.epoch < oldest_reader; });
+        ready.assign(state.retired.begin(), still_visible);
+        state.retired.erase(state.retired.begin(), still_visible);
+        state.retired_count.store(state.retired.size(), std::memory_order_relaxed);
+    }
+
+    // Deleters may release widgets whose own lists retire more nodes, so run
+    // them outside the lock.
+    for (const Retired& entry : ready) {
+        entry.deleter(entry.object);
+    }
+}
+
+}  // namespace debugglass
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "debugglass/util/slab_pool.h"
+
+namespace debugglass {
+
+// Epoch-based reclamation for data that is read far more often than it is
+// replaced. Readers hold a ReadGuard while they dereference published
+// pointers; writers swap in a new version and Retire the old one, which is
+// freed once every reader that could still see it has left its guard.
+// Entering a guard is two atomic stores to a thread-local slot: no locks and
+// no shared reference counts.
+class Rcu {
+public:
+    class ReadGuard {
+    public:
+        ReadGuard();
+        ~ReadGuard();
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    };
+
+    // Frees `object` once no ReadGuard that might still see it remains.
+    template <typename T>
+    static void Retire(const T* object) {
+        if (object != nullptr) {
+            Retire(const_cast<T*>(object), [](void* pointer) { delete static_cast<T*>(pointer); });
+        }
+    }
+
+    static void Retire(void* object, void (*deleter)(void*));
+
+    // Frees whatever has become safe. Called by Retire and by the render
+    // loop after each frame; cheap when nothing is pending.
+    static void Reclaim();
+};
+
+// Append-mostly list read without locks. Readers see an immutable prefix of
+// a node's slots; appends fill the next slot and publish the new size, and a
+// new node is only copied when the current one is full or an element is
+// removed. Writers are serialised by an internal mutex. Nodes of small lists
+// come from the slab pools, so churn does not reach the global allocator.
+template <typename T>
+class RcuList {
+public:
+    class View {
+    public:
+        const T* begin() const noexcept { return data_; }
+        const T* end() const noexcept { return data_ + size_; }
+        std::size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+
+    private:
+        friend class RcuList;
+        View(const T* data, std::size_t size) : data_(data), size_(size) {}
+
+        const T* data_;
+        std::size_t size_;
+    };
+
+    RcuList() : node_(new Node(kInitialCapacity)) {}
+
+    // Must not run while readers may still hold a view.
+    ~RcuList() { delete node_.load(std::memory_order_relaxed); }
+
+    RcuList(const RcuList&) = delete;
+    RcuList& operator=(const RcuList&) = delete;
+
+    // Only valid while the calling thread holds an Rcu::ReadGuard.
+    View Read() const noexcept {
+        const Node* node = node_.load(std::memory_order_seq_cst);
+        return View(node->items, node->size.load(std::memory_order_acquire));
+    }
+
+    std::vector<T> Copy() const {
+        Rcu::ReadGuard guard;
+        const View view = Read();
+        return std::vector<T>(view.begin(), view.end());
+    }
+
+    void PushBack(T value) {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        Node* node = node_.load(std::memory_order_relaxed);
+        const std::size_t size = node->size.load(std::memory_order_relaxed);
+        if (size == node->capacity) {
+            Node* grown = CopyNode(*node, node->capacity * 2, [](const T&) { return false; });
+            Publish(grown, node);
+            node = grown;
+        }
+        node->items[size] = std::move(value);
+        node->size.store(size + 1, std::memory_order_release);
+    }
+
+    // Removes every element for which `predicate` returns true. Returns the
+    // number removed.
+    template <typename Predicate>
+    std::size_t RemoveIf(Predicate predicate) {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        Node* node = node_.load(std::memory_order_relaxed);
+        const std::size_t size = node->size.load(std::memory_order_relaxed);
+        std::size_t removed = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            removed += predicate(node->items[i]) ? 1 : 0;
+        }
+        if (removed != 0) {
+            Publish(CopyNode(*node, node->capacity, predicate), node);
+        }
+        return removed;
+    }
+
+private:
+    static constexpr std::size_t kInitialCapacity = 8;
+
+    struct Node {
+        explicit Node(std::size_t slots)
+            : capacity(slots), items(static_cast<T*>(AllocateBytes(slots * sizeof(T)))) {
+            std::uninitialized_value_construct_n(items, capacity);
+        }
+
+        ~Node() {
+            std::destroy_n(items, capacity);
+            DeallocateBytes(items, capacity * sizeof(T));
+        }
+
+        Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
+
+        static void* operator new(std::size_t bytes) { return AllocateBytes(bytes); }
+        static void operator delete(void* block, std::size_t bytes) noexcept { DeallocateBytes(block, bytes); }
+
+        std::size_t capacity;
+        T* items;
+        std::atomic<std::size_t> size{0};
+    };
+
+    template <typename Skip>
+    static Node* CopyNode(const Node& from, std::size_t capacity, const Skip& skip) {
+        auto node = std::make_unique<Node>(capacity);
+        std::size_t size = 0;
+        for (std::size_t i = 0; i < from.size.load(std::memory_order_relaxed); ++i) {
+            if (!skip(from.items[i])) {
+                node->items[size++] = from.items[i];
+            }
+        }
+        node->size.store(size, std::memory_order_relaxed);
+        return node.release();
+    }
+
+    void Publish(Node* next, Node* previous) {
+        node_.store(next, std::memory_order_seq_cst);
+        Rcu::Retire(previous);
+    }
+
+    std::mutex writer_mutex_;
+    std::atomic<Node*> node_;
+};
+
+// A single value replaced as a whole, read without locks. Empty until the
+// first Store.
+template <typename T>
+class RcuBox {
+public:
+    RcuBox() = default;
+    ~RcuBox() { delete value_.load(std::memory_order_relaxed); }
+
+    RcuBox(const RcuBox&) = delete;
+    RcuBox& operator=(const RcuBox&) = delete;
+
+    // Only valid while the calling thread holds an Rcu::ReadGuard. Null when
+    // nothing has been stored.
+    const T* Read() const noexcept { return value_.load(std::memory_order_seq_cst); }
+
+    void Store(T value) {
+        const T* previous = value_.exchange(new T(std::move(value)), std::memory_order_seq_cst);
+        Rcu::Retire(previous);
+    }
+
+private:
+    std::atomic<const T*> value_{nullptr};
+};
+
+}  // namespace debugglass
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <atomic>
+
+namespace debugglass {
+
+// Process-wide "something changed" flag. Widgets raise it on every write and
+// an on-demand render loop consumes it to decide whether a frame is needed.
+// Raising only stores when the flag is clear, so producers hammering it keep
+// the cache line shared instead of bouncing it between cores.
+class RedrawSignal {
+public:
+    static void Raise() noexcept {
+        if (!pending_.load(std::memory_order_relaxed)) {
+            pending_.store(true, std::memory_order_release);
+        }
+    }
+
+    // Returns whether a redraw was requested since the last call.
+    static bool Consume() noexcept {
+        return pending_.load(std::memory_order_relaxed) && pending_.exchange(false, std::memory_order_acquire);
+    }
+
+private:
+    static inline std::atomic<bool> pending_{true};
+};
+
+}  // namespace debugglass
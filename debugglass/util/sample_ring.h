@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace debugglass {
+
+// Fixed-capacity ring of float samples that never blocks its producers.
+// Every slot carries a sequence stamp, so the consumer can copy the ring while
+// producers keep writing and simply skips slots that were overwritten or are
+// still being written during the copy.
+class SampleRing {
+public:
+    explicit SampleRing(std::size_t capacity);
+
+    SampleRing(const SampleRing&) = delete;
+    SampleRing& operator=(const SampleRing&) = delete;
+
+    std::size_t capacity() const noexcept { return capacity_; }
+    std::uint64_t total_pushed() const noexcept { return head_.load(std::memory_order_acquire); }
+
+    // Wait-free; only valid while a single thread pushes.
+    void Push(float value) noexcept {
+        const std::uint64_t index = head_.load(std::memory_order_relaxed);
+        head_.store(index + 1, std::memory_order_relaxed);
+        Write(index, value);
+    }
+
+    // Wait-free wherever fetch_add is a single instruction; any number of
+    // threads may push concurrently.
+    void PushConcurrent(float value) noexcept {
+        Write(head_.fetch_add(1, std::memory_order_relaxed), value);
+    }
+
+    // Appends `count` samples with one reservation on head_ and one pair of
+    // fences for the whole block instead of one per sample. Only the newest
+    // capacity() samples of an oversized block are written; the rest would
+    // be overwritten anyway.
+    void PushBatch(const float* values, std::size_t count) noexcept {
+        const std::uint64_t first = head_.load(std::memory_order_relaxed);
+        head_.store(first + count, std::memory_order_relaxed);
+        WriteBatch(first, values, count);
+    }
+
+    void PushBatchConcurrent(const float* values, std::size_t count) noexcept {
+        WriteBatch(head_.fetch_add(count, std::memory_order_relaxed), values, count);
+    }
+
+    // Copies the newest samples into `out` (at least capacity() floats) in
+    // chronological order and returns how many were written.
+    std::size_t CopyOrdered(float* out) const noexcept;
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> stamp{0};
+        std::atomic<float> value{0.0f};
+    };
+
+    void Write(std::uint64_t index, float value) noexcept {
+        Slot& slot = slots_[static_cast<std::size_t>(index & mask_)];
+        slot.stamp.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.value.store(value, std::memory_order_relaxed);
+        slot.stamp.store(index + 1, std::memory_order_release);
+    }
+
+    // Same protocol as Write, phase by phase: every stamp is cleared before
+    // any value changes and every value lands before any stamp is set, so a
+    // reader can never pair a new stamp with an old value or vice versa.
+    void WriteBatch(std::uint64_t first, const float* values, std::size_t count) noexcept {
+        if (count > capacity_) {
+            first += count - capacity_;
+            values += count - capacity_;
+            count = capacity_;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            slots_[static_cast<std::size_t>((first + i) & mask_)].stamp.store(0, std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < count; ++i) {
+            slots_[static_cast<std::size_t>((first + i) & mask_)].value.store(values[i], std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < count; ++i) {
+            slots_[static_cast<std::size_t>((first + i) & mask_)].stamp.store(first + i + 1,
+                                                                              std::memory_order_relaxed);
+        }
+    }
+
+    std::size_t capacity_;
+    std::uint64_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<std::uint64_t> head_{0};
+};
+
+inline SampleRing::SampleRing(std::size_t capacity) : capacity_(capacity) {
+    std::size_t storage = 1;
+    while (storage < capacity_) {
+        storage <<= 1;
+    }
+    mask_ = storage - 1;
+    slots_ = std::make_unique<Slot[]>(storage);
+}
+
+inline std::size_t SampleRing::CopyOrdered(float* out) const noexcept {
+    const std::uint64_t head = head_.load(std::memory_order_acquire);
+    const std::uint64_t count = head < capacity_ ? head : capacity_;
+    std::size_t written = 0;
+    for (std::uint64_t index = head - count; index < head; ++index) {
+        const Slot& slot = slots_[static_cast<std::size_t>(index & mask_)];
+        if (slot.stamp.load(std::memory_order_acquire) != index + 1) {
+            continue;
+        }
+        const float value = slot.value.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.stamp.load(std::memory_order_relaxed) != index + 1) {
+            continue;
+        }
+        out[written++] = value;
+    }
+    return written;
+}
+
+}  // namespace debugglass
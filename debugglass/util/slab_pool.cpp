@@ -0,0 +1,101 @@
+#include "debugglass/util/slab_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace debugglass {
+
+SlabPool::SlabPool(std::size_t block_size, std::size_t block_align)
+    : block_align_(std::max(block_align, alignof(FreeBlock))) {
+    const std::size_t size = std::max(block_size, sizeof(FreeBlock));
+    block_size_ = (size + block_align_ - 1) / block_align_ * block_align_;
+}
+
+SlabPool::~SlabPool() {
+    for (void* slab : slabs_) {
+        ::operator delete(slab, std::align_val_t(block_align_));
+    }
+}
+
+void* SlabPool::Allocate() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_list_ == nullptr) {
+        AddSlabLocked();
+    }
+    FreeBlock* block = free_list_;
+    free_list_ = block->next;
+    ++live_blocks_;
+    return block;
+}
+
+void SlabPool::Deallocate(void* block) noexcept {
+    if (block == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto* free_block = static_cast<FreeBlock*>(block);
+    free_block->next = free_list_;
+    free_list_ = free_block;
+    --live_blocks_;
+}
+
+std::size_t SlabPool::live_blocks() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return live_blocks_;
+}
+
+void SlabPool::AddSlabLocked() {
+    auto* slab = static_cast<unsigned char*>(::operator new(block_size_ * kBlocksPerSlab, std::align_val_t(block_align_)));
+    slabs_.push_back(slab);
+    // Thread the free list front to back so consecutive allocations are
+    // adjacent in memory.
+    for (std::size_t i = kBlocksPerSlab; i-- > 0;) {
+        auto* block = reinterpret_cast<FreeBlock*>(slab + i * block_size_);
+        block->next = free_list_;
+        free_list_ = block;
+    }
+}
+
+namespace {
+constexpr std::size_t kSmallestClass = 64;
+constexpr std::size_t kClassCount = 7;  // 64 B .. 4 KiB
+
+std::size_t ClassFor(std::size_t bytes) {
+    std::size_t index = 0;
+    std::size_t size = kSmallestClass;
+    while (size < bytes) {
+        size <<= 1;
+        ++index;
+    }
+    return index;
+}
+
+SlabPool& PoolForClass(std::size_t index) {
+    static const std::array<SlabPool*, kClassCount> pools = [] {
+        std::array<SlabPool*, kClassCount> result{};
+        for (std::size_t i = 0; i < kClassCount; ++i) {
+            result[i] = new SlabPool(kSmallestClass << i, alignof(std::max_align_t));
+        }
+        return result;
+    }();
+    return *pools[index];
+}
+}  // namespace
+
+void* AllocateBytes(std::size_t bytes) {
+    if (bytes > kMaxPooledBytes) {
+        return ::operator new(bytes);
+    }
+    return PoolForClass(ClassFor(bytes)).Allocate();
+}
+
+void DeallocateBytes(void* block, std::size_t bytes) noexcept {
+    if (bytes > kMaxPooledBytes) {
+        ::operator delete(block);
+        return;
+    }
+    PoolForClass(ClassFor(bytes)).Deallocate(block);
+}
+
+}  // namespace debugglass
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace debugglass {
+
+// Fixed-size block allocator. Blocks are carved from slabs that are never
+// returned to the system, so objects of one size class sit next to each
+// other in memory and freeing and re-creating them recycles blocks through
+// a free list instead of the global allocator.
+class SlabPool {
+public:
+    SlabPool(std::size_t block_size, std::size_t block_align);
+    ~SlabPool();
+
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    void* Allocate();
+    void Deallocate(void* block) noexcept;
+
+    // Blocks handed out and not yet returned.
+    std::size_t live_blocks() const;
+
+    // One pool per size class, shared process-wide. Intentionally leaked so
+    // widgets released during static destruction can still return blocks.
+    template <std::size_t Size, std::size_t Align>
+    static SlabPool& Instance() {
+        static SlabPool* pool = new SlabPool(Size, Align);
+        return *pool;
+    }
+
+private:
+    static constexpr std::size_t kBlocksPerSlab = 64;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    void AddSlabLocked();
+
+    std::size_t block_size_;
+    std::size_t block_align_;
+    mutable std::mutex mutex_;
+    FreeBlock* free_list_ = nullptr;
+    std::vector<void*> slabs_;
+    std::size_t live_blocks_ = 0;
+};
+
+// Variable-size blocks for small containers: requests up to kMaxPooledBytes
+// are rounded up to a power of two and served from a per-class SlabPool,
+// larger ones go to the global allocator. Blocks are aligned for any scalar.
+inline constexpr std::size_t kMaxPooledBytes = 4096;
+void* AllocateBytes(std::size_t bytes);
+void DeallocateBytes(void* block, std::size_t bytes) noexcept;
+
+// Standard allocator over SlabPool for single objects; array requests go to
+// the global allocator. Stateless, so all instances compare equal.
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t count) {
+        if (count == 1) {
+            return static_cast<T*>(Pool().Allocate());
+        }
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    void deallocate(T* pointer, std::size_t count) noexcept {
+        if (count == 1) {
+            Pool().Deallocate(pointer);
+        } else {
+            ::operator delete(pointer, std::align_val_t(alignof(T)));
+        }
+    }
+
+    static SlabPool& Pool() { return SlabPool::Instance<sizeof(T), alignof(T)>(); }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+// make_shared for widgets: object and control block share one pooled block.
+template <typename T, typename... Args>
+std::shared_ptr<T> MakePooled(Args&&... args) {
+    return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
+
+}  // namespace debugglass
@@ -0,0 +1,47 @@
+#include "debugglass/util/value_format.h"
+
+#include <charconv>
+#include <system_error>
+
+namespace debugglass {
+namespace {
+std::string_view ToView(const NumberBuffer& buffer, std::to_chars_result result) {
+    if (result.ec != std::errc()) {
+        return {};
+    }
+    return std::string_view(buffer.data(), static_cast<std::size_t>(result.ptr - buffer.data()));
+}
+}  // namespace
+
+std::string_view FormatSigned(std::int64_t value, NumberBuffer& buffer) {
+    return ToView(buffer, std::to_chars(buffer.data(), buffer.data() + buffer.size(), value));
+}
+
+std::string_view FormatUnsigned(std::uint64_t value, NumberBuffer& buffer) {
+    return ToView(buffer, std::to_chars(buffer.data(), buffer.data() + buffer.size(), value));
+}
+
+std::string_view FormatFixed(double value, int precision, NumberBuffer& buffer) {
+    char* const first = buffer.data();
+    char* const last = buffer.data() + buffer.size();
+    auto result = std::to_chars(first, last, value, std::chars_format::fixed, precision);
+    if (result.ec != std::errc()) {
+        result = std::to_chars(first, last, value, std::chars_format::scientific, precision);
+    }
+    return ToView(buffer, result);
+}
+
+std::string_view FormatGeneral(double value, int precision, NumberBuffer& buffer) {
+    return ToView(buffer, std::to_chars(buffer.data(), buffer.data() + buffer.size(), value,
+                                        std::chars_format::general, precision));
+}
+
+std::string_view FormatShortest(double value, NumberBuffer& buffer) {
+    return ToView(buffer, std::to_chars(buffer.data(), buffer.data() + buffer.size(), value));
+}
+
+std::string_view FormatShortest(float value, NumberBuffer& buffer) {
+    return ToView(buffer, std::to_chars(buffer.data(), buffer.data() + buffer.size(), value));
+}
+
+}  // namespace debugglass
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace debugglass {
+
+// Scratch space for formatting a single number without touching the heap.
+using NumberBuffer = std::array<char, 64>;
+
+// std::to_chars based formatters. The returned view points into `buffer`.
+std::string_view FormatSigned(std::int64_t value, NumberBuffer& buffer);
+std::string_view FormatUnsigned(std::uint64_t value, NumberBuffer& buffer);
+// Fixed notation with `precision` decimals, falling back to scientific
+// notation for magnitudes that do not fit the buffer.
+std::string_view FormatFixed(double value, int precision, NumberBuffer& buffer);
+// Shortest of fixed/scientific with `precision` significant digits, matching
+// what a default-configured std::ostream prints.
+std::string_view FormatGeneral(double value, int precision, NumberBuffer& buffer);
+// Shortest text that reads back as exactly `value`, for lossless exports.
+std::string_view FormatShortest(double value, NumberBuffer& buffer);
+std::string_view FormatShortest(float value, NumberBuffer& buffer);
+
+// Formats any arithmetic value the way a default std::ostream prints it,
+// except that bools read true/false.
+template <typename T>
+std::string_view FormatArithmetic(T value, NumberBuffer& buffer) {
+    static_assert(std::is_arithmetic_v<T>, "FormatArithmetic takes arithmetic types only");
+    if constexpr (std::is_same_v<T, bool>) {
+        return value ? "true" : "false";
+    } else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+                         std::is_same_v<T, unsigned char>) {
+        buffer[0] = static_cast<char>(value);
+        return std::string_view(buffer.data(), 1);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return FormatGeneral(static_cast<double>(value), 6, buffer);
+    } else if constexpr (std::is_signed_v<T>) {
+        return FormatSigned(static_cast<std::int64_t>(value), buffer);
+    } else {
+        return FormatUnsigned(static_cast<std::uint64_t>(value), buffer);
+    }
+}
+
+}  // namespace debugglass
@@ -0,0 +1,320 @@
+#include "debugglass/widgets/bound_structure.h"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include <imgui.h>
+
+#include "debugglass/util/export.h"
+#include "debugglass/util/profiler.h"
+#include "debugglass/util/redraw_signal.h"
+#include "debugglass/util/value_format.h"
+#include "debugglass/widgets/typed_variable.h"
+
+namespace debugglass {
+namespace {
+template <typename T>
+T ReadAt(const unsigned char* bytes) {
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+std::string_view FormatRow(const StructLayout::Row& row, const unsigned char* bytes, NumberBuffer& buffer) {
+    using Kind = StructLayout::Row::Kind;
+    const unsigned char* field = bytes + row.offset;
+    switch (row.kind) {
+    case Kind::kBool:
+        return FormatArithmetic(ReadAt<bool>(field), buffer);
+    case Kind::kChar:
+        return FormatArithmetic(ReadAt<char>(field), buffer);
+    case Kind::kText: {
+        const char* text = reinterpret_cast<const char*>(field);
+        const void* terminator = std::memchr(text, '\0', row.size);
+        const auto length = terminator != nullptr ? static_cast<std::size_t>(static_cast<const char*>(terminator) - text)
+                                                  : row.size;
+        return std::string_view(text, length);
+    }
+    case Kind::kFloat:
+        if (row.size == sizeof(float)) {
+            return FormatArithmetic(ReadAt<float>(field), buffer);
+        }
+        if (row.size == sizeof(double)) {
+            return FormatArithmetic(ReadAt<double>(field), buffer);
+        }
+        return FormatArithmetic(ReadAt<long double>(field), buffer);
+    case Kind::kSigned:
+        switch (row.size) {
+        case 1:
+            return FormatSigned(ReadAt<std::int8_t>(field), buffer);
+        case 2:
+            return FormatSigned(ReadAt<std::int16_t>(field), buffer);
+        case 4:
+            return FormatSigned(ReadAt<std::int32_t>(field), buffer);
+        default:
+            return FormatSigned(ReadAt<std::int64_t>(field), buffer);
+        }
+    case Kind::kUnsigned:
+        switch (row.size) {
+        case 1:
+            return FormatUnsigned(ReadAt<std::uint8_t>(field), buffer);
+        case 2:
+            return FormatUnsigned(ReadAt<std::uint16_t>(field), buffer);
+        case 4:
+            return FormatUnsigned(ReadAt<std::uint32_t>(field), buffer);
+        default:
+            return FormatUnsigned(ReadAt<std::uint64_t>(field), buffer);
+        }
+    case Kind::kGroupBegin:
+    case Kind::kGroupEnd:
+        break;
+    }
+    return {};
+}
+
+void ExportRow(const StructLayout::Row& row, const unsigned char* bytes, ExportTable& table) {
+    using Kind = StructLayout::Row::Kind;
+    const unsigned char* field = bytes + row.offset;
+    switch (row.kind) {
+    case Kind::kBool:
+        table.AddArithmetic(ReadAt<bool>(field));
+        return;
+    case Kind::kChar:
+        table.AddArithmetic(ReadAt<char>(field));
+        return;
+    case Kind::kText: {
+        NumberBuffer unused;
+        table.AddText(FormatRow(row, bytes, unused));
+        return;
+    }
+    case Kind::kFloat:
+        if (row.size == sizeof(float)) {
+            table.AddArithmetic(ReadAt<float>(field));
+        } else if (row.size == sizeof(double)) {
+            table.AddArithmetic(ReadAt<double>(field));
+        } else {
+            table.AddArithmetic(ReadAt<long double>(field));
+        }
+        return;
+    // AddSigned/AddUnsigned directly: AddArithmetic would export one-byte
+    // integers (int8_t is a signed char) as text.
+    case Kind::kSigned:
+        switch (row.size) {
+        case 1:
+            table.AddSigned(ReadAt<std::int8_t>(field));
+            return;
+        case 2:
+            table.AddSigned(ReadAt<std::int16_t>(field));
+            return;
+        case 4:
+            table.AddSigned(ReadAt<std::int32_t>(field));
+            return;
+        default:
+            table.AddSigned(ReadAt<std::int64_t>(field));
+            return;
+        }
+    case Kind::kUnsigned:
+        switch (row.size) {
+        case 1:
+            table.AddUnsigned(ReadAt<std::uint8_t>(field));
+            return;
+        case 2:
+            table.AddUnsigned(ReadAt<std::uint16_t>(field));
+            return;
+        case 4:
+            table.AddUnsigned(ReadAt<std::uint32_t>(field));
+            return;
+        default:
+            table.AddUnsigned(ReadAt<std::uint64_t>(field));
+            return;
+        }
+    case Kind::kGroupBegin:
+    case Kind::kGroupEnd:
+        break;
+    }
+    table.AddNull();
+}
+
+// Array elements, named "[i]", attach to their array without a separator.
+std::string JoinPath(const std::string& parent, const std::string& name) {
+    if (!name.empty() && name.front() == '[') {
+        return parent + name;
+    }
+    return parent + "/" + name;
+}
+
+bool ValidScalarSize(StructLayout::Row::Kind kind, std::size_t size) {
+    using Kind = StructLayout::Row::Kind;
+    switch (kind) {
+    case Kind::kBool:
+        return size == sizeof(bool);
+    case Kind::kChar:
+        return size == sizeof(char);
+    case Kind::kFloat:
+        return size == sizeof(float) || size == sizeof(double) || size == sizeof(long double);
+    case Kind::kSigned:
+    case Kind::kUnsigned:
+        return size == 1 || size == 2 || size == 4 || size == 8;
+    case Kind::kText:
+        return size > 0;
+    case Kind::kGroupBegin:
+    case Kind::kGroupEnd:
+        return true;
+    }
+    return false;
+}
+}  // namespace
+
+void StructLayout::Render(const unsigned char* bytes) const {
+    NumberBuffer buffer;
+    for (std::size_t index = 0; index < rows_.size(); ++index) {
+        const Row& row = rows_[index];
+        switch (row.kind) {
+        case Row::Kind::kGroupBegin:
+            if (!ImGui::TreeNode(row.name.c_str())) {
+                // Land on the matching end row, which is skipped below so the
+                // closed node is not popped.
+                index = row.group_end;
+            }
+            break;
+        case Row::Kind::kGroupEnd:
+            ImGui::TreePop();
+            break;
+        default:
+            RenderVariableText(row.name, FormatRow(row, bytes, buffer));
+            break;
+        }
+    }
+}
+
+void StructLayout::Export(ExportTable& table, const std::string& path, const unsigned char* bytes) const {
+    std::vector<std::string> groups{path};
+    for (const Row& row : rows_) {
+        switch (row.kind) {
+        case Row::Kind::kGroupBegin:
+            groups.push_back(JoinPath(groups.back(), row.name));
+            break;
+        case Row::Kind::kGroupEnd:
+            groups.pop_back();
+            break;
+        default:
+            table.AddText(JoinPath(groups.back(), row.name));
+            ExportRow(row, bytes, table);
+            break;
+        }
+    }
+}
+
+void StructLayout::Encode(std::string& out) const {
+    AppendRaw(out, static_cast<std::uint32_t>(rows_.size()));
+    for (const Row& row : rows_) {
+        AppendRaw(out, static_cast<std::uint8_t>(row.kind));
+        AppendRaw(out, static_cast<std::uint64_t>(row.offset));
+        AppendRaw(out, static_cast<std::uint64_t>(row.size));
+        AppendRaw(out, static_cast<std::uint64_t>(row.group_end));
+        AppendString(out, row.name);
+    }
+}
+
+bool StructLayout::Decode(RecordReader& reader, std::size_t struct_size, StructLayout& out) {
+    std::uint32_t count = 0;
+    if (!reader.Get(count)) {
+        return false;
+    }
+    std::vector<Row> rows;
+    std::vector<std::size_t> open_groups;
+    for (std::uint32_t index = 0; index < count; ++index) {
+        std::uint8_t kind = 0;
+        std::uint64_t offset = 0;
+        std::uint64_t size = 0;
+        std::uint64_t group_end = 0;
+        Row row;
+        if (!reader.Get(kind) || !reader.Get(offset) || !reader.Get(size) || !reader.Get(group_end) ||
+            !reader.GetString(row.name) || kind > static_cast<std::uint8_t>(Row::Kind::kText)) {
+            return false;
+        }
+        row.kind = static_cast<Row::Kind>(kind);
+        row.offset = static_cast<std::size_t>(offset);
+        row.size = static_cast<std::size_t>(size);
+        row.group_end = static_cast<std::size_t>(group_end);
+        if (!ValidScalarSize(row.kind, row.size) || row.offset > struct_size || row.size > struct_size - row.offset) {
+            return false;
+        }
+        if (row.kind == Row::Kind::kGroupBegin) {
+            open_groups.push_back(index);
+        } else if (row.kind == Row::Kind::kGroupEnd) {
+            if (open_groups.empty() || rows[open_groups.back()].group_end != index) {
+                return false;
+            }
+            open_groups.pop_back();
+        }
+        rows.push_back(std::move(row));
+    }
+    if (!open_groups.empty()) {
+        return false;
+    }
+    out.rows_ = std::move(rows);
+    return true;
+}
+
+bool BeginBoundStructureNode(const void* id, const std::string& label) {
+    ImGui::PushID(id);
+    if (ImGui::TreeNode(label.c_str())) {
+        return true;
+    }
+    ImGui::PopID();
+    return false;
+}
+
+void EndBoundStructureNode() {
+    ImGui::TreePop();
+    ImGui::PopID();
+}
+
+void DefineBoundStructure(UpdateSink& sink,
+                          RemoteBinding& binding,
+                          std::uint32_t parent,
+                          const std::string& label,
+                          const StructLayout& layout,
+                          std::size_t struct_size) {
+    std::string params;
+    AppendRaw(params, static_cast<std::uint64_t>(struct_size));
+    layout.Encode(params);
+    DefineNode(sink, binding, RecordType::kBoundStructure, parent, label, params.data(), params.size());
+}
+
+LayoutStructure::LayoutStructure(std::string label, StructLayout layout, std::size_t size)
+    : label_(std::move(label)), layout_(std::move(layout)), bytes_(size), snapshot_(size) {}
+
+void LayoutStructure::SetBytes(const void* data, std::size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (size != bytes_.size()) {
+        return;
+    }
+    std::memcpy(bytes_.data(), data, size);
+    RedrawSignal::Raise();
+}
+
+void LayoutStructure::Render() const {
+    if (!BeginBoundStructureNode(this, label_)) {
+        return;
+    }
+    {
+        DEBUGGLASS_PROFILED_LOCK(lock, mutex_);
+        std::memcpy(snapshot_.data(), bytes_.data(), bytes_.size());
+    }
+    layout_.Render(snapshot_.data());
+    EndBoundStructureNode();
+}
+
+void LayoutStructure::ExportLeaves(ExportTable& table, const std::string& path) const {
+    std::vector<unsigned char> bytes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bytes = bytes_;
+    }
+    layout_.Export(table, path, bytes.data());
+}
+
+}  // namespace debugglass
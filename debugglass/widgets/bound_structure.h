@@ -0,0 +1,258 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "debugglass/util/redraw_signal.h"
+#include "debugglass/transport/record.h"
+#include "debugglass/transport/update_sink.h"
+#include "debugglass/util/seqlock.h"
+#include "debugglass/widgets/window_content.h"
+
+namespace debugglass {
+
+// Compile-time field list for a struct, declared by specialising
+// StructFields next to the struct:
+//
+//   template <>
+//   struct debugglass::StructFields<Pose> {
+//       static constexpr auto kFields = std::make_tuple(
+//           debugglass::Field("x", &Pose::x), debugglass::Field("joints", &Pose::joints));
+//   };
+//
+// Fields may be arithmetic types, enums, char arrays (shown as text), C or
+// std::arrays of any supported type, or structs that have their own
+// StructFields.
+template <typename T>
+struct StructFields;
+
+template <typename Owner, typename Member>
+struct FieldDescriptor {
+    const char* name;
+    Member Owner::*member;
+};
+
+template <typename Owner, typename Member>
+constexpr FieldDescriptor<Owner, Member> Field(const char* name, Member Owner::*member) {
+    return {name, member};
+}
+
+template <typename T, typename = void>
+struct HasStructFields : std::false_type {};
+
+template <typename T>
+struct HasStructFields<T, std::void_t<decltype(StructFields<T>::kFields)>> : std::true_type {};
+
+// Flattened, type-erased description of a bound struct: one row per leaf or
+// group boundary, with byte offsets into the struct. Built once per widget so
+// rendering is a linear walk that needs no templates.
+class StructLayout {
+public:
+    struct Row {
+        enum class Kind { kGroupBegin, kGroupEnd, kBool, kChar, kSigned, kUnsigned, kFloat, kText };
+
+        Kind kind;
+        std::string name;
+        std::size_t offset = 0;
+        std::size_t size = 0;
+        // For kGroupBegin, index of the matching kGroupEnd.
+        std::size_t group_end = 0;
+    };
+
+    StructLayout() = default;
+
+    template <typename T>
+    static StructLayout For(const T& probe) {
+        static_assert(HasStructFields<T>::value, "Specialise debugglass::StructFields for this type");
+        StructLayout layout;
+        layout.AddFields(probe, reinterpret_cast<const unsigned char*>(&probe));
+        return layout;
+    }
+
+    const std::vector<Row>& rows() const noexcept { return rows_; }
+
+    // Draws every row, reading values from `bytes`, a copy of the bound
+    // struct. Groups are tree nodes; rows under closed nodes are skipped.
+    void Render(const unsigned char* bytes) const;
+
+    // Adds one (path, value) row per leaf to a Structure export, with group
+    // names joined under `path`.
+    void Export(ExportTable& table, const std::string& path, const unsigned char* bytes) const;
+
+    // Serialised form carried by kBoundStructure definitions. Decode
+    // rejects layouts that would read outside a struct of `struct_size`
+    // bytes or whose groups do not nest.
+    void Encode(std::string& out) const;
+    static bool Decode(RecordReader& reader, std::size_t struct_size, StructLayout& out);
+
+private:
+    template <typename T>
+    struct IsStdArray : std::false_type {};
+
+    template <typename E, std::size_t N>
+    struct IsStdArray<std::array<E, N>> : std::true_type {};
+
+    template <typename T>
+    void AddFields(const T& object, const unsigned char* base) {
+        std::apply([&](const auto&... fields) { (AddMember(fields.name, object.*(fields.member), base), ...); },
+                   StructFields<T>::kFields);
+    }
+
+    template <typename Member>
+    void AddMember(std::string name, const Member& member, const unsigned char* base) {
+        const auto offset = static_cast<std::size_t>(reinterpret_cast<const unsigned char*>(&member) - base);
+        if constexpr (std::is_enum_v<Member>) {
+            AddScalar<std::underlying_type_t<Member>>(std::move(name), offset);
+        } else if constexpr (std::is_arithmetic_v<Member>) {
+            AddScalar<Member>(std::move(name), offset);
+        } else if constexpr (std::is_array_v<Member> && std::is_same_v<std::remove_extent_t<Member>, char>) {
+            rows_.push_back(Row{Row::Kind::kText, std::move(name), offset, sizeof(Member)});
+        } else if constexpr (std::is_array_v<Member> || IsStdArray<Member>::value) {
+            const std::size_t begin = BeginGroup(std::move(name));
+            for (std::size_t i = 0; i < std::size(member); ++i) {
+                AddMember("[" + std::to_string(i) + "]", member[i], base);
+            }
+            EndGroup(begin);
+        } else if constexpr (HasStructFields<Member>::value) {
+            const std::size_t begin = BeginGroup(std::move(name));
+            AddFields(member, base);
+            EndGroup(begin);
+        } else {
+            static_assert(HasStructFields<Member>::value, "Field type needs a debugglass::StructFields specialisation");
+        }
+    }
+
+    template <typename Scalar>
+    void AddScalar(std::string name, std::size_t offset) {
+        Row::Kind kind;
+        if constexpr (std::is_same_v<Scalar, bool>) {
+            kind = Row::Kind::kBool;
+        } else if constexpr (std::is_same_v<Scalar, char>) {
+            kind = Row::Kind::kChar;
+        } else if constexpr (std::is_floating_point_v<Scalar>) {
+            kind = Row::Kind::kFloat;
+        } else if constexpr (std::is_signed_v<Scalar>) {
+            kind = Row::Kind::kSigned;
+        } else {
+            kind = Row::Kind::kUnsigned;
+        }
+        rows_.push_back(Row{kind, std::move(name), offset, sizeof(Scalar)});
+    }
+
+    std::size_t BeginGroup(std::string name) {
+        rows_.push_back(Row{Row::Kind::kGroupBegin, std::move(name)});
+        return rows_.size() - 1;
+    }
+
+    void EndGroup(std::size_t begin) {
+        rows_.push_back(Row{Row::Kind::kGroupEnd, {}});
+        rows_[begin].group_end = rows_.size() - 1;
+    }
+
+    std::vector<Row> rows_;
+};
+
+// Tree node helpers shared by every BoundStructure instantiation. Begin
+// returns whether the node is open; End is only called when it was.
+bool BeginBoundStructureNode(const void* id, const std::string& label);
+void EndBoundStructureNode();
+
+// Announces a BoundStructure of `struct_size` bytes with `layout` to `sink`.
+void DefineBoundStructure(UpdateSink& sink,
+                          RemoteBinding& binding,
+                          std::uint32_t parent,
+                          const std::string& label,
+                          const StructLayout& layout,
+                          std::size_t struct_size);
+
+// Structure whose rows mirror a whole C++ struct described by StructFields.
+// The producer publishes the struct with one seqlock store; the render
+// thread copies it only while the node is open and walks the precomputed
+// layout.
+template <typename T>
+class BoundStructure : public WindowContent {
+    static_assert(std::is_trivially_copyable_v<T>, "BoundStructure requires a trivially copyable struct");
+
+public:
+    explicit BoundStructure(std::string label, const T& initial = T{})
+        : label_(std::move(label)), published_(initial), snapshot_(initial), layout_(StructLayout::For(snapshot_)) {}
+
+    const std::string& label() const noexcept override { return label_; }
+
+    // Single writer; serialise concurrent publishers externally.
+    void Publish(const T& value) noexcept {
+        if (UpdateSink* sink = remote_.sink()) {
+            SendUpdate(*sink, remote_.id(), RecordType::kBytes, &value, sizeof(T));
+            return;
+        }
+        published_.Store(value);
+        RedrawSignal::Raise();
+    }
+
+    T Load() const noexcept { return published_.Load(); }
+
+    void ExportLeaves(ExportTable& table, const std::string& path) const override {
+        const T current = published_.Load();
+        layout_.Export(table, path, reinterpret_cast<const unsigned char*>(&current));
+    }
+
+    void Render() const override {
+        if (!BeginBoundStructureNode(this, label_)) {
+            return;
+        }
+        published_.Load(snapshot_);
+        layout_.Render(reinterpret_cast<const unsigned char*>(&snapshot_));
+        EndBoundStructureNode();
+    }
+
+    // Structs that do not fit in one record stay local.
+    void MirrorTo(UpdateSink& sink, std::uint32_t parent) override {
+        if constexpr (sizeof(T) <= kMaxRecordPayload) {
+            DefineBoundStructure(sink, remote_, parent, label_, layout_, sizeof(T));
+            const T current = published_.Load();
+            SendUpdate(sink, remote_.id(), RecordType::kBytes, &current, sizeof(T));
+        } else {
+            static_cast<void>(sink);
+            static_cast<void>(parent);
+        }
+    }
+
+private:
+    std::string label_;
+    Seqlock<T> published_;
+    // Render-thread copy of the last published value.
+    mutable T snapshot_;
+    StructLayout layout_;
+};
+
+// Structure drawn from a StructLayout over bytes supplied at runtime; what a
+// viewer builds for a mirrored BoundStructure.
+class LayoutStructure : public WindowContent {
+public:
+    LayoutStructure(std::string label, StructLayout layout, std::size_t size);
+
+    const std::string& label() const noexcept override { return label_; }
+
+    // Ignored unless `size` matches the layout's struct size.
+    void SetBytes(const void* data, std::size_t size);
+
+    void Render() const override;
+    void ExportLeaves(ExportTable& table, const std::string& path) const override;
+
+private:
+    std::string label_;
+    StructLayout layout_;
+    mutable std::mutex mutex_;
+    std::vector<unsigned char> bytes_;
+    // Render-thread copy of bytes_.
+    mutable std::vector<unsigned char> snapshot_;
+};
+
+}  // namespace debugglass
@@ -0,0 +1,119 @@
+#include "debugglass/widgets/export_control.h"
+
+#include <cstdio>
+#include <utility>
+
+#include <imgui.h>
+
+namespace debugglass {
+namespace {
+constexpr auto kOutcomeDisplay = std::chrono::seconds(5);
+constexpr ExportFormat kFileFormats[] = {ExportFormat::kCsv, ExportFormat::kJsonLines, ExportFormat::kColumnar};
+}  // namespace
+
+void ExportControl::MenuItems(const WindowContent& widget, const std::string& name) {
+    const bool busy = progress_ && !progress_->finished();
+    for (const ExportFormat format : kFileFormats) {
+        if (ImGui::MenuItem(ExportFormatName(format), nullptr, false, !busy)) {
+            Start(widget, name, format, false);
+        }
+    }
+    ImGui::Separator();
+    if (ImGui::MenuItem("Copy CSV", nullptr, false, !busy)) {
+        Start(widget, name, ExportFormat::kCsv, true);
+    }
+}
+
+void ExportControl::ContextMenu(const WindowContent& widget, const std::string& name) {
+    ImGui::PushID(this);
+    if (ImGui::BeginPopupContextItem("##export")) {
+        ImGui::TextDisabled("Export");
+        MenuItems(widget, name);
+        ImGui::EndPopup();
+    }
+    ImGui::PopID();
+}
+
+void ExportControl::Start(const WindowContent& widget, const std::string& name, ExportFormat format,
+                          bool to_clipboard) {
+    ExportJob job;
+    job.format = format;
+    if (!to_clipboard) {
+        job.path = Exporter::Instance().PathFor(name, format);
+    }
+    if (auto owner = widget.weak_from_this().lock()) {
+        job.snapshot = [owner](ExportTable& table) { owner->Export(table); };
+    } else {
+        auto table = std::make_shared<ExportTable>();
+        widget.Export(*table);
+        job.snapshot = [table](ExportTable& out) { out = std::move(*table); };
+    }
+    progress_ = Exporter::Instance().Submit(std::move(job));
+    to_clipboard_ = to_clipboard;
+    finished_ = false;
+}
+
+bool ExportControl::HasStatus() {
+    if (!progress_ || !progress_->finished()) {
+        return progress_ != nullptr;
+    }
+    if (!finished_) {
+        finished_ = true;
+        finished_at_ = std::chrono::steady_clock::now();
+        if (to_clipboard_ && progress_->state.load(std::memory_order_acquire) == ExportProgress::State::kDone) {
+            ImGui::SetClipboardText(progress_->text.c_str());
+            progress_->text = std::string();
+        }
+    }
+    if (std::chrono::steady_clock::now() - finished_at_ > kOutcomeDisplay) {
+        progress_.reset();
+    }
+    return progress_ != nullptr;
+}
+
+void ExportControl::RenderStatus() {
+    if (!HasStatus()) {
+        return;
+    }
+    using State = ExportProgress::State;
+    const State state = progress_->state.load(std::memory_order_acquire);
+    if (state < State::kDone) {
+        if (state == State::kWriting) {
+            const auto rows = progress_->rows.load(std::memory_order_relaxed);
+            const auto written = progress_->rows_written.load(std::memory_order_relaxed);
+            char overlay[64];
+            std::snprintf(overlay, sizeof(overlay), "%llu / %llu rows", static_cast<unsigned long long>(written),
+                          static_cast<unsigned long long>(rows));
+            const float fraction = rows == 0 ? 0.0f : static_cast<float>(written) / static_cast<float>(rows);
+            ImGui::ProgressBar(fraction, ImVec2(200.0f, 0.0f), overlay);
+        } else {
+            ImGui::TextDisabled(state == State::kQueued ? "Export queued" : "Taking snapshot...");
+        }
+        ImGui::SameLine();
+        ImGui::PushID(this);
+        if (ImGui::SmallButton("Cancel")) {
+            progress_->cancel.store(true, std::memory_order_relaxed);
+        }
+        ImGui::PopID();
+        return;
+    }
+
+    const auto rows = static_cast<unsigned long long>(progress_->rows.load(std::memory_order_relaxed));
+    switch (state) {
+    case State::kDone:
+        if (to_clipboard_) {
+            ImGui::TextDisabled("Copied %llu rows", rows);
+        } else {
+            ImGui::TextDisabled("Saved %llu rows to %s", rows, progress_->path.c_str());
+        }
+        break;
+    case State::kFailed:
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Export failed: %s", progress_->error.c_str());
+        break;
+    default:
+        ImGui::TextDisabled("Export cancelled");
+        break;
+    }
+}
+
+}  // namespace debugglass
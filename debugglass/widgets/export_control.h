@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "debugglass/util/export.h"
+#include "debugglass/widgets/window_content.h"
+
+namespace debugglass {
+
+// Render-thread side of a widget's exports: menu items that hand a snapshot
+// of the widget to Exporter, and a status line with the progress of the
+// running export. Only touched by the render thread.
+class ExportControl {
+public:
+    // One item per file format plus "Copy CSV". Call inside an open popup
+    // or menu. The widget is read on the export thread when it is owned by
+    // a shared_ptr, and copied here otherwise.
+    void MenuItems(const WindowContent& widget, const std::string& name);
+
+    // Right-click menu on the last drawn item, offering MenuItems.
+    void ContextMenu(const WindowContent& widget, const std::string& name);
+
+    // Whether RenderStatus has anything to draw: an export is running or
+    // finished only a few seconds ago.
+    bool HasStatus();
+
+    // Progress bar and Cancel button while an export runs, then its outcome
+    // for a few seconds. Draws nothing otherwise.
+    void RenderStatus();
+
+private:
+    void Start(const WindowContent& widget, const std::string& name, ExportFormat format, bool to_clipboard);
+
+    std::shared_ptr<ExportProgress> progress_;
+    bool to_clipboard_ = false;
+    // Whether the finished export has been handled, and when.
+    bool finished_ = false;
+    std::chrono::steady_clock::time_point finished_at_;
+};
+
+}  // namespace debugglass
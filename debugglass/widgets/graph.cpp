@@ -5,66 +5,107 @@
 
 #include <imgui.h>
 
+#include "debugglass/util/redraw_signal.h"
+
 namespace debugglass {
 
-Graph::Graph(std::string label, std::size_t capacity)
-    : label_(std::move(label)), capacity_(std::max<std::size_t>(2, capacity)) {
-    samples_.reserve(capacity_);
-}
+Graph::Graph(std::string label, std::size_t capacity, GraphProducerMode producers)
+    : label_(std::move(label)),
+      producers_(producers),
+      ring_(std::max<std::size_t>(2, capacity)) {}
 
 void Graph::AddValue(float value) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (samples_.size() < capacity_) {
-        samples_.push_back(value);
-        if (samples_.size() == capacity_) {
-            filled_ = true;
-            next_index_ = 0;
-        }
+    AddValueNoRedraw(value);
+    if (remote_.sink() == nullptr) {
+        RedrawSignal::Raise();
+    }
+}
+
+void Graph::AddValueNoRedraw(float value) {
+    if (UpdateSink* sink = remote_.sink()) {
+        SendUpdate(*sink, remote_.id(), RecordType::kGraphValues, &value, sizeof(value));
+        return;
+    }
+    if (producers_ == GraphProducerMode::kSingleProducer) {
+        ring_.Push(value);
+    } else {
+        ring_.PushConcurrent(value);
+    }
+}
+
+void Graph::AddValues(const float* values, std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (UpdateSink* sink = remote_.sink()) {
+        SendGraphValues(*sink, remote_.id(), values, count);
+        return;
+    }
+    if (producers_ == GraphProducerMode::kSingleProducer) {
+        ring_.PushBatch(values, count);
     } else {
-        samples_[next_index_] = value;
-        next_index_ = (next_index_ + 1) % capacity_;
-        filled_ = true;
+        ring_.PushBatchConcurrent(values, count);
     }
+    RedrawSignal::Raise();
 }
 
 void Graph::SetRange(float min_value, float max_value) {
     if (min_value > max_value) {
         std::swap(min_value, max_value);
     }
-    std::lock_guard<std::mutex> lock(mutex_);
-    min_value_ = min_value;
-    max_value_ = max_value;
-}
-
-void Graph::Render() const {
-    const auto samples = CollectSamplesCopy();
-    if (samples.empty()) {
-        ImGui::TextUnformatted("No samples yet");
+    min_value_.store(min_value, std::memory_order_relaxed);
+    max_value_.store(max_value, std::memory_order_relaxed);
+    if (UpdateSink* sink = remote_.sink()) {
+        const GraphRange range{min_value, max_value};
+        SendUpdate(*sink, remote_.id(), RecordType::kGraphRange, &range, sizeof(range));
         return;
     }
+    RedrawSignal::Raise();
+}
 
-    ImGui::PlotLines(label_.c_str(), samples.data(), static_cast<int>(samples.size()), 0, nullptr, min_value_, max_value_, ImVec2(0.0f, 120.0f));
+void Graph::MirrorTo(UpdateSink& sink, std::uint32_t parent) {
+    GraphParams params;
+    params.capacity = ring_.capacity();
+    params.producers = static_cast<std::uint32_t>(producers_);
+    DefineNode(sink, remote_, RecordType::kGraph, parent, label_, &params, sizeof(params));
+    const GraphRange range{min_value_.load(std::memory_order_relaxed), max_value_.load(std::memory_order_relaxed)};
+    SendUpdate(sink, remote_.id(), RecordType::kGraphRange, &range, sizeof(range));
 }
 
-std::vector<float> Graph::CollectSamplesCopy() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (samples_.empty()) {
-        return {};
-    }
+std::vector<float> Graph::Snapshot() const {
+    std::vector<float> samples(ring_.capacity());
+    samples.resize(ring_.CopyOrdered(samples.data()));
+    return samples;
+}
 
-    if (!filled_) {
-        return samples_;
+bool Graph::Export(ExportTable& table) const {
+    const std::vector<float> samples = Snapshot();
+    table.SetColumns({"sample", "value"});
+    table.Reserve(samples.size());
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        table.AddUnsigned(i);
+        table.AddFloat(samples[i]);
     }
+    return true;
+}
 
-    std::vector<float> ordered(capacity_);
-    std::size_t idx = 0;
-    for (std::size_t i = next_index_; i < capacity_; ++i) {
-        ordered[idx++] = samples_[i];
+void Graph::Render() const {
+    if (plot_buffer_.size() < ring_.capacity()) {
+        plot_buffer_.resize(ring_.capacity());
+        render_allocations_.fetch_add(1, std::memory_order_relaxed);
     }
-    for (std::size_t i = 0; i < next_index_; ++i) {
-        ordered[idx++] = samples_[i];
+
+    const std::size_t count = ring_.CopyOrdered(plot_buffer_.data());
+    if (count == 0) {
+        ImGui::TextUnformatted("No samples yet");
+        return;
     }
-    return ordered;
+
+    ImGui::PlotLines(label_.c_str(), plot_buffer_.data(), static_cast<int>(count), 0, nullptr,
+                     min_value_.load(std::memory_order_relaxed), max_value_.load(std::memory_order_relaxed),
+                     ImVec2(0.0f, 120.0f));
+    export_.ContextMenu(*this, label_);
+    export_.RenderStatus();
 }
 
 }  // namespace debugglass
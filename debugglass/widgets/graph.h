@@ -1,35 +1,67 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
-#include <mutex>
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "debugglass/util/sample_ring.h"
+#include "debugglass/widgets/export_control.h"
 #include "debugglass/widgets/window_content.h"
 
 namespace debugglass {
 
+enum class GraphProducerMode {
+    kMultiProducer,
+    kSingleProducer,
+};
+
 class Graph : public WindowContent {
 public:
-    Graph(std::string label, std::size_t capacity = 256);
+    static constexpr std::size_t kDefaultCapacity = 256;
+
+    // AddValue never blocks. kSingleProducer skips the atomic read-modify-write
+    // but requires every AddValue call to come from the same thread.
+    Graph(std::string label,
+          std::size_t capacity = kDefaultCapacity,
+          GraphProducerMode producers = GraphProducerMode::kMultiProducer);
 
     void AddValue(float value);
+    // AddValue without requesting a redraw, for samples taken on the render
+    // thread while a frame is already being drawn.
+    void AddValueNoRedraw(float value);
+    // Appends a block of samples in order, as one write to the ring.
+    void AddValues(const float* values, std::size_t count);
+    void AddValues(const std::vector<float>& values) { AddValues(values.data(), values.size()); }
     void SetRange(float min_value, float max_value);
-    const std::string& label() const noexcept { return label_; }
+    const std::string& label() const noexcept override { return label_; }
+
+    // Copy of the retained samples, oldest first.
+    std::vector<float> Snapshot() const;
+
+    // Number of times Render had to grow its plot buffer. Stays at one per
+    // graph once the first frame has been drawn.
+    std::uint64_t render_allocations() const noexcept {
+        return render_allocations_.load(std::memory_order_relaxed);
+    }
 
     void Render() const override;
+    // The retained samples, oldest first.
+    bool Export(ExportTable& table) const override;
+    void MirrorTo(UpdateSink& sink, std::uint32_t parent) override;
 
 private:
-    std::vector<float> CollectSamplesCopy() const;
-
     std::string label_;
-    std::size_t capacity_;
-    mutable std::mutex mutex_;
-    std::vector<float> samples_;
-    std::size_t next_index_ = 0;
-    bool filled_ = false;
-    float min_value_ = 0.0f;
-    float max_value_ = 1.0f;
+    GraphProducerMode producers_;
+    SampleRing ring_;
+    std::atomic<float> min_value_{0.0f};
+    std::atomic<float> max_value_{1.0f};
+
+    // Only touched by the render thread.
+    mutable std::vector<float> plot_buffer_;
+    mutable std::atomic<std::uint64_t> render_allocations_{0};
+    mutable ExportControl export_;
 };
 
 }  // namespace debugglass
@@ -0,0 +1,274 @@
+#include "debugglass/widgets/history_graph.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <imgui.h>
+
+#include "debugglass/util/profiler.h"
+#include "debugglass/util/redraw_signal.h"
+
+namespace debugglass {
+namespace {
+constexpr float kPlotHeight = 120.0f;
+constexpr std::size_t kMinViewSpan = 16;
+
+std::size_t RoundUpToPowerOfTwo(std::size_t value) {
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+}  // namespace
+
+HistoryGraph::HistoryGraph(std::string label, std::size_t history)
+    : label_(std::move(label)),
+      history_(RoundUpToPowerOfTwo(std::max<std::size_t>(kMinViewSpan, history))),
+      mask_(history_ - 1),
+      raw_(history_) {
+    for (std::size_t blocks = history_ >> 1; blocks > 0; blocks >>= 1) {
+        Level level;
+        level.min.resize(blocks);
+        level.max.resize(blocks);
+        levels_.push_back(std::move(level));
+    }
+}
+
+void HistoryGraph::AddValue(float value) {
+    if (UpdateSink* sink = remote_.sink()) {
+        SendUpdate(*sink, remote_.id(), RecordType::kGraphValues, &value, sizeof(value));
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::uint64_t index = count_++;
+    raw_[static_cast<std::size_t>(index & mask_)] = value;
+    UpdateLevelsLocked(index, value);
+    RedrawSignal::Raise();
+}
+
+void HistoryGraph::AddValues(const float* values, std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (UpdateSink* sink = remote_.sink()) {
+        SendGraphValues(*sink, remote_.id(), values, count);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Samples older than the retained history cannot be seen again, so an
+    // oversized block only contributes its tail.
+    const std::size_t skipped = count > history_ ? count - history_ : 0;
+    const std::uint64_t first = count_ + skipped;
+    const std::size_t kept = count - skipped;
+    const float* tail = values + skipped;
+
+    // The raw ring takes at most two contiguous copies.
+    const std::size_t offset = static_cast<std::size_t>(first & mask_);
+    const std::size_t head_part = std::min(kept, history_ - offset);
+    std::copy_n(tail, head_part, raw_.data() + offset);
+    std::copy_n(tail + head_part, kept - head_part, raw_.data());
+
+    // The pyramid walk restarts from a history-aligned index, which opens a
+    // block at every level, so no block mixes skipped and kept samples.
+    const std::uint64_t begin = std::max<std::uint64_t>(count_, first & ~mask_);
+    for (std::uint64_t index = begin; index < count_ + count; ++index) {
+        UpdateLevelsLocked(index, values[index - count_]);
+    }
+    count_ += count;
+    RedrawSignal::Raise();
+}
+
+void HistoryGraph::UpdateLevelsLocked(std::uint64_t index, float value) {
+    // A block only starts when every finer block starts too, so once a level
+    // neither starts a block nor widens its envelope no coarser level can
+    // change either. Samples inside the envelope stop after a level or two,
+    // but monotonic input widens every level and costs O(log history).
+    for (std::size_t k = 1; k <= levels_.size(); ++k) {
+        Level& level = levels_[k - 1];
+        const std::size_t slot = static_cast<std::size_t>((index >> k) & (level.min.size() - 1));
+        const bool block_start = (index & ((std::uint64_t{1} << k) - 1)) == 0;
+        if (block_start) {
+            level.min[slot] = value;
+            level.max[slot] = value;
+        } else if (value < level.min[slot]) {
+            level.min[slot] = value;
+        } else if (value > level.max[slot]) {
+            level.max[slot] = value;
+        } else {
+            break;
+        }
+    }
+}
+
+void HistoryGraph::SetRange(float min_value, float max_value) {
+    if (min_value > max_value) {
+        std::swap(min_value, max_value);
+    }
+    min_value_.store(min_value, std::memory_order_relaxed);
+    max_value_.store(max_value, std::memory_order_relaxed);
+    if (UpdateSink* sink = remote_.sink()) {
+        const GraphRange range{min_value, max_value};
+        SendUpdate(*sink, remote_.id(), RecordType::kGraphRange, &range, sizeof(range));
+        return;
+    }
+    RedrawSignal::Raise();
+}
+
+void HistoryGraph::MirrorTo(UpdateSink& sink, std::uint32_t parent) {
+    HistoryGraphParams params;
+    params.history = history_;
+    DefineNode(sink, remote_, RecordType::kHistoryGraph, parent, label_, &params, sizeof(params));
+    const GraphRange range{min_value_.load(std::memory_order_relaxed), max_value_.load(std::memory_order_relaxed)};
+    SendUpdate(sink, remote_.id(), RecordType::kGraphRange, &range, sizeof(range));
+}
+
+std::uint64_t HistoryGraph::total_samples() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
+
+std::vector<float> HistoryGraph::Snapshot() const {
+    // Sized outside the lock so producers do not wait on the allocation.
+    std::vector<float> samples(history_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    CopyRetainedLocked(samples);
+    return samples;
+}
+
+bool HistoryGraph::Export(ExportTable& table) const {
+    std::vector<float> samples(history_);
+    std::uint64_t first = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CopyRetainedLocked(samples);
+        first = count_ - samples.size();
+    }
+    table.SetColumns({"sample", "value"});
+    table.Reserve(samples.size());
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        table.AddUnsigned(first + i);
+        table.AddFloat(samples[i]);
+    }
+    return true;
+}
+
+void HistoryGraph::CopyRetainedLocked(std::vector<float>& out) const {
+    const std::size_t kept = static_cast<std::size_t>(std::min<std::uint64_t>(count_, history_));
+    out.resize(kept);
+    const std::size_t offset = static_cast<std::size_t>((count_ - kept) & mask_);
+    const std::size_t head_part = std::min(kept, history_ - offset);
+    std::copy_n(raw_.data() + offset, head_part, out.data());
+    std::copy_n(raw_.data(), kept - head_part, out.data() + head_part);
+}
+
+std::size_t HistoryGraph::BuildPlotLocked(std::uint64_t first, std::uint64_t last, std::size_t columns) const {
+    const std::uint64_t span = last - first;
+    if (span <= columns) {
+        for (std::uint64_t index = first; index < last; ++index) {
+            plot_buffer_[static_cast<std::size_t>(index - first)] = raw_[static_cast<std::size_t>(index & mask_)];
+        }
+        return static_cast<std::size_t>(span);
+    }
+
+    // Coarsest level whose blocks still fit inside one column.
+    std::size_t k = 0;
+    while (k < levels_.size() && (std::uint64_t{2} << k) <= span / columns) {
+        ++k;
+    }
+
+    // The oldest block at level k may share its slot with the block being
+    // filled right now, so the envelope starts at the next one.
+    const std::uint64_t newest_block = (count_ - 1) >> k;
+    const std::uint64_t blocks_kept = k == 0 ? history_ : levels_[k - 1].min.size();
+    const std::uint64_t oldest_block = newest_block >= blocks_kept ? newest_block - blocks_kept + 1 : 0;
+
+    std::size_t points = 0;
+    for (std::size_t column = 0; column < columns; ++column) {
+        const std::uint64_t column_first = first + span * column / columns;
+        const std::uint64_t column_last = first + span * (column + 1) / columns;
+        std::uint64_t block = std::max(column_first >> k, oldest_block);
+        const std::uint64_t block_end = std::max(block + 1, ((column_last - 1) >> k) + 1);
+
+        float low = 0.0f;
+        float high = 0.0f;
+        bool any = false;
+        for (; block < block_end && block <= newest_block; ++block) {
+            float block_low;
+            float block_high;
+            if (k == 0) {
+                block_low = block_high = raw_[static_cast<std::size_t>(block & mask_)];
+            } else {
+                const Level& level = levels_[k - 1];
+                const std::size_t slot = static_cast<std::size_t>(block & (level.min.size() - 1));
+                block_low = level.min[slot];
+                block_high = level.max[slot];
+            }
+            low = any ? std::min(low, block_low) : block_low;
+            high = any ? std::max(high, block_high) : block_high;
+            any = true;
+        }
+        if (any) {
+            plot_buffer_[points++] = low;
+            plot_buffer_[points++] = high;
+        }
+    }
+    return points;
+}
+
+void HistoryGraph::Render() const {
+    const float width = std::max(1.0f, ImGui::GetContentRegionAvail().x);
+    const std::size_t columns = static_cast<std::size_t>(width);
+    if (plot_buffer_.size() < columns * 2) {
+        plot_buffer_.resize(columns * 2);
+    }
+
+    ImGui::PushID(this);
+    std::size_t points = 0;
+    std::uint64_t retained = 0;
+    {
+        DEBUGGLASS_PROFILED_LOCK(lock, mutex_);
+        retained = std::min<std::uint64_t>(count_, history_ - (history_ >> 2));
+        if (retained > 0) {
+            const float max_span = static_cast<float>(retained);
+            if (view_span_ <= 0.0f || view_span_ > max_span) {
+                view_span_ = max_span;
+            }
+            if (follow_) {
+                view_offset_ = 0.0f;
+            }
+            view_offset_ = std::clamp(view_offset_, 0.0f, max_span - view_span_);
+
+            const std::uint64_t last = count_ - static_cast<std::uint64_t>(view_offset_);
+            const std::uint64_t span = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(view_span_));
+            points = BuildPlotLocked(last - std::min(span, last), last, columns);
+        }
+    }
+
+    if (points == 0) {
+        ImGui::TextUnformatted("No samples yet");
+        ImGui::PopID();
+        return;
+    }
+
+    ImGui::PlotLines(label_.c_str(), plot_buffer_.data(), static_cast<int>(points), 0, nullptr,
+                     min_value_.load(std::memory_order_relaxed), max_value_.load(std::memory_order_relaxed),
+                     ImVec2(0.0f, kPlotHeight));
+    export_.ContextMenu(*this, label_);
+
+    const float max_span = static_cast<float>(retained);
+    const float min_span = std::min(max_span, static_cast<float>(kMinViewSpan));
+    ImGui::SetNextItemWidth(width * 0.4f);
+    ImGui::SliderFloat("Window", &view_span_, min_span, max_span, "%.0f samples", ImGuiSliderFlags_Logarithmic);
+    ImGui::SameLine();
+    ImGui::Checkbox("Follow", &follow_);
+    if (!follow_) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(width * 0.3f);
+        ImGui::SliderFloat("Back", &view_offset_, 0.0f, std::max(0.0f, max_span - view_span_), "%.0f samples");
+    }
+    export_.RenderStatus();
+    ImGui::PopID();
+}
+
+}  // namespace debugglass
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "debugglass/widgets/export_control.h"
+#include "debugglass/widgets/window_content.h"
+
+namespace debugglass {
+
+// Graph for long histories. Samples are kept in a raw ring plus a min/max
+// pyramid (level k summarises blocks of 2^k samples) that AddValue updates
+// incrementally, so a frame only reads as many points as the plot has pixel
+// columns no matter how much history is retained.
+class HistoryGraph : public WindowContent {
+public:
+    static constexpr std::size_t kDefaultHistory = std::size_t{1} << 20;
+
+    // `history` is rounded up to a power of two.
+    HistoryGraph(std::string label, std::size_t history = kDefaultHistory);
+
+    void AddValue(float value);
+    // Appends a block of samples under a single lock.
+    void AddValues(const float* values, std::size_t count);
+    void AddValues(const std::vector<float>& values) { AddValues(values.data(), values.size()); }
+    void SetRange(float min_value, float max_value);
+    const std::string& label() const noexcept override { return label_; }
+
+    std::size_t history() const noexcept { return history_; }
+    std::uint64_t total_samples() const;
+
+    // Copy of the retained raw samples, oldest first.
+    std::vector<float> Snapshot() const;
+
+    void Render() const override;
+    // The retained raw samples, numbered from the first sample ever added.
+    bool Export(ExportTable& table) const override;
+    void MirrorTo(UpdateSink& sink, std::uint32_t parent) override;
+
+private:
+    struct Level {
+        std::vector<float> min;
+        std::vector<float> max;
+    };
+
+    // Writes the plot points for samples [first, last) into plot_buffer_ and
+    // returns how many there are: raw samples when they fit in `columns`,
+    // otherwise one min/max pair per column. Requires mutex_.
+    std::size_t BuildPlotLocked(std::uint64_t first, std::uint64_t last, std::size_t columns) const;
+
+    // Copies the raw samples still in the ring, oldest first. Requires mutex_.
+    void CopyRetainedLocked(std::vector<float>& out) const;
+
+    // Folds the sample at `index` into the min/max pyramid. Requires mutex_.
+    void UpdateLevelsLocked(std::uint64_t index, float value);
+
+    std::string label_;
+    std::size_t history_;
+    std::uint64_t mask_;
+
+    mutable std::mutex mutex_;
+    std::vector<float> raw_;
+    std::vector<Level> levels_;  // levels_[k - 1] holds level k.
+    std::uint64_t count_ = 0;
+
+    std::atomic<float> min_value_{0.0f};
+    std::atomic<float> max_value_{1.0f};
+
+    // View state and scratch space, only touched by the render thread.
+    mutable std::vector<float> plot_buffer_;
+    mutable float view_span_ = 0.0f;
+    mutable float view_offset_ = 0.0f;
+    mutable bool follow_ = true;
+    mutable ExportControl export_;
+};
+
+}  // namespace debugglass
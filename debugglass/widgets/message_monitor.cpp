@@ -2,16 +2,43 @@
 
 #include <imgui.h>
 
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
 #include <ctime>
-#include <iomanip>
-#include <sstream>
+#include <functional>
+#include <string_view>
 #include <utility>
+#include <variant>
+
+#include "debugglass/util/export.h"
+#include "debugglass/util/profiler.h"
+#include "debugglass/util/redraw_signal.h"
+#include "debugglass/util/value_format.h"
 
 namespace debugglass {
 namespace {
 constexpr float kHighlightWindowSeconds = 0.5f;
+constexpr auto kResortInterval = std::chrono::milliseconds(250);
+
+enum Column : int {
+    kColumnId,
+    kColumnValue,
+    kColumnUpdates,
+    kColumnRate,
+    kColumnMean,
+    kColumnMin,
+    kColumnMax,
+    kColumnJitter,
+    kColumnTimestamp,
+    kColumnCount,
+};
+
+using TimestampBuffer = std::array<char, 16>;
 
-std::string FormatTimestamp(std::chrono::system_clock::time_point timestamp) {
+std::string_view FormatTimestamp(std::chrono::system_clock::time_point timestamp, TimestampBuffer& buffer) {
     const auto seconds = std::chrono::time_point_cast<std::chrono::seconds>(timestamp);
     const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(timestamp - seconds).count();
     std::time_t tt = std::chrono::system_clock::to_time_t(timestamp);
@@ -21,119 +48,818 @@ std::string FormatTimestamp(std::chrono::system_clock::time_point timestamp) {
 #else
     localtime_r(&tt, &tm_snapshot);
 #endif
-    std::ostringstream stream;
-    stream << std::put_time(&tm_snapshot, "%H:%M:%S") << '.' << std::setw(3) << std::setfill('0') << ms;
-    return stream.str();
+    const std::size_t length = std::strftime(buffer.data(), buffer.size(), "%H:%M:%S", &tm_snapshot);
+    const int suffix = std::snprintf(buffer.data() + length, buffer.size() - length, ".%03d", static_cast<int>(ms));
+    return std::string_view(buffer.data(), length + static_cast<std::size_t>(std::max(suffix, 0)));
+}
+
+std::chrono::system_clock::time_point ToSystemTime(std::chrono::steady_clock::time_point timestamp,
+                                                   std::chrono::steady_clock::time_point steady_now,
+                                                   std::chrono::system_clock::time_point system_now) {
+    return system_now - std::chrono::duration_cast<std::chrono::system_clock::duration>(steady_now - timestamp);
+}
+
+// Smoothed rate, decayed once the ID has been silent for longer than its
+// typical interval.
+template <typename Stats>
+double CurrentRate(const Stats& stats, float age_seconds) {
+    const double interval = std::max<double>(stats.ewma_interval, age_seconds);
+    return interval > 0.0 ? 1.0 / interval : 0.0;
+}
+
+template <typename Stats>
+void RenderHistogramTooltip(const Stats& stats) {
+    std::array<float, Stats::kHistogramBuckets> counts;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        counts[i] = static_cast<float>(stats.histogram[i]);
+    }
+    ImGui::BeginTooltip();
+    ImGui::Text("Interval histogram (%llu samples)", static_cast<unsigned long long>(stats.intervals));
+    ImGui::PlotHistogram("##intervals", counts.data(), static_cast<int>(counts.size()), 0, nullptr, 0.0f, FLT_MAX,
+                         ImVec2(240.0f, 80.0f));
+    ImGui::TextDisabled("log2 buckets: 1us ... 8s");
+    ImGui::EndTooltip();
+}
+
+template <typename Value>
+std::string_view FormatValue(const Value& value, NumberBuffer& buffer) {
+    if (const auto* text = std::get_if<std::string>(&value)) {
+        return *text;
+    }
+    if (const auto* number = std::get_if<std::int64_t>(&value)) {
+        return FormatSigned(*number, buffer);
+    }
+    if (const auto* number = std::get_if<std::uint64_t>(&value)) {
+        return FormatUnsigned(*number, buffer);
+    }
+    return FormatFixed(std::get<double>(value), 3, buffer);
 }
 }
 
-MessageMonitor::MessageMonitor(std::string label) : label_(std::move(label)) {}
+MessageMonitor::MessageMonitor(std::string label, MessageMonitorOptions options)
+    : label_(std::move(label)),
+      shard_count_(std::max<std::size_t>(1, options.shards)),
+      ttl_(options.ttl),
+      max_entries_per_shard_(options.max_entries == 0 ? 0 : (options.max_entries + shard_count_ - 1) / shard_count_),
+      shards_(std::make_unique<Shard[]>(shard_count_)) {}
+
+std::size_t MessageMonitor::ShardFor(const std::string& id) const {
+    if (shard_count_ == 1) {
+        return 0;
+    }
+    // Remix so the shard does not correlate with the map's bucket index.
+    const std::uint64_t hash = static_cast<std::uint64_t>(std::hash<std::string>{}(id)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>((hash >> 32) % shard_count_);
+}
+
+void MessageMonitor::BucketByShard(const std::uint32_t* shard_of,
+                                   std::size_t count,
+                                   std::vector<std::uint32_t>& order,
+                                   std::vector<std::size_t>& offsets) const {
+    // Counting sort: offsets[s + 1] first counts shard s, then the prefix
+    // sums turn the counts into bucket bounds.
+    offsets.assign(shard_count_ + 1, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (shard_of[i] < shard_count_) {
+            ++offsets[shard_of[i] + 1];
+        }
+    }
+    for (std::size_t s = 0; s < shard_count_; ++s) {
+        offsets[s + 1] += offsets[s];
+    }
+    order.resize(offsets[shard_count_]);
+    // Each bucket is filled from its start; `offsets[s]` is advanced while
+    // filling and restored afterwards.
+    for (std::size_t i = 0; i < count; ++i) {
+        if (shard_of[i] < shard_count_) {
+            order[offsets[shard_of[i]]++] = static_cast<std::uint32_t>(i);
+        }
+    }
+    for (std::size_t s = shard_count_; s > 0; --s) {
+        offsets[s] = offsets[s - 1];
+    }
+    offsets[0] = 0;
+}
 
 void MessageMonitor::UpsertMessage(std::string id, std::string value) {
-    auto now = std::chrono::system_clock::now();
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto found = index_by_id_.find(id);
-    if (found == index_by_id_.end()) {
-        Entry entry;
-        entry.id = std::move(id);
-        entry.value = std::move(value);
-        entry.update_count = 1;
-        entry.timestamp = now;
-        entries_.push_back(std::move(entry));
-        index_by_id_[entries_.back().id] = entries_.size() - 1;
+    UpsertValue(std::move(id), Value{std::move(value)});
+}
+
+MessageMonitor::Handle MessageMonitor::RegisterId(std::string id) {
+    const auto now = std::chrono::steady_clock::now();
+    const std::size_t shard_index = ShardFor(id);
+    Shard& shard = shards_[shard_index];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ExpireLocked(shard, now);
+    std::uint32_t slot;
+    if (auto found = shard.slot_by_id.find(id); found != shard.slot_by_id.end()) {
+        slot = found->second;
     } else {
-        Entry& entry = entries_[found->second];
-        entry.value = std::move(value);
-        entry.update_count += 1;
-        entry.timestamp = now;
+        slot = InsertLocked(shard, std::move(id), now);
+        if (UpdateSink* sink = remote_.sink()) {
+            SendRegistration(*sink, static_cast<std::uint32_t>(shard_index), slot, shard.slots[slot].generation,
+                             shard.entries[shard.slots[slot].row].id);
+        }
+        RedrawSignal::Raise();
     }
+    return Handle{slot, static_cast<std::uint32_t>(shard_index), shard.slots[slot].generation};
 }
 
-void MessageMonitor::Render() const {
-    struct Snapshot {
-        std::string id;
-        std::string value;
-        uint64_t update_count;
-        std::chrono::system_clock::time_point timestamp;
-    };
+bool MessageMonitor::Upsert(Handle handle, std::string value) {
+    return UpsertValue(handle, Value{std::move(value)});
+}
+
+void MessageMonitor::UpsertValue(std::string id, Value value) {
+    if (UpdateSink* sink = remote_.sink()) {
+        const auto id_size = static_cast<std::uint32_t>(id.size());
+        const PayloadPart prefix[] = {{&id_size, sizeof(id_size)}, {id.data(), id.size()}};
+        SendValue(*sink, remote_.id(), RecordType::kMessageUpsert, prefix, 2, value);
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    Shard& shard = shards_[ShardFor(id)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ExpireLocked(shard, now);
+    UpsertLocked(shard, id, std::move(value), now);
+    RedrawSignal::Raise();
+}
+
+bool MessageMonitor::UpsertValue(Handle handle, Value value) {
+    if (handle.shard >= shard_count_) {
+        return false;
+    }
+    if (UpdateSink* sink = remote_.sink()) {
+        if ((ttl_ != std::chrono::steady_clock::duration::zero() || max_entries_per_shard_ != 0) &&
+            !TouchLocal(handle)) {
+            return false;
+        }
+        const MessageKey key{(std::uint64_t{handle.shard} << 32) | handle.index, handle.generation};
+        const PayloadPart prefix{&key, sizeof(key)};
+        SendValue(*sink, remote_.id(), RecordType::kMessageHandleUpsert, &prefix, 1, value);
+        return true;
+    }
+    auto now = std::chrono::steady_clock::now();
+    Shard& shard = shards_[handle.shard];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ExpireLocked(shard, now);
+    if (!UpsertLocked(shard, handle, std::move(value), now)) {
+        return false;
+    }
+    RedrawSignal::Raise();
+    return true;
+}
+
+bool MessageMonitor::TouchLocal(Handle handle) {
+    const auto now = std::chrono::steady_clock::now();
+    Shard& shard = shards_[handle.shard];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ExpireLocked(shard, now);
+    if (handle.index >= shard.slots.size()) {
+        return false;
+    }
+    const Slot& slot = shard.slots[handle.index];
+    if (slot.generation != handle.generation || slot.row == Handle::kInvalidIndex) {
+        return false;
+    }
+    TouchLocked(shard, handle.index);
+    shard.entries[slot.row].timestamp = now;
+    return true;
+}
+
+void MessageMonitor::UpsertLocked(Shard& shard, const std::string& id, Value&& value,
+                                  std::chrono::steady_clock::time_point now) const {
+    std::uint32_t slot;
+    if (auto found = shard.slot_by_id.find(id); found != shard.slot_by_id.end()) {
+        slot = found->second;
+        TouchLocked(shard, slot);
+    } else {
+        slot = InsertLocked(shard, id, now);
+    }
+    UpdateEntry(shard.entries[shard.slots[slot].row], std::move(value), now);
+}
+
+bool MessageMonitor::UpsertLocked(Shard& shard, Handle handle, Value&& value,
+                                  std::chrono::steady_clock::time_point now) {
+    if (handle.index >= shard.slots.size()) {
+        return false;
+    }
+    const Slot& slot = shard.slots[handle.index];
+    if (slot.generation != handle.generation || slot.row == Handle::kInvalidIndex) {
+        return false;
+    }
+    TouchLocked(shard, handle.index);
+    UpdateEntry(shard.entries[slot.row], std::move(value), now);
+    return true;
+}
+
+bool MessageMonitor::RemoveMessage(const std::string& id) {
+    Shard& shard = shards_[ShardFor(id)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (UpdateSink* sink = remote_.sink()) {
+        // Unregistered IDs only exist on the viewer side.
+        SendReliable(*sink, remote_.id(), RecordType::kMessageRemove, id.data(), id.size());
+    }
+    auto found = shard.slot_by_id.find(id);
+    if (found == shard.slot_by_id.end()) {
+        return remote_.sink() != nullptr;
+    }
+    RemoveLocked(shard, found->second);
+    RedrawSignal::Raise();
+    return true;
+}
+
+bool MessageMonitor::Remove(Handle handle) {
+    if (handle.shard >= shard_count_) {
+        return false;
+    }
+    Shard& shard = shards_[handle.shard];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (handle.index >= shard.slots.size()) {
+        return false;
+    }
+    const Slot& slot = shard.slots[handle.index];
+    if (slot.generation != handle.generation || slot.row == Handle::kInvalidIndex) {
+        return false;
+    }
+    if (UpdateSink* sink = remote_.sink()) {
+        SendHandleRemove(*sink, handle);
+    }
+    RemoveLocked(shard, handle.index);
+    RedrawSignal::Raise();
+    return true;
+}
+
+void MessageMonitor::Clear() {
+    if (UpdateSink* sink = remote_.sink()) {
+        SendReliable(*sink, remote_.id(), RecordType::kMessageClear, nullptr, 0);
+    }
+    for (std::size_t s = 0; s < shard_count_; ++s) {
+        Shard& shard = shards_[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        while (shard.oldest != Handle::kInvalidIndex) {
+            RemoveLocked(shard, shard.oldest);
+        }
+    }
+    RedrawSignal::Raise();
+}
+
+std::size_t MessageMonitor::size() const {
+    std::size_t total = 0;
+    for (std::size_t s = 0; s < shard_count_; ++s) {
+        std::lock_guard<std::mutex> lock(shards_[s].mutex);
+        total += shards_[s].entries.size();
+    }
+    return total;
+}
+
+std::uint64_t MessageMonitor::evicted() const {
+    std::uint64_t total = 0;
+    for (std::size_t s = 0; s < shard_count_; ++s) {
+        std::lock_guard<std::mutex> lock(shards_[s].mutex);
+        total += shards_[s].evicted;
+    }
+    return total;
+}
+
+std::uint32_t MessageMonitor::InsertLocked(Shard& shard, std::string id,
+                                           std::chrono::steady_clock::time_point now) const {
+    if (max_entries_per_shard_ != 0 && shard.entries.size() >= max_entries_per_shard_) {
+        EvictLocked(shard);
+    }
+
+    std::uint32_t slot;
+    if (shard.free_slots.empty()) {
+        slot = static_cast<std::uint32_t>(shard.slots.size());
+        shard.slots.emplace_back();
+    } else {
+        slot = shard.free_slots.back();
+        shard.free_slots.pop_back();
+    }
+
+    Entry entry;
+    entry.id = std::move(id);
+    entry.timestamp = now;
+    entry.slot = slot;
+    shard.entries.push_back(std::move(entry));
+    shard.slots[slot].row = static_cast<std::uint32_t>(shard.entries.size() - 1);
+    shard.slot_by_id.emplace(shard.entries.back().id, slot);
+
+    shard.slots[slot].older = shard.newest;
+    shard.slots[slot].newer = Handle::kInvalidIndex;
+    if (shard.newest != Handle::kInvalidIndex) {
+        shard.slots[shard.newest].newer = slot;
+    } else {
+        shard.oldest = slot;
+    }
+    shard.newest = slot;
+    ++shard.layout_version;
+    return slot;
+}
 
-    std::vector<Snapshot> snapshot;
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        snapshot.reserve(entries_.size());
-        for (const auto& entry : entries_) {
-            Snapshot snapshot_entry;
-            snapshot_entry.id = entry.id;
-            snapshot_entry.value = entry.value;
-            snapshot_entry.update_count = entry.update_count;
-            snapshot_entry.timestamp = entry.timestamp;
-            snapshot.push_back(std::move(snapshot_entry));
+void MessageMonitor::RemoveLocked(Shard& shard, std::uint32_t slot) {
+    UnlinkLocked(shard, slot);
+    Slot& removed = shard.slots[slot];
+    const std::uint32_t row = removed.row;
+    shard.slot_by_id.erase(shard.entries[row].id);
+    if (row + 1 != shard.entries.size()) {
+        shard.entries[row] = std::move(shard.entries.back());
+        shard.slots[shard.entries[row].slot].row = row;
+    }
+    shard.entries.pop_back();
+
+    removed.row = Handle::kInvalidIndex;
+    ++removed.generation;
+    shard.free_slots.push_back(slot);
+    ++shard.layout_version;
+}
+
+void MessageMonitor::UnlinkLocked(Shard& shard, std::uint32_t slot) {
+    Slot& node = shard.slots[slot];
+    if (node.older != Handle::kInvalidIndex) {
+        shard.slots[node.older].newer = node.newer;
+    } else {
+        shard.oldest = node.newer;
+    }
+    if (node.newer != Handle::kInvalidIndex) {
+        shard.slots[node.newer].older = node.older;
+    } else {
+        shard.newest = node.older;
+    }
+    node.older = Handle::kInvalidIndex;
+    node.newer = Handle::kInvalidIndex;
+}
+
+void MessageMonitor::TouchLocked(Shard& shard, std::uint32_t slot) {
+    if (shard.newest == slot) {
+        return;
+    }
+    UnlinkLocked(shard, slot);
+    shard.slots[slot].older = shard.newest;
+    if (shard.newest != Handle::kInvalidIndex) {
+        shard.slots[shard.newest].newer = slot;
+    } else {
+        shard.oldest = slot;
+    }
+    shard.newest = slot;
+}
+
+void MessageMonitor::ExpireLocked(Shard& shard, std::chrono::steady_clock::time_point now) const {
+    if (ttl_ == std::chrono::steady_clock::duration::zero()) {
+        return;
+    }
+    // The list is in update order, so expiry stops at the first live entry.
+    while (shard.oldest != Handle::kInvalidIndex &&
+           now - shard.entries[shard.slots[shard.oldest].row].timestamp >= ttl_) {
+        EvictLocked(shard);
+    }
+}
+
+void MessageMonitor::EvictLocked(Shard& shard) const {
+    const std::uint32_t slot = shard.oldest;
+    if (UpdateSink* sink = remote_.sink()) {
+        // The viewer's row goes with the producer's, or its registration
+        // would outlive the handle.
+        const auto shard_index = static_cast<std::uint32_t>(&shard - shards_.get());
+        SendHandleRemove(*sink, Handle{slot, shard_index, shard.slots[slot].generation});
+    }
+    RemoveLocked(shard, slot);
+    ++shard.evicted;
+}
+
+void MessageMonitor::UpdateEntry(Entry& entry, Value&& value, std::chrono::steady_clock::time_point now) {
+    if (entry.update_count > 0) {
+        entry.stats.Record(std::chrono::duration<double>(now - entry.timestamp).count());
+    }
+    entry.value = std::move(value);
+    entry.update_count += 1;
+    entry.timestamp = now;
+}
+
+void MessageMonitor::SendValue(UpdateSink& sink, std::uint32_t widget, RecordType type, const PayloadPart* prefix,
+                               std::size_t prefix_count, const Value& value) {
+    PayloadPart parts[3];
+    RecordHeader header;
+    header.type = static_cast<std::uint16_t>(type);
+    header.widget = widget;
+    std::size_t count = 0;
+    for (; count < prefix_count; ++count) {
+        parts[count] = prefix[count];
+        header.size += static_cast<std::uint32_t>(prefix[count].size);
+    }
+
+    NumberPayload number;
+    if (const auto* text = std::get_if<std::string>(&value)) {
+        header.flags = kRecordFlagText;
+        const std::size_t size = std::min(text->size(), kMaxRecordPayload - header.size);
+        parts[count++] = PayloadPart{text->data(), size};
+        header.size += static_cast<std::uint32_t>(size);
+    } else {
+        if (const auto* signed_value = std::get_if<std::int64_t>(&value)) {
+            number = NumberPayload::From(*signed_value);
+        } else if (const auto* unsigned_value = std::get_if<std::uint64_t>(&value)) {
+            number = NumberPayload::From(*unsigned_value);
+        } else {
+            number = NumberPayload::From(std::get<double>(value));
         }
+        parts[count++] = PayloadPart{&number, sizeof(number)};
+        header.size += static_cast<std::uint32_t>(sizeof(number));
     }
+    sink.WriteUpdate(header, parts, count);
+}
+
+void MessageMonitor::SendRegistration(UpdateSink& sink, std::uint32_t shard, std::uint32_t slot,
+                                      std::uint32_t generation, const std::string& id) const {
+    const MessageKey key{(std::uint64_t{shard} << 32) | slot, generation};
+    const auto id_size = static_cast<std::uint32_t>(id.size());
+    const PayloadPart parts[] = {{&key, sizeof(key)}, {&id_size, sizeof(id_size)}, {id.data(), id.size()}};
+    RecordHeader header;
+    header.type = static_cast<std::uint16_t>(RecordType::kMessageRegister);
+    header.widget = remote_.id();
+    header.size = static_cast<std::uint32_t>(sizeof(key) + sizeof(id_size) + id.size());
+    sink.WriteDefinition(header, parts, 3);
+}
 
-    if (snapshot.empty()) {
+void MessageMonitor::SendHandleRemove(UpdateSink& sink, Handle handle) const {
+    const MessageKey key{(std::uint64_t{handle.shard} << 32) | handle.index, handle.generation};
+    SendReliable(sink, remote_.id(), RecordType::kMessageHandleRemove, &key, sizeof(key));
+}
+
+void MessageMonitor::MirrorTo(UpdateSink& sink, std::uint32_t parent) {
+    MessageMonitorParams params;
+    params.shards = shard_count_;
+    params.ttl_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(ttl_).count();
+    params.max_entries = max_entries_per_shard_ * shard_count_;
+    DefineNode(sink, remote_, RecordType::kMessageMonitor, parent, label_, &params, sizeof(params));
+
+    // Replay what is already here so the viewer starts from the same rows.
+    for (std::size_t s = 0; s < shard_count_; ++s) {
+        std::lock_guard<std::mutex> lock(shards_[s].mutex);
+        for (const Entry& entry : shards_[s].entries) {
+            SendRegistration(sink, static_cast<std::uint32_t>(s), entry.slot, shards_[s].slots[entry.slot].generation,
+                             entry.id);
+            if (entry.update_count > 0) {
+                const auto id_size = static_cast<std::uint32_t>(entry.id.size());
+                const PayloadPart prefix[] = {{&id_size, sizeof(id_size)}, {entry.id.data(), entry.id.size()}};
+                SendValue(sink, remote_.id(), RecordType::kMessageUpsert, prefix, 2, entry.value);
+            }
+        }
+    }
+}
+
+void MessageMonitor::ArrivalStats::Record(double interval_seconds) {
+    const double interval = std::max(0.0, interval_seconds);
+    if (intervals == 0) {
+        min_interval = interval;
+        max_interval = interval;
+        ewma_interval = interval;
+    } else {
+        min_interval = std::min(min_interval, interval);
+        max_interval = std::max(max_interval, interval);
+        jitter += (std::abs(interval - ewma_interval) - jitter) * kJitterGain;
+        ewma_interval += (interval - ewma_interval) * kEwmaWeight;
+    }
+    sum_interval += interval;
+    ++intervals;
+
+    auto micros = static_cast<std::uint64_t>(interval * 1e6);
+    std::size_t bucket = 0;
+    while (micros > 1 && bucket + 1 < kHistogramBuckets) {
+        micros >>= 1;
+        ++bucket;
+    }
+    ++histogram[bucket];
+}
+
+void MessageMonitor::Render() const {
+    // Expiry also runs here so IDs that went silent are dropped even when no
+    // producer writes to their shard any more.
+    const auto expire_now = std::chrono::steady_clock::now();
+    row_offsets_.resize(shard_count_ + 1);
+    std::size_t row_count = 0;
+    std::uint64_t layout = 0;
+    std::uint64_t evicted_count = 0;
+    for (std::size_t s = 0; s < shard_count_; ++s) {
+        row_offsets_[s] = row_count;
+        DEBUGGLASS_PROFILED_LOCK(lock, shards_[s].mutex);
+        ExpireLocked(shards_[s], expire_now);
+        row_count += shards_[s].entries.size();
+        layout += shards_[s].layout_version;
+        evicted_count += shards_[s].evicted;
+    }
+    row_offsets_[shard_count_] = row_count;
+
+    if (row_count == 0) {
         ImGui::TextUnformatted("No messages received");
         return;
     }
 
-    bool copy_requested = false;
-    const std::string copy_label = "Copy CSV##" + label_;
-    if (ImGui::Button(copy_label.c_str())) {
-        copy_requested = true;
+    ImGui::PushID(label_.c_str());
+    if (ImGui::Button("Export")) {
+        ImGui::OpenPopup("export");
+    }
+    if (ImGui::BeginPopup("export")) {
+        export_.MenuItems(*this, label_);
+        ImGui::EndPopup();
+    }
+    if (export_.HasStatus()) {
+        ImGui::SameLine();
+        export_.RenderStatus();
+    }
+    if (evicted_count > 0) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("%llu evicted", static_cast<unsigned long long>(evicted_count));
     }
 
-    const std::string table_id = "MessageMonitor##" + label_;
     const ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
                                   ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY |
-                                  ImGuiTableFlags_Reorderable;
-    if (ImGui::BeginTable(table_id.c_str(), 4, flags)) {
+                                  ImGuiTableFlags_Reorderable | ImGuiTableFlags_Hideable |
+                                  ImGuiTableFlags_Sortable | ImGuiTableFlags_SortTristate;
+    if (ImGui::BeginTable("MessageMonitor", kColumnCount, flags)) {
+        const ImGuiTableColumnFlags stat_flags = ImGuiTableColumnFlags_WidthFixed |
+                                                 ImGuiTableColumnFlags_PreferSortDescending;
         ImGui::TableSetupScrollFreeze(0, 1);
         ImGui::TableSetupColumn("ID", ImGuiTableColumnFlags_WidthStretch, 0.4f);
-        ImGui::TableSetupColumn("Value", ImGuiTableColumnFlags_WidthStretch, 0.4f);
-        ImGui::TableSetupColumn("Updates", ImGuiTableColumnFlags_WidthFixed, 0.2f);
-        ImGui::TableSetupColumn("Timestamp", ImGuiTableColumnFlags_WidthFixed, 0.3f);
+        ImGui::TableSetupColumn("Value", ImGuiTableColumnFlags_WidthStretch | ImGuiTableColumnFlags_NoSort, 0.4f);
+        ImGui::TableSetupColumn("Updates", stat_flags, 0.2f);
+        ImGui::TableSetupColumn("Rate (Hz)", stat_flags, 0.2f);
+        ImGui::TableSetupColumn("Mean (ms)", stat_flags, 0.2f);
+        ImGui::TableSetupColumn("Min (ms)", stat_flags, 0.2f);
+        ImGui::TableSetupColumn("Max (ms)", stat_flags, 0.2f);
+        ImGui::TableSetupColumn("Jitter (ms)", stat_flags, 0.2f);
+        ImGui::TableSetupColumn("Timestamp", stat_flags, 0.3f);
         ImGui::TableHeadersRow();
 
-        const auto now = std::chrono::system_clock::now();
-        for (const auto& entry : snapshot) {
-            const auto age = now - entry.timestamp;
-            const float age_seconds = std::chrono::duration_cast<std::chrono::duration<float>>(age).count();
-            const bool highlight = age_seconds <= kHighlightWindowSeconds;
+        const auto steady_now = std::chrono::steady_clock::now();
+        const auto system_now = std::chrono::system_clock::now();
 
-            if (highlight) {
-                ImGui::TableNextRow(ImGuiTableRowFlags_None, 0.0f);
-                const ImU32 bg_color = ImGui::GetColorU32(ImVec4(0.9f, 0.9f, 0.3f, 0.25f));
-                ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, bg_color);
+        bool sorted = false;
+        if (ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs(); specs && specs->SpecsCount > 0) {
+            const int column = specs->Specs[0].ColumnIndex;
+            const bool descending = specs->Specs[0].SortDirection == ImGuiSortDirection_Descending;
+            const bool stale = specs->SpecsDirty || column != sort_column_ || descending != sort_descending_ ||
+                               sorted_rows_.size() != row_count || layout != sorted_layout_ ||
+                               (column != kColumnId && steady_now - sorted_at_ >= kResortInterval);
+            if (stale) {
+                SortRows(column, descending, row_count);
+                sorted_at_ = steady_now;
+                sorted_layout_ = layout;
+                specs->SpecsDirty = false;
+            }
+            sorted = true;
+        } else {
+            sort_column_ = -1;
+            sorted_rows_.clear();
+        }
+
+        const ImU32 highlight_color = ImGui::GetColorU32(ImVec4(0.9f, 0.9f, 0.3f, 0.25f));
+        NumberBuffer number_buffer;
+        TimestampBuffer timestamp_buffer;
+
+        // Only the rows the clipper reports as visible are copied, each under
+        // a short shard lock, and only those rows get formatted. Rows removed
+        // by a producer since the counts above were taken are skipped.
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(sorted ? sorted_rows_.size() : row_count));
+        while (clipper.Step()) {
+            const auto first = static_cast<std::size_t>(clipper.DisplayStart);
+            const auto last = static_cast<std::size_t>(clipper.DisplayEnd);
+            if (visible_rows_.size() < last - first) {
+                visible_rows_.resize(last - first);
+            }
+            std::size_t visible = 0;
+            if (sorted) {
+                for (std::size_t row = first; row < last; ++row) {
+                    const RowRef ref = sorted_rows_[row];
+                    const Shard& shard = shards_[ref.shard];
+                    DEBUGGLASS_PROFILED_LOCK(lock, shard.mutex);
+                    const Slot& slot = shard.slots[ref.slot];
+                    if (slot.generation == ref.generation && slot.row != Handle::kInvalidIndex) {
+                        visible_rows_[visible++] = shard.entries[slot.row];
+                    }
+                }
             } else {
-                ImGui::TableNextRow();
+                for (std::size_t s = 0; s < shard_count_; ++s) {
+                    const std::size_t shard_first = std::max(first, row_offsets_[s]);
+                    std::size_t shard_last = std::min(last, row_offsets_[s + 1]);
+                    if (shard_first >= shard_last) {
+                        continue;
+                    }
+                    DEBUGGLASS_PROFILED_LOCK(lock, shards_[s].mutex);
+                    const auto& entries = shards_[s].entries;
+                    shard_last = std::min(shard_last, row_offsets_[s] + entries.size());
+                    for (std::size_t row = shard_first; row < shard_last; ++row) {
+                        visible_rows_[visible++] = entries[row - row_offsets_[s]];
+                    }
+                }
             }
 
-            ImGui::TableSetColumnIndex(0);
-            ImGui::TextUnformatted(entry.id.c_str());
+            for (std::size_t row = 0; row < visible; ++row) {
+                const Entry& entry = visible_rows_[row];
+                const auto age = steady_now - entry.timestamp;
+                const float age_seconds = std::chrono::duration_cast<std::chrono::duration<float>>(age).count();
+                const bool highlight = entry.update_count > 0 && age_seconds <= kHighlightWindowSeconds;
+
+                if (highlight) {
+                    ImGui::TableNextRow(ImGuiTableRowFlags_None, 0.0f);
+                    ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, highlight_color);
+                } else {
+                    ImGui::TableNextRow();
+                }
 
-            ImGui::TableSetColumnIndex(1);
-            ImGui::TextUnformatted(entry.value.c_str());
+                ImGui::TableSetColumnIndex(kColumnId);
+                ImGui::TextUnformatted(entry.id.data(), entry.id.data() + entry.id.size());
 
-            ImGui::TableSetColumnIndex(2);
-            ImGui::Text("%llu", static_cast<unsigned long long>(entry.update_count));
+                ImGui::TableSetColumnIndex(kColumnValue);
+                const std::string_view value_text = FormatValue(entry.value, number_buffer);
+                ImGui::TextUnformatted(value_text.data(), value_text.data() + value_text.size());
 
-            ImGui::TableSetColumnIndex(3);
-            const std::string timestamp_text = FormatTimestamp(entry.timestamp);
-            ImGui::TextUnformatted(timestamp_text.c_str());
+                ImGui::TableSetColumnIndex(kColumnUpdates);
+                ImGui::Text("%llu", static_cast<unsigned long long>(entry.update_count));
+
+                const ArrivalStats& stats = entry.stats;
+                if (stats.intervals > 0) {
+                    ImGui::TableSetColumnIndex(kColumnRate);
+                    ImGui::Text("%.1f", CurrentRate(stats, age_seconds));
+                    if (ImGui::IsItemHovered()) {
+                        RenderHistogramTooltip(stats);
+                    }
+                    ImGui::TableSetColumnIndex(kColumnMean);
+                    ImGui::Text("%.2f", stats.sum_interval / static_cast<double>(stats.intervals) * 1e3);
+                    ImGui::TableSetColumnIndex(kColumnMin);
+                    ImGui::Text("%.2f", stats.min_interval * 1e3);
+                    ImGui::TableSetColumnIndex(kColumnMax);
+                    ImGui::Text("%.2f", stats.max_interval * 1e3);
+                    ImGui::TableSetColumnIndex(kColumnJitter);
+                    ImGui::Text("%.2f", stats.jitter * 1e3);
+                }
+
+                ImGui::TableSetColumnIndex(kColumnTimestamp);
+                if (entry.update_count == 0) {
+                    ImGui::TextDisabled("-");
+                } else {
+                    const auto wall_time = ToSystemTime(entry.timestamp, steady_now, system_now);
+                    const std::string_view timestamp_text = FormatTimestamp(wall_time, timestamp_buffer);
+                    ImGui::TextUnformatted(timestamp_text.data(), timestamp_text.data() + timestamp_text.size());
+                }
+            }
         }
+        clipper.End();
         ImGui::EndTable();
     }
+    ImGui::PopID();
+}
+
+void MessageMonitor::SortRows(int column, bool descending, std::size_t row_count) const {
+    sort_column_ = column;
+    sort_descending_ = descending;
+    sorted_rows_.clear();
+    sorted_rows_.reserve(row_count);
+
+    const auto steady_now = std::chrono::steady_clock::now();
+    const auto ref_to = [](const Shard& shard, std::size_t s, const Entry& entry) {
+        return RowRef{static_cast<std::uint32_t>(s), entry.slot, shard.slots[entry.slot].generation};
+    };
+    const auto by_ref = [](const RowRef& a, const RowRef& b) {
+        return a.shard != b.shard ? a.shard < b.shard : a.slot < b.slot;
+    };
+
+    if (column == kColumnId) {
+        std::vector<std::pair<std::string, RowRef>> keyed;
+        keyed.reserve(row_count);
+        for (std::size_t s = 0; s < shard_count_; ++s) {
+            DEBUGGLASS_PROFILED_LOCK(lock, shards_[s].mutex);
+            const Shard& shard = shards_[s];
+            for (const Entry& entry : shard.entries) {
+                keyed.emplace_back(entry.id, ref_to(shard, s, entry));
+            }
+        }
+        std::sort(keyed.begin(), keyed.end(), [&](const auto& a, const auto& b) {
+            if (a.first != b.first) {
+                return descending ? a.first > b.first : a.first < b.first;
+            }
+            return by_ref(a.second, b.second);
+        });
+        for (const auto& [_, ref] : keyed) {
+            sorted_rows_.push_back(ref);
+        }
+        return;
+    }
 
-    if (copy_requested) {
-        std::ostringstream csv;
-        csv << "id,value,updates,timestamp\n";
-        for (const auto& entry : snapshot) {
-            csv << entry.id << ',' << entry.value << ','
-                << entry.update_count << ',' << FormatTimestamp(entry.timestamp) << '\n';
+    std::vector<std::pair<double, RowRef>> keyed;
+    keyed.reserve(row_count);
+    for (std::size_t s = 0; s < shard_count_; ++s) {
+        DEBUGGLASS_PROFILED_LOCK(lock, shards_[s].mutex);
+        const Shard& shard = shards_[s];
+        for (const Entry& entry : shard.entries) {
+            const ArrivalStats& stats = entry.stats;
+            const float age_seconds = std::chrono::duration<float>(steady_now - entry.timestamp).count();
+            double key = 0.0;
+            switch (column) {
+            case kColumnUpdates:
+                key = static_cast<double>(entry.update_count);
+                break;
+            case kColumnRate:
+                key = stats.intervals > 0 ? CurrentRate(stats, age_seconds) : 0.0;
+                break;
+            case kColumnMean:
+                key = stats.intervals > 0 ? stats.sum_interval / static_cast<double>(stats.intervals) : 0.0;
+                break;
+            case kColumnMin:
+                key = stats.min_interval;
+                break;
+            case kColumnMax:
+                key = stats.max_interval;
+                break;
+            case kColumnJitter:
+                key = stats.jitter;
+                break;
+            default:
+                key = entry.update_count == 0 ? 0.0 : static_cast<double>(entry.timestamp.time_since_epoch().count());
+                break;
+            }
+            keyed.emplace_back(key, ref_to(shard, s, entry));
+        }
+    }
+    std::sort(keyed.begin(), keyed.end(), [&](const auto& a, const auto& b) {
+        if (a.first != b.first) {
+            return descending ? a.first > b.first : a.first < b.first;
+        }
+        return by_ref(a.second, b.second);
+    });
+    for (const auto& [_, ref] : keyed) {
+        sorted_rows_.push_back(ref);
+    }
+}
+
+bool MessageMonitor::Export(ExportTable& table) const {
+    table.SetColumns({"id", "value", "updates", "timestamp", "rate_hz", "mean_interval_ms", "min_interval_ms",
+                      "max_interval_ms", "jitter_ms"});
+    table.Reserve(size());
+    const auto steady_now = std::chrono::steady_clock::now();
+    const auto system_now = std::chrono::system_clock::now();
+    // Rows are copied out a chunk at a time, resuming by slot, which rows
+    // never move between, so the table is filled without holding a shard
+    // lock and producers wait for one chunk at most.
+    constexpr std::uint32_t kExportChunk = 4096;
+    std::vector<Entry> chunk;
+    for (std::size_t s = 0; s < shard_count_; ++s) {
+        std::uint32_t next_slot = 0;
+        while (true) {
+            std::size_t copied = 0;
+            {
+                std::lock_guard<std::mutex> lock(shards_[s].mutex);
+                const Shard& shard = shards_[s];
+                const auto end_slot = static_cast<std::uint32_t>(shard.slots.size());
+                for (; next_slot < end_slot && copied < kExportChunk; ++next_slot) {
+                    const std::uint32_t row = shard.slots[next_slot].row;
+                    if (row == Handle::kInvalidIndex) {
+                        continue;
+                    }
+                    if (copied == chunk.size()) {
+                        chunk.push_back(shard.entries[row]);
+                    } else {
+                        chunk[copied] = shard.entries[row];
+                    }
+                    ++copied;
+                }
+            }
+            if (copied == 0) {
+                break;
+            }
+            for (std::size_t i = 0; i < copied; ++i) {
+                const Entry& entry = chunk[i];
+                table.AddText(entry.id);
+                if (const auto* text = std::get_if<std::string>(&entry.value)) {
+                    table.AddText(*text);
+                } else if (const auto* number = std::get_if<std::int64_t>(&entry.value)) {
+                    table.AddSigned(*number);
+                } else if (const auto* number = std::get_if<std::uint64_t>(&entry.value)) {
+                    table.AddUnsigned(*number);
+                } else {
+                    table.AddFloat(std::get<double>(entry.value));
+                }
+                table.AddUnsigned(entry.update_count);
+                const auto wall_time = ToSystemTime(entry.timestamp, steady_now, system_now);
+                table.AddTimestamp(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(wall_time.time_since_epoch()).count());
+
+                const ArrivalStats& stats = entry.stats;
+                if (stats.intervals > 0) {
+                    const float age_seconds = std::chrono::duration<float>(steady_now - entry.timestamp).count();
+                    table.AddFloat(CurrentRate(stats, age_seconds));
+                    table.AddFloat(stats.sum_interval / static_cast<double>(stats.intervals) * 1e3);
+                    table.AddFloat(stats.min_interval * 1e3);
+                    table.AddFloat(stats.max_interval * 1e3);
+                    table.AddFloat(stats.jitter * 1e3);
+                } else {
+                    for (int column = 0; column < 5; ++column) {
+                        table.AddNull();
+                    }
+                }
+            }
         }
-        const std::string csv_text = csv.str();
-        ImGui::SetClipboardText(csv_text.c_str());
     }
+    return true;
 }
 
 }  // namespace debugglass
@@ -1,50 +1,336 @@
 #pragma once
 
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <mutex>
-#include <sstream>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
+#include <variant>
 #include <vector>
 
+#include "debugglass/util/redraw_signal.h"
+#include "debugglass/widgets/export_control.h"
 #include "debugglass/widgets/window_content.h"
 
 namespace debugglass {
 
+struct MessageMonitorOptions {
+    // Entries are partitioned by ID hash across this many independently
+    // locked shards so producers on different threads rarely contend.
+    std::size_t shards = 1;
+
+    // IDs not updated for this long are dropped. Zero keeps them forever.
+    std::chrono::steady_clock::duration ttl = std::chrono::steady_clock::duration::zero();
+
+    // Upper bound on the number of IDs; adding one more evicts the least
+    // recently updated. Enforced per shard as ceil(max_entries / shards).
+    // Zero means unbounded.
+    std::size_t max_entries = 0;
+};
+
 class MessageMonitor : public WindowContent {
 public:
-    explicit MessageMonitor(std::string label);
+    // Stable reference to one message ID, returned by RegisterId. Stops
+    // matching once the ID is removed or evicted, even if it is registered
+    // again later.
+    struct Handle {
+        static constexpr std::uint32_t kInvalidIndex = std::numeric_limits<std::uint32_t>::max();
 
-    const std::string& label() const noexcept { return label_; }
+        std::uint32_t index = kInvalidIndex;
+        std::uint32_t shard = 0;
+        std::uint32_t generation = 0;
+
+        bool valid() const noexcept { return index != kInvalidIndex; }
+    };
+
+    // Elements of the batch upserts below.
+    template <typename T>
+    struct HandleUpdate {
+        Handle handle;
+        T value;
+    };
+
+    template <typename T>
+    struct MessageUpdate {
+        std::string id;
+        T value;
+    };
+
+    explicit MessageMonitor(std::string label, MessageMonitorOptions options = {});
+
+    const std::string& label() const noexcept override { return label_; }
+
+    // Returns the handle for `id`, adding an empty row if the ID is new.
+    // Upserts through a handle skip string construction and hashing.
+    Handle RegisterId(std::string id);
+
+    // Returns false, dropping the value, when the handle's ID has been
+    // removed or evicted; register it again to resume.
+    bool Upsert(Handle handle, std::string value);
+
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    bool Upsert(Handle handle, T value) {
+        return UpsertValue(handle, ToValue(value));
+    }
 
     void UpsertMessage(std::string id, std::string value);
 
+    // Stores the raw number; it is only formatted when the row is drawn.
     template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
     void UpsertMessage(std::string id, T value) {
-        std::ostringstream stream;
-        if constexpr (std::is_floating_point_v<T>) {
-            stream.setf(std::ios::fixed, std::ios::floatfield);
-            stream.precision(3);
-        }
-        stream << value;
-        UpsertMessage(std::move(id), stream.str());
+        UpsertValue(std::move(id), ToValue(value));
     }
 
+    // Batch upserts take each shard's lock once per batch rather than once
+    // per update and raise the redraw signal once. Updates to the same ID
+    // apply in array order. UpsertBatch returns how many handles matched.
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    std::size_t UpsertBatch(const HandleUpdate<T>* updates, std::size_t count);
+
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    void UpsertMessages(const MessageUpdate<T>* updates, std::size_t count);
+
+    // Drops one ID. Returns whether it was present.
+    bool RemoveMessage(const std::string& id);
+    bool Remove(Handle handle);
+    void Clear();
+
+    // IDs currently held, and how many were dropped by TTL or max_entries.
+    std::size_t size() const;
+    std::uint64_t evicted() const;
+
     void Render() const override;
+    // id, value, updates, timestamp and the arrival statistics of every ID.
+    bool Export(ExportTable& table) const override;
+
+    // While mirrored, values are only forwarded. Registrations stay local so
+    // handles keep working, and TTL and max_entries still evict them here;
+    // the viewer is told about every eviction.
+    void MirrorTo(UpdateSink& sink, std::uint32_t parent) override;
 
 private:
+    // Floats are shown in fixed notation with three decimals.
+    using Value = std::variant<std::string, std::int64_t, std::uint64_t, double>;
+
+    // Constant-space inter-arrival statistics, updated on every upsert.
+    struct ArrivalStats {
+        // Bucket b counts intervals in [2^b, 2^(b+1)) microseconds; the first
+        // and last buckets also absorb everything below and above.
+        static constexpr std::size_t kHistogramBuckets = 24;
+
+        static constexpr double kEwmaWeight = 1.0 / 8.0;
+        static constexpr double kJitterGain = 1.0 / 16.0;
+
+        void Record(double interval_seconds);
+
+        std::uint64_t intervals = 0;
+        double sum_interval = 0.0;
+        double min_interval = 0.0;
+        double max_interval = 0.0;
+        double ewma_interval = 0.0;
+        // RFC 3550 style smoothed deviation from ewma_interval.
+        double jitter = 0.0;
+        std::array<std::uint32_t, kHistogramBuckets> histogram{};
+    };
+
     struct Entry {
         std::string id;
-        std::string value;
+        Value value;
         uint64_t update_count = 0;
-        std::chrono::system_clock::time_point timestamp;
+        // Last update, or registration time while update_count is zero.
+        std::chrono::steady_clock::time_point timestamp;
+        ArrivalStats stats;
+        // Back reference into Shard::slots.
+        std::uint32_t slot = 0;
+    };
+
+    // Indirection between handles and the dense entry array, which is
+    // compacted by swapping on removal. Slots also form an intrusive list in
+    // update order so eviction takes the oldest in O(1).
+    struct Slot {
+        std::uint32_t row = Handle::kInvalidIndex;
+        std::uint32_t generation = 0;
+        std::uint32_t older = Handle::kInvalidIndex;
+        std::uint32_t newer = Handle::kInvalidIndex;
+    };
+
+    // A sorted row, by slot so it survives compaction of the entry array
+    // and is skipped once its ID was removed and the slot reused.
+    struct RowRef {
+        std::uint32_t shard;
+        std::uint32_t slot;
+        std::uint32_t generation;
     };
 
+    template <typename T>
+    static Value ToValue(T value) {
+        if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+                      std::is_same_v<T, unsigned char>) {
+            return Value{std::in_place_type<std::string>, 1, static_cast<char>(value)};
+        } else if constexpr (std::is_floating_point_v<T>) {
+            return Value{static_cast<double>(value)};
+        } else if constexpr (std::is_signed_v<T>) {
+            return Value{static_cast<std::int64_t>(value)};
+        } else {
+            return Value{static_cast<std::uint64_t>(value)};
+        }
+    }
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::vector<Entry> entries;
+        std::vector<Slot> slots;
+        std::vector<std::uint32_t> free_slots;
+        std::unordered_map<std::string, std::uint32_t> slot_by_id;
+        std::uint32_t oldest = Handle::kInvalidIndex;
+        std::uint32_t newest = Handle::kInvalidIndex;
+        std::uint64_t evicted = 0;
+        // Bumped whenever rows are added or removed, so the render thread
+        // knows its sorted order is out of date.
+        std::uint64_t layout_version = 0;
+    };
+
+    // Forwards one upsert to the sink. `prefix` is the ID or handle key.
+    static void SendValue(UpdateSink& sink, std::uint32_t widget, RecordType type, const PayloadPart* prefix,
+                          std::size_t prefix_count, const Value& value);
+    void SendRegistration(UpdateSink& sink, std::uint32_t shard, std::uint32_t slot, std::uint32_t generation,
+                          const std::string& id) const;
+    void SendHandleRemove(UpdateSink& sink, Handle handle) const;
+
+    void UpsertValue(std::string id, Value value);
+    bool UpsertValue(Handle handle, Value value);
+    // Marks a registered row as updated while mirrored, so TTL and LRU
+    // order follow the forwarded values. Returns false if it was evicted.
+    bool TouchLocal(Handle handle);
+    static void UpdateEntry(Entry& entry, Value&& value, std::chrono::steady_clock::time_point now);
+    // Rebuilds sorted_rows_ from the current sort specs. Render thread only.
+    void SortRows(int column, bool descending, std::size_t row_count) const;
+
+    // Shard bookkeeping; callers hold the shard's mutex.
+    void UpsertLocked(Shard& shard, const std::string& id, Value&& value,
+                      std::chrono::steady_clock::time_point now) const;
+    static bool UpsertLocked(Shard& shard, Handle handle, Value&& value, std::chrono::steady_clock::time_point now);
+    std::uint32_t InsertLocked(Shard& shard, std::string id, std::chrono::steady_clock::time_point now) const;
+    static void RemoveLocked(Shard& shard, std::uint32_t slot);
+    static void TouchLocked(Shard& shard, std::uint32_t slot);
+    static void UnlinkLocked(Shard& shard, std::uint32_t slot);
+    void ExpireLocked(Shard& shard, std::chrono::steady_clock::time_point now) const;
+    // Drops the least recently updated row, telling the viewer if mirrored.
+    void EvictLocked(Shard& shard) const;
+
+    std::size_t ShardFor(const std::string& id) const;
+    // Groups the positions 0..count-1 of a batch by shard_of, keeping array
+    // order: shard s gets order[offsets[s]] up to order[offsets[s + 1]].
+    // Positions with shard_of >= shard_count_ are left out.
+    void BucketByShard(const std::uint32_t* shard_of,
+                       std::size_t count,
+                       std::vector<std::uint32_t>& order,
+                       std::vector<std::size_t>& offsets) const;
+
     std::string label_;
-    mutable std::mutex mutex_;
-    std::vector<Entry> entries_;
-    std::unordered_map<std::string, std::size_t> index_by_id_;
+    std::size_t shard_count_;
+    std::chrono::steady_clock::duration ttl_;
+    std::size_t max_entries_per_shard_;
+    std::unique_ptr<Shard[]> shards_;
+
+    // Sum of the shards' layout_version when sorted_rows_ was built.
+    mutable std::uint64_t sorted_layout_ = 0;
+
+    // Rows are listed shard by shard; row_offsets_[s] is the first row of
+    // shard s in the current frame. Only touched by the render thread.
+    mutable std::vector<std::size_t> row_offsets_;
+
+    // Row order while the table is sorted, refreshed when the specs or row
+    // count change and periodically for the live statistic columns.
+    mutable std::vector<RowRef> sorted_rows_;
+    mutable int sort_column_ = -1;
+    mutable bool sort_descending_ = false;
+    mutable std::chrono::steady_clock::time_point sorted_at_;
+
+    // Copies of the rows currently on screen. Reused across frames so the
+    // strings keep their capacity; only touched by the render thread.
+    mutable std::vector<Entry> visible_rows_;
+
+    mutable ExportControl export_;
 };
 
+template <typename T, typename>
+std::size_t MessageMonitor::UpsertBatch(const HandleUpdate<T>* updates, std::size_t count) {
+    if (remote_.sink() != nullptr) {
+        std::size_t forwarded = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            forwarded += Upsert(updates[i].handle, updates[i].value) ? 1 : 0;
+        }
+        return forwarded;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    // Reused across calls so batches do not allocate.
+    thread_local std::vector<std::uint32_t> shard_of;
+    thread_local std::vector<std::uint32_t> order;
+    thread_local std::vector<std::size_t> offsets;
+    shard_of.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        shard_of[i] = updates[i].handle.shard;
+    }
+    BucketByShard(shard_of.data(), count, order, offsets);
+    std::size_t applied = 0;
+    for (std::size_t s = 0; s < shard_count_; ++s) {
+        if (offsets[s] == offsets[s + 1]) {
+            continue;
+        }
+        Shard& shard = shards_[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        ExpireLocked(shard, now);
+        for (std::size_t k = offsets[s]; k < offsets[s + 1]; ++k) {
+            const HandleUpdate<T>& update = updates[order[k]];
+            applied += UpsertLocked(shard, update.handle, ToValue(update.value), now) ? 1 : 0;
+        }
+    }
+    if (applied != 0) {
+        RedrawSignal::Raise();
+    }
+    return applied;
+}
+
+template <typename T, typename>
+void MessageMonitor::UpsertMessages(const MessageUpdate<T>* updates, std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (remote_.sink() != nullptr) {
+        for (std::size_t i = 0; i < count; ++i) {
+            UpsertValue(updates[i].id, ToValue(updates[i].value));
+        }
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    // Hash each ID once; reused across calls so batches do not allocate.
+    thread_local std::vector<std::uint32_t> shard_of;
+    thread_local std::vector<std::uint32_t> order;
+    thread_local std::vector<std::size_t> offsets;
+    shard_of.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        shard_of[i] = static_cast<std::uint32_t>(ShardFor(updates[i].id));
+    }
+    BucketByShard(shard_of.data(), count, order, offsets);
+    for (std::size_t s = 0; s < shard_count_; ++s) {
+        if (offsets[s] == offsets[s + 1]) {
+            continue;
+        }
+        Shard& shard = shards_[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        ExpireLocked(shard, now);
+        for (std::size_t k = offsets[s]; k < offsets[s + 1]; ++k) {
+            const MessageUpdate<T>& update = updates[order[k]];
+            UpsertLocked(shard, update.id, ToValue(update.value), now);
+        }
+    }
+    RedrawSignal::Raise();
+}
+
 }  // namespace debugglass
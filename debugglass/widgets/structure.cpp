@@ -4,11 +4,14 @@
 
 #include <imgui.h>
 
+#include "debugglass/util/redraw_signal.h"
 #include "debugglass/widgets/variable.h"
 
 namespace debugglass {
 
-Structure::Structure(std::string label) : label_(std::move(label)) {}
+Structure::Structure(std::string label, WidgetPath path) : label_(std::move(label)), path_(std::move(path)) {
+    path_.set_owner(this);
+}
 
 Structure& Structure::AddStructure(std::string label) {
     auto structure = AddStructureImpl(std::move(label));
@@ -21,36 +24,87 @@ Variable& Structure::AddVariable(std::string label) {
 }
 
 void Structure::Render() const {
-    std::vector<std::shared_ptr<WindowContent>> children_snapshot;
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        children_snapshot = children_;
-    }
-
     ImGui::PushID(this);
-    if (ImGui::TreeNode(label_.c_str())) {
-        for (const auto& child : children_snapshot) {
-            if (child) {
-                child->Render();
-            }
-        }
+    const bool open = ImGui::TreeNode(label_.c_str());
+    export_.ContextMenu(*this, label_);
+    if (export_.HasStatus()) {
+        ImGui::SameLine();
+        export_.RenderStatus();
+    }
+    if (open) {
+        Rcu::ReadGuard guard;
+        RenderWidgets(children_.Read());
         ImGui::TreePop();
     }
     ImGui::PopID();
 }
 
+bool Structure::Export(ExportTable& table) const {
+    table.SetColumns({"path", "value"});
+    ExportLeaves(table, label_);
+    return true;
+}
+
+void Structure::ExportLeaves(ExportTable& table, const std::string& path) const {
+    Rcu::ReadGuard guard;
+    for (const auto& child : children_.Read()) {
+        child->ExportLeaves(table, path + "/" + child->label());
+    }
+}
+
 std::shared_ptr<Structure> Structure::AddStructureImpl(std::string label) {
-    auto structure = std::make_shared<Structure>(std::move(label));
-    std::lock_guard<std::mutex> lock(mutex_);
-    children_.push_back(structure);
+    auto structure = MakePooled<Structure>(label, path_.Child(label));
+    path_.Register(structure->label(), structure.get());
+    AddChild(structure);
     return structure;
 }
 
 std::shared_ptr<Variable> Structure::AddVariableImpl(std::string label) {
-    auto variable = std::make_shared<Variable>(std::move(label));
-    std::lock_guard<std::mutex> lock(mutex_);
-    children_.push_back(variable);
+    auto variable = MakePooled<Variable>(std::move(label));
+    path_.Register(variable->label(), variable.get());
+    AddChild(variable);
     return variable;
 }
 
+LayoutStructure& Structure::AddLayoutStructure(std::string label, StructLayout layout, std::size_t size) {
+    auto structure = MakePooled<LayoutStructure>(std::move(label), std::move(layout), size);
+    path_.Register(structure->label(), structure.get());
+    AddChild(structure);
+    return *structure;
+}
+
+bool Structure::Remove(const WindowContent& child) {
+    path_.Unregister(child.label(), &child);
+    std::lock_guard<std::mutex> lock(mirror_mutex_);
+    UpdateSink* sink = child.remote().sink();
+    const std::uint32_t remote_id = child.remote().id();
+    const auto removed = children_.RemoveIf([&](const auto& entry) { return entry.get() == &child; });
+    if (removed == 0) {
+        return false;
+    }
+    SendRemove(sink, remote_id);
+    RedrawSignal::Raise();
+    return true;
+}
+
+void Structure::MirrorTo(UpdateSink& sink, std::uint32_t parent) {
+    std::lock_guard<std::mutex> lock(mirror_mutex_);
+    const std::uint32_t id = DefineNode(sink, remote_, RecordType::kStructure, parent, label_);
+    Rcu::ReadGuard guard;
+    for (const auto& child : children_.Read()) {
+        child->MirrorTo(sink, id);
+    }
+}
+
+void Structure::AddChild(std::shared_ptr<WindowContent> child) {
+    {
+        std::lock_guard<std::mutex> lock(mirror_mutex_);
+        if (UpdateSink* sink = remote_.sink()) {
+            child->MirrorTo(*sink, remote_.id());
+        }
+        children_.PushBack(std::move(child));
+    }
+    RedrawSignal::Raise();
+}
+
 }  // namespace debugglass
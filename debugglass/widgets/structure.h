@@ -3,8 +3,15 @@
 #include <memory>
 #include <mutex>
 #include <string>
-#include <vector>
+#include <utility>
 
+#include "debugglass/util/rcu.h"
+#include "debugglass/util/slab_pool.h"
+#include "debugglass/widgets/bound_structure.h"
+#include "debugglass/widgets/export_control.h"
+#include "debugglass/widgets/typed_variable.h"
+#include "debugglass/widgets/watch.h"
+#include "debugglass/widgets/widget_index.h"
 #include "debugglass/widgets/window_content.h"
 
 namespace debugglass {
@@ -13,22 +20,64 @@ class Variable;
 
 class Structure : public WindowContent {
 public:
-    explicit Structure(std::string label);
+    explicit Structure(std::string label, WidgetPath path = {});
 
     Structure& AddStructure(std::string label);
     Variable& AddVariable(std::string label);
+    // Lock-free variable for an arithmetic T, formatted only when drawn.
+    template <typename T>
+    TypedVariable<T>& AddTypedVariable(std::string label) {
+        auto variable = MakePooled<TypedVariable<T>>(std::move(label));
+        path_.Register(variable->label(), variable.get());
+        AddChild(variable);
+        return *variable;
+    }
+    // Sampled by the render thread; `source` is a const std::atomic<T>*, a
+    // const T* or a callable returning T. See Watch.
+    template <typename Source>
+    auto& AddWatch(std::string label, Source source) {
+        auto watch = MakeWatch(std::move(label), std::move(source));
+        path_.Register(watch->label(), watch.get());
+        AddChild(watch);
+        return *watch;
+    }
+    // Mirrors a whole struct described by StructFields<T>; see BoundStructure.
+    template <typename T>
+    BoundStructure<T>& AddBoundStructure(std::string label, const T& initial = T{}) {
+        auto structure = MakePooled<BoundStructure<T>>(std::move(label), initial);
+        path_.Register(structure->label(), structure.get());
+        AddChild(structure);
+        return *structure;
+    }
 
-    const std::string& label() const noexcept { return label_; }
+    // Viewer-side stand-in for a mirrored BoundStructure.
+    LayoutStructure& AddLayoutStructure(std::string label, StructLayout layout, std::size_t size);
+
+    // Detaches a child; see Tab::Remove.
+    bool Remove(const WindowContent& child);
+
+    const std::string& label() const noexcept override { return label_; }
 
     void Render() const override;
+    // One (path, value) row per leaf below this structure; paths join
+    // labels with '/', starting from this structure's. Watches are left
+    // out since their sources are only read on the render thread.
+    bool Export(ExportTable& table) const override;
+    void ExportLeaves(ExportTable& table, const std::string& path) const override;
+    void MirrorTo(UpdateSink& sink, std::uint32_t parent) override;
 
 private:
     std::shared_ptr<Structure> AddStructureImpl(std::string label);
     std::shared_ptr<Variable> AddVariableImpl(std::string label);
+    void AddChild(std::shared_ptr<WindowContent> child);
 
     std::string label_;
-    mutable std::mutex mutex_;
-    std::vector<std::shared_ptr<WindowContent>> children_;
+    WidgetPath path_;
+    RcuList<std::shared_ptr<WindowContent>> children_;
+    // Held while mirroring and while adding or removing children, so every
+    // child is announced exactly once and none is missed.
+    std::mutex mirror_mutex_;
+    mutable ExportControl export_;
 };
 
 }  // namespace debugglass
@@ -4,89 +4,141 @@
 
 #include <utility>
 
+#include "debugglass/util/profiler.h"
+#include "debugglass/util/redraw_signal.h"
 #include "debugglass/widgets/graph.h"
+#include "debugglass/widgets/history_graph.h"
 #include "debugglass/widgets/structure.h"
 #include "debugglass/widgets/variable.h"
 
 namespace debugglass {
 
-Tab::Tab(std::string label) : label_(std::move(label)) {}
+Tab::Tab(std::string label, WidgetPath path) : label_(std::move(label)), path_(std::move(path)) {
+    path_.set_owner(this);
+}
 
 void Tab::SetRenderCallback(RenderCallback callback) {
-    std::lock_guard<std::mutex> lock(content_mutex_);
-    callback_ = std::move(callback);
+    callback_.Store(std::move(callback));
+    RedrawSignal::Raise();
+}
+
+Graph& Tab::AddGraph(std::string label, std::size_t capacity, GraphProducerMode producers) {
+    auto graph = MakePooled<Graph>(std::move(label), capacity, producers);
+    auto& ref = *graph;
+    path_.Register(ref.label(), &ref);
+    AddWidget(std::move(graph));
+    return ref;
 }
 
-Graph& Tab::AddGraph(std::string label) {
-    auto graph = std::make_shared<Graph>(std::move(label));
-    std::lock_guard<std::mutex> lock(content_mutex_);
-    widgets_.push_back(graph);
-    return *graph;
+HistoryGraph& Tab::AddHistoryGraph(std::string label, std::size_t history) {
+    auto graph = MakePooled<HistoryGraph>(std::move(label), history);
+    auto& ref = *graph;
+    path_.Register(ref.label(), &ref);
+    AddWidget(std::move(graph));
+    return ref;
 }
 
 Variable& Tab::AddVariable(std::string label) {
-    auto variable = std::make_shared<Variable>(std::move(label));
-    std::lock_guard<std::mutex> lock(content_mutex_);
-    widgets_.push_back(variable);
-    return *variable;
+    auto variable = MakePooled<Variable>(std::move(label));
+    auto& ref = *variable;
+    path_.Register(ref.label(), &ref);
+    AddWidget(std::move(variable));
+    return ref;
 }
 
 Structure& Tab::AddStructure(std::string label) {
-    auto structure = std::make_shared<Structure>(std::move(label));
-    std::lock_guard<std::mutex> lock(content_mutex_);
-    widgets_.push_back(structure);
-    return *structure;
+    auto structure = MakePooled<Structure>(label, path_.Child(label));
+    auto& ref = *structure;
+    path_.Register(ref.label(), &ref);
+    AddWidget(std::move(structure));
+    return ref;
 }
 
-MessageMonitor& Tab::AddMessageMonitor(std::string label) {
-    auto monitor = std::make_shared<MessageMonitor>(std::move(label));
-    std::lock_guard<std::mutex> lock(content_mutex_);
-    widgets_.push_back(monitor);
-    return *monitor;
+MessageMonitor& Tab::AddMessageMonitor(std::string label, MessageMonitorOptions options) {
+    auto monitor = MakePooled<MessageMonitor>(std::move(label), options);
+    auto& ref = *monitor;
+    path_.Register(ref.label(), &ref);
+    AddWidget(std::move(monitor));
+    return ref;
 }
 
-MessageMonitor* Tab::FindMessageMonitor(const std::string& label) {
-    std::lock_guard<std::mutex> lock(content_mutex_);
-    for (const auto& widget : widgets_) {
-        auto monitor = std::dynamic_pointer_cast<MessageMonitor>(widget);
-        if (monitor && monitor->label() == label) {
-            return monitor.get();
+LayoutStructure& Tab::AddLayoutStructure(std::string label, StructLayout layout, std::size_t size) {
+    auto structure = MakePooled<LayoutStructure>(std::move(label), std::move(layout), size);
+    auto& ref = *structure;
+    path_.Register(ref.label(), &ref);
+    AddWidget(std::move(structure));
+    return ref;
+}
+
+bool Tab::Remove(const WindowContent& widget) {
+    // Unregister first: once the list node is retired, nothing may be able
+    // to resolve the widget through the index.
+    path_.Unregister(widget.label(), &widget);
+    std::lock_guard<std::mutex> lock(mirror_mutex_);
+    UpdateSink* sink = widget.remote().sink();
+    const std::uint32_t remote_id = widget.remote().id();
+    const auto removed = widgets_.RemoveIf([&](const auto& child) { return child.get() == &widget; });
+    if (removed == 0) {
+        return false;
+    }
+    SendRemove(sink, remote_id);
+    RedrawSignal::Raise();
+    return true;
+}
+
+void Tab::MirrorTo(UpdateSink& sink, std::uint32_t parent) {
+    std::lock_guard<std::mutex> lock(mirror_mutex_);
+    const std::uint32_t id = DefineNode(sink, remote_, RecordType::kTab, parent, label_);
+    Rcu::ReadGuard guard;
+    for (const auto& widget : widgets_.Read()) {
+        widget->MirrorTo(sink, id);
+    }
+}
+
+void Tab::AddWidget(std::shared_ptr<WindowContent> widget) {
+    {
+        std::lock_guard<std::mutex> lock(mirror_mutex_);
+        if (UpdateSink* sink = remote_.sink()) {
+            widget->MirrorTo(*sink, remote_.id());
         }
+        widgets_.PushBack(std::move(widget));
     }
-    return nullptr;
+    RedrawSignal::Raise();
+}
+
+MessageMonitor* Tab::FindMessageMonitor(const std::string& label) {
+    return const_cast<MessageMonitor*>(static_cast<const Tab&>(*this).FindMessageMonitor(label));
 }
 
 const MessageMonitor* Tab::FindMessageMonitor(const std::string& label) const {
-    std::lock_guard<std::mutex> lock(content_mutex_);
-    for (const auto& widget : widgets_) {
-        auto monitor = std::dynamic_pointer_cast<MessageMonitor>(widget);
-        if (monitor && monitor->label() == label) {
-            return monitor.get();
+    if (path_.indexed()) {
+        return path_.Find<MessageMonitor>(label);
+    }
+    Rcu::ReadGuard guard;
+    for (const auto& widget : widgets_.Read()) {
+        const auto* monitor = dynamic_cast<const MessageMonitor*>(widget.get());
+        if (monitor != nullptr && monitor->label() == label) {
+            return monitor;
         }
     }
     return nullptr;
 }
 
 void Tab::Render() const {
-    Tab::RenderCallback callback_copy;
-    std::vector<std::shared_ptr<WindowContent>> widgets_snapshot;
-    {
-        std::lock_guard<std::mutex> lock(content_mutex_);
-        callback_copy = callback_;
-        widgets_snapshot = widgets_;
-    }
-
-    if (callback_copy) {
-        callback_copy();
+    DEBUGGLASS_PROFILE_SCOPE(ProfileKind::kTab, this, label_);
+    Rcu::ReadGuard guard;
+    const RenderCallback* callback = callback_.Read();
+    const auto widgets_snapshot = widgets_.Read();
+    const bool has_callback = callback != nullptr && *callback;
+
+    if (has_callback) {
+        DEBUGGLASS_PROFILE_SCOPE(ProfileKind::kCallback, callback, "callback");
+        (*callback)();
     }
 
-    for (const auto& widget : widgets_snapshot) {
-        if (widget) {
-            widget->Render();
-        }
-    }
+    RenderWidgets(widgets_snapshot);
 
-    if (!callback_copy && widgets_snapshot.empty()) {
+    if (!has_callback && widgets_snapshot.empty()) {
         ImGui::TextUnformatted("No content assigned");
     }
 }
@@ -1,15 +1,24 @@
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "debugglass/util/rcu.h"
+#include "debugglass/util/slab_pool.h"
+#include "debugglass/widgets/bound_structure.h"
 #include "debugglass/widgets/graph.h"
+#include "debugglass/widgets/history_graph.h"
 #include "debugglass/widgets/message_monitor.h"
 #include "debugglass/widgets/structure.h"
+#include "debugglass/widgets/typed_variable.h"
 #include "debugglass/widgets/variable.h"
+#include "debugglass/widgets/watch.h"
+#include "debugglass/widgets/widget_index.h"
 #include "debugglass/widgets/window_content.h"
 
 namespace debugglass {
@@ -18,26 +27,77 @@ class Tab {
 public:
     using RenderCallback = std::function<void()>;
 
-    explicit Tab(std::string label);
+    // `path` places the tab in a registry's WidgetIndex; children are
+    // indexed under it by label.
+    explicit Tab(std::string label, WidgetPath path = {});
 
     const std::string& label() const noexcept { return label_; }
 
     void SetRenderCallback(RenderCallback callback);
 
-    Graph& AddGraph(std::string label);
+    Graph& AddGraph(std::string label,
+                    std::size_t capacity = Graph::kDefaultCapacity,
+                    GraphProducerMode producers = GraphProducerMode::kMultiProducer);
+    HistoryGraph& AddHistoryGraph(std::string label, std::size_t history = HistoryGraph::kDefaultHistory);
     Variable& AddVariable(std::string label);
+    // Lock-free variable for an arithmetic T, formatted only when drawn.
+    template <typename T>
+    TypedVariable<T>& AddTypedVariable(std::string label) {
+        auto variable = MakePooled<TypedVariable<T>>(std::move(label));
+        path_.Register(variable->label(), variable.get());
+        AddWidget(variable);
+        return *variable;
+    }
+    // Sampled by the render thread; `source` is a const std::atomic<T>*, a
+    // const T* or a callable returning T. See Watch.
+    template <typename Source>
+    auto& AddWatch(std::string label, Source source) {
+        auto watch = MakeWatch(std::move(label), std::move(source));
+        path_.Register(watch->label(), watch.get());
+        AddWidget(watch);
+        return *watch;
+    }
+    // Mirrors a whole struct described by StructFields<T>; see BoundStructure.
+    template <typename T>
+    BoundStructure<T>& AddBoundStructure(std::string label, const T& initial = T{}) {
+        auto structure = MakePooled<BoundStructure<T>>(std::move(label), initial);
+        path_.Register(structure->label(), structure.get());
+        AddWidget(structure);
+        return *structure;
+    }
     Structure& AddStructure(std::string label);
-    MessageMonitor& AddMessageMonitor(std::string label);
+    MessageMonitor& AddMessageMonitor(std::string label, MessageMonitorOptions options = {});
+    // Viewer-side stand-in for a mirrored BoundStructure.
+    LayoutStructure& AddLayoutStructure(std::string label, StructLayout layout, std::size_t size);
+
+    // Detaches `widget` and clears its path (and any below it) from the
+    // index. The widget is destroyed once no reader can still see it; any
+    // reference the caller kept is dangling from then on. Returns false if
+    // `widget` is not a child of this tab.
+    bool Remove(const WindowContent& widget);
+    // O(1) through the WidgetIndex when the tab belongs to a registry,
+    // otherwise a linear scan.
     MessageMonitor* FindMessageMonitor(const std::string& label);
     const MessageMonitor* FindMessageMonitor(const std::string& label) const;
 
     void Render() const;
 
+    // Announces the tab and its widgets to `sink` under node `parent`; see
+    // SubWindowRegistry::MirrorTo.
+    void MirrorTo(UpdateSink& sink, std::uint32_t parent);
+    const RemoteBinding& remote() const noexcept { return remote_; }
+
 private:
+    void AddWidget(std::shared_ptr<WindowContent> widget);
+
     std::string label_;
-    mutable std::mutex content_mutex_;
-    RenderCallback callback_;
-    std::vector<std::shared_ptr<WindowContent>> widgets_;
+    WidgetPath path_;
+    RemoteBinding remote_;
+    RcuBox<RenderCallback> callback_;
+    RcuList<std::shared_ptr<WindowContent>> widgets_;
+    // Held while mirroring and while adding or removing widgets, so every
+    // widget is announced exactly once and none is missed.
+    std::mutex mirror_mutex_;
 };
 
 }  // namespace debugglass
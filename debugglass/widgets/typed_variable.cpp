@@ -0,0 +1,11 @@
+#include "debugglass/widgets/typed_variable.h"
+
+#include <imgui.h>
+
+namespace debugglass {
+
+void RenderVariableText(const std::string& label, std::string_view text) {
+    ImGui::Text("%s: %.*s", label.c_str(), static_cast<int>(text.size()), text.data());
+}
+
+}  // namespace debugglass
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "debugglass/util/export.h"
+#include "debugglass/util/redraw_signal.h"
+#include "debugglass/util/value_format.h"
+#include "debugglass/widgets/window_content.h"
+
+namespace debugglass {
+
+// Draws "label: text" the same way Variable does.
+void RenderVariableText(const std::string& label, std::string_view text);
+
+// Variable holding a raw arithmetic value in a std::atomic. SetValue is a
+// single lock-free store with no formatting or allocation; the render thread
+// formats the latest value when it draws the row.
+template <typename T>
+class TypedVariable : public WindowContent {
+    static_assert(std::is_arithmetic_v<T>, "TypedVariable holds arithmetic types only");
+
+public:
+    explicit TypedVariable(std::string label, T initial = T{}) : label_(std::move(label)), value_(initial) {}
+
+    const std::string& label() const noexcept override { return label_; }
+
+    void SetValue(T value) noexcept {
+        if (UpdateSink* sink = remote_.sink()) {
+            const NumberPayload payload = NumberPayload::From(value);
+            SendUpdate(*sink, remote_.id(), RecordType::kNumber, &payload, sizeof(payload));
+            return;
+        }
+        value_.store(value, std::memory_order_release);
+        RedrawSignal::Raise();
+    }
+
+    T value() const noexcept { return value_.load(std::memory_order_acquire); }
+
+    void Render() const override {
+        const T current = value();
+        if (!cached_ || current != cached_value_) {
+            NumberBuffer buffer;
+            const std::string_view text = FormatArithmetic(current, buffer);
+            cached_text_.assign(text.data(), text.size());
+            cached_value_ = current;
+            cached_ = true;
+        }
+        RenderVariableText(label_, cached_text_);
+    }
+
+    bool IsSingleLine() const noexcept override { return true; }
+
+    void ExportLeaves(ExportTable& table, const std::string& path) const override {
+        table.AddText(path);
+        table.AddArithmetic(value());
+    }
+
+    void MirrorTo(UpdateSink& sink, std::uint32_t parent) override {
+        const NumberPayload initial = NumberPayload::From(value());
+        DefineNode(sink, remote_, RecordType::kTypedVariable, parent, label_, &initial, sizeof(initial));
+    }
+
+private:
+    std::string label_;
+    std::atomic<T> value_;
+
+    // Render-thread cache of the formatted value.
+    mutable bool cached_ = false;
+    mutable T cached_value_{};
+    mutable std::string cached_text_;
+};
+
+}  // namespace debugglass
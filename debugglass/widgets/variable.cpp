@@ -1,30 +1,68 @@
 #include "debugglass/widgets/variable.h"
 
+#include <algorithm>
 #include <utility>
 
 #include <imgui.h>
 
+#include "debugglass/util/export.h"
+#include "debugglass/util/profiler.h"
+#include "debugglass/util/redraw_signal.h"
+
 namespace debugglass {
 
 Variable::Variable(std::string label) : label_(std::move(label)) {}
 
 void Variable::SetValue(const std::string& value) {
+    if (Forward(value)) {
+        return;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
     value_ = value;
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    RedrawSignal::Raise();
 }
 
 void Variable::SetValue(std::string&& value) {
+    if (Forward(value)) {
+        return;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
     value_ = std::move(value);
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    RedrawSignal::Raise();
+}
+
+void Variable::ExportLeaves(ExportTable& table, const std::string& path) const {
+    table.AddText(path);
+    std::lock_guard<std::mutex> lock(mutex_);
+    table.AddText(value_);
+}
+
+bool Variable::Forward(const std::string& value) const {
+    UpdateSink* sink = remote_.sink();
+    if (sink == nullptr) {
+        return false;
+    }
+    SendUpdate(*sink, remote_.id(), RecordType::kText, value.data(), std::min(value.size(), kMaxRecordPayload));
+    return true;
+}
+
+void Variable::MirrorTo(UpdateSink& sink, std::uint32_t parent) {
+    DefineNode(sink, remote_, RecordType::kVariable, parent, label_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!value_.empty()) {
+        SendUpdate(sink, remote_.id(), RecordType::kText, value_.data(), std::min(value_.size(), kMaxRecordPayload));
+    }
 }
 
 void Variable::Render() const {
-    std::string value_copy;
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        value_copy = value_;
+    if (version_.load(std::memory_order_acquire) != rendered_version_) {
+        DEBUGGLASS_PROFILED_LOCK(lock, mutex_);
+        rendered_line_.assign(label_).append(": ").append(value_);
+        rendered_version_ = version_.load(std::memory_order_relaxed);
     }
-    ImGui::Text("%s: %s", label_.c_str(), value_copy.c_str());
+    ImGui::TextUnformatted(rendered_line_.data(), rendered_line_.data() + rendered_line_.size());
 }
 
 }  // namespace debugglass
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <mutex>
 #include <sstream>
 #include <string>
@@ -22,14 +24,26 @@ public:
         SetValue(stream.str());
     }
 
-    const std::string& label() const noexcept { return label_; }
+    const std::string& label() const noexcept override { return label_; }
 
     void Render() const override;
+    bool IsSingleLine() const noexcept override { return true; }
+    void ExportLeaves(ExportTable& table, const std::string& path) const override;
+    void MirrorTo(UpdateSink& sink, std::uint32_t parent) override;
 
 private:
+    // Forwards `value` when mirrored; false if the write should be stored.
+    bool Forward(const std::string& value) const;
+
     std::string label_;
     mutable std::mutex mutex_;
     std::string value_;
+    // Bumped by every SetValue so Render only rebuilds its line on change.
+    std::atomic<std::uint64_t> version_{1};
+
+    // Render-thread cache of "label: value".
+    mutable std::uint64_t rendered_version_ = 0;
+    mutable std::string rendered_line_;
 };
 
 }  // namespace debugglass
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "debugglass/util/slab_pool.h"
+#include "debugglass/util/value_format.h"
+#include "debugglass/widgets/graph.h"
+#include "debugglass/widgets/typed_variable.h"
+#include "debugglass/widgets/window_content.h"
+
+namespace debugglass {
+
+// Read-only view of application state that the render thread samples every
+// time it draws the row, so the producer never calls into DebugGlass. The
+// source must outlive the widget.
+//
+// A watch is only sampled while it is drawn: a collapsed structure or a
+// hidden tab stops sampling, and under RedrawMode::kOnDemand it refreshes at
+// min_fps unless something else triggers a frame.
+template <typename T>
+class Watch : public WindowContent {
+    static_assert(std::is_arithmetic_v<T>, "Watch reads arithmetic types only");
+
+public:
+    using Source = std::function<T()>;
+
+    Watch(std::string label, Source source) : label_(std::move(label)), source_(std::move(source)) {}
+
+    const std::string& label() const noexcept override { return label_; }
+
+    // Appends every sample to `graph`, which must outlive the watch. The
+    // graph only ever receives values from the render thread, so it can use
+    // GraphProducerMode::kSingleProducer. Pass nullptr to unbind.
+    Watch& PlotTo(Graph* graph) noexcept {
+        graph_.store(graph, std::memory_order_release);
+        return *this;
+    }
+
+    void Render() const override {
+        const T value = source_();
+        if (Graph* graph = graph_.load(std::memory_order_acquire)) {
+            // Sampling must not itself request the next frame.
+            graph->AddValueNoRedraw(static_cast<float>(value));
+        }
+        NumberBuffer buffer;
+        RenderVariableText(label_, FormatArithmetic(value, buffer));
+    }
+
+private:
+    std::string label_;
+    Source source_;
+    std::atomic<Graph*> graph_{nullptr};
+};
+
+// Builders behind Tab::AddWatch and Structure::AddWatch.
+template <typename T>
+std::shared_ptr<Watch<T>> MakeWatch(std::string label, const std::atomic<T>* source) {
+    return MakePooled<Watch<T>>(std::move(label), [source]() { return source->load(std::memory_order_relaxed); });
+}
+
+// Plain memory is read without synchronisation. That is only meaningful for
+// naturally aligned values no wider than a machine word, which is what this
+// overload is for; use std::atomic<T> or a getter for anything else.
+template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+std::shared_ptr<Watch<T>> MakeWatch(std::string label, const T* source) {
+    return MakePooled<Watch<T>>(std::move(label), [source]() {
+        return *static_cast<const volatile T*>(source);
+    });
+}
+
+template <typename Getter, typename = std::enable_if_t<std::is_invocable_v<Getter&>>>
+auto MakeWatch(std::string label, Getter getter) {
+    using T = std::decay_t<std::invoke_result_t<Getter&>>;
+    return MakePooled<Watch<T>>(std::move(label), std::move(getter));
+}
+
+}  // namespace debugglass
@@ -0,0 +1,123 @@
+#include "debugglass/widgets/widget_index.h"
+
+namespace debugglass {
+
+void WidgetIndex::RegisterSlot(const std::string& path, const void* type, void* widget, const void* owner) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Unregister clears the owner's path before the owner is retired, so a
+    // registration that loses the race with removal is refused here rather
+    // than leaving a slot that outlives its widget.
+    Slot* parent = nullptr;
+    if (owner != nullptr) {
+        const auto separator = path.rfind('/');
+        if (separator == std::string::npos) {
+            return;
+        }
+        thread_local std::string parent_path;
+        parent_path.assign(path, 0, separator);
+        const auto it = slots_.find(parent_path);
+        if (it == slots_.end() || it->second->widget.load(std::memory_order_relaxed) != owner) {
+            return;
+        }
+        parent = it->second;
+    }
+
+    Slot& slot = AcquireLocked(path);
+    if (slot.widget.load(std::memory_order_relaxed) != nullptr) {
+        return;
+    }
+    WriteSlot(slot, type, widget);
+    if (parent != nullptr) {
+        Link(slot, *parent);
+    }
+}
+
+void WidgetIndex::Unregister(const std::string& path, const void* widget) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = slots_.find(path);
+    if (it == slots_.end() || it->second->widget.load(std::memory_order_relaxed) != widget) {
+        return;
+    }
+    ClearLocked(*it->second);
+}
+
+WidgetIndex::Slot& WidgetIndex::SlotFor(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot& slot = AcquireLocked(path);
+    slot.handed_out = true;
+    return slot;
+}
+
+std::size_t WidgetIndex::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slots_.size();
+}
+
+WidgetIndex::Slot& WidgetIndex::AcquireLocked(const std::string& path) {
+    const auto it = slots_.find(path);
+    if (it != slots_.end()) {
+        return *it->second;
+    }
+    Slot* slot = nullptr;
+    if (free_.empty()) {
+        slot = &storage_.emplace_back();
+    } else {
+        slot = free_.back();
+        free_.pop_back();
+    }
+    const auto inserted = slots_.emplace(path, slot).first;
+    slot->path = &inserted->first;
+    return *slot;
+}
+
+void WidgetIndex::ClearLocked(Slot& slot) {
+    while (slot.first_child != nullptr) {
+        ClearLocked(*slot.first_child);
+    }
+    WriteSlot(slot, nullptr, nullptr);
+    Unlink(slot);
+    if (slot.handed_out) {
+        return;
+    }
+    slots_.erase(slots_.find(*slot.path));
+    slot.path = nullptr;
+    free_.push_back(&slot);
+}
+
+void WidgetIndex::Link(Slot& slot, Slot& parent) {
+    slot.parent = &parent;
+    slot.prev_sibling = nullptr;
+    slot.next_sibling = parent.first_child;
+    if (parent.first_child != nullptr) {
+        parent.first_child->prev_sibling = &slot;
+    }
+    parent.first_child = &slot;
+}
+
+void WidgetIndex::Unlink(Slot& slot) {
+    if (slot.parent == nullptr) {
+        return;
+    }
+    if (slot.prev_sibling != nullptr) {
+        slot.prev_sibling->next_sibling = slot.next_sibling;
+    } else {
+        slot.parent->first_child = slot.next_sibling;
+    }
+    if (slot.next_sibling != nullptr) {
+        slot.next_sibling->prev_sibling = slot.prev_sibling;
+    }
+    slot.parent = nullptr;
+    slot.prev_sibling = nullptr;
+    slot.next_sibling = nullptr;
+}
+
+void WidgetIndex::WriteSlot(Slot& slot, const void* type, void* widget) {
+    const std::uint64_t generation = slot.generation.load(std::memory_order_relaxed);
+    slot.generation.store(generation + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.type.store(type, std::memory_order_relaxed);
+    slot.widget.store(widget, std::memory_order_relaxed);
+    slot.generation.store(generation + 2, std::memory_order_release);
+}
+
+}  // namespace debugglass
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "debugglass/util/rcu.h"
+#include "debugglass/util/slab_pool.h"
+
+namespace debugglass {
+
+// Address that identifies T without RTTI; unique per type across the
+// program because inline variables have a single definition.
+template <typename T>
+inline constexpr char kWidgetTypeTag = 0;
+
+// Hashed map from "Window/Tab/Structure/Widget" paths to widgets, filled in
+// as widgets are added through a SubWindowRegistry. Each path owns a slot
+// whose address never changes, so a WidgetHandle can be cached and resolved
+// later without hashing or locking.
+class WidgetIndex {
+public:
+    static constexpr std::uint64_t kAnyGeneration = std::numeric_limits<std::uint64_t>::max();
+
+    // A path's current occupant. Slot memory is never freed, so pointers to
+    // slots stay valid for the index's lifetime. Once a path is removed its
+    // slot is recycled for another path, unless a handle was taken for it.
+    struct Slot {
+        // Even while stable and odd while a widget is being registered or
+        // removed; every change moves it forward by two, including reuse.
+        std::atomic<std::uint64_t> generation{0};
+        std::atomic<const void*> type{nullptr};
+        std::atomic<void*> widget{nullptr};
+
+        // Index bookkeeping, guarded by the index mutex. `path` points at
+        // the key in the map and is null while the slot is free; children
+        // are the occupied slots registered under this one.
+        const std::string* path = nullptr;
+        Slot* parent = nullptr;
+        Slot* first_child = nullptr;
+        Slot* next_sibling = nullptr;
+        Slot* prev_sibling = nullptr;
+        bool handed_out = false;
+    };
+
+    // First registration of a path wins; later widgets with the same path
+    // stay reachable only through their parent. With an `owner`, the path is
+    // only taken while the owner still occupies the parent path, so a child
+    // added during its container's removal is never left in the index.
+    template <typename T>
+    void Register(const std::string& path, T* widget, const void* owner = nullptr) {
+        RegisterSlot(path, &kWidgetTypeTag<T>, widget, owner);
+    }
+
+    // Clears `path` if it still refers to `widget`, together with every path
+    // below it. Must happen before the widget is unpublished from its parent
+    // so that no reader can resolve it once it has been retired.
+    void Unregister(const std::string& path, const void* widget);
+
+    // Returns the slot for `path`, creating an empty one so a handle can be
+    // taken before the widget exists. The slot is kept for the index's
+    // lifetime, since the handle may be cached anywhere.
+    Slot& SlotFor(const std::string& path);
+
+    // The widget at `path` if it has type T. Resolved under the index lock,
+    // so a slot recycled concurrently is never read for another path.
+    template <typename T>
+    T* Find(const std::string& path) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = slots_.find(path);
+        return it == slots_.end() ? nullptr : Resolve<T>(it->second);
+    }
+
+    // Slots currently mapped to a path, occupied or not.
+    std::size_t size() const;
+
+    // The widget in `slot` if it has type T and, unless kAnyGeneration is
+    // passed, is still the occupant from `generation`.
+    template <typename T>
+    static T* Resolve(const Slot* slot, std::uint64_t generation = kAnyGeneration) noexcept {
+        if (slot == nullptr) {
+            return nullptr;
+        }
+        const std::uint64_t before = slot->generation.load(std::memory_order_acquire);
+        if ((before & 1) != 0 || (generation != kAnyGeneration && before != generation)) {
+            return nullptr;
+        }
+        void* widget = slot->widget.load(std::memory_order_relaxed);
+        const void* type = slot->type.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->generation.load(std::memory_order_relaxed) != before || widget == nullptr ||
+            type != &kWidgetTypeTag<T>) {
+            return nullptr;
+        }
+        return static_cast<T*>(widget);
+    }
+
+private:
+    // Map nodes come from the slab pools, so churning paths recycles them
+    // instead of going to the global allocator.
+    using SlotMap = std::unordered_map<std::string, Slot*, std::hash<std::string>, std::equal_to<std::string>,
+                                       PoolAllocator<std::pair<const std::string, Slot*>>>;
+
+    void RegisterSlot(const std::string& path, const void* type, void* widget, const void* owner);
+    static void WriteSlot(Slot& slot, const void* type, void* widget);
+    Slot& AcquireLocked(const std::string& path);
+    // Empties `slot` and everything registered below it, returning the
+    // slots no handle refers to to the free list.
+    void ClearLocked(Slot& slot);
+    static void Link(Slot& slot, Slot& parent);
+    static void Unlink(Slot& slot);
+
+    mutable std::mutex mutex_;
+    SlotMap slots_;
+    // Backing storage for every slot ever created; deque growth never moves
+    // existing elements.
+    std::deque<Slot> storage_;
+    std::vector<Slot*> free_;
+};
+
+// Cached result of a path lookup. get() is a few atomic loads and returns
+// null until a widget of type T is registered at the path, or if the path
+// holds a different kind of widget.
+//
+// A widget that is removed stays alive until every Rcu::ReadGuard that could
+// have seen it has ended. Producers that may race with removal should use
+// With(), which holds a guard around the call; a bare get() pointer is only
+// safe while no one removes the widget.
+template <typename T>
+class WidgetHandle {
+public:
+    WidgetHandle() = default;
+    explicit WidgetHandle(const WidgetIndex::Slot* slot,
+                          std::uint64_t generation = WidgetIndex::kAnyGeneration)
+        : slot_(slot), generation_(generation) {}
+
+    T* get() const noexcept { return WidgetIndex::Resolve<T>(slot_, generation_); }
+    T* operator->() const noexcept { return get(); }
+    explicit operator bool() const noexcept { return get() != nullptr; }
+
+    // Calls `fn(T&)` if the widget is present. Returns whether it was.
+    template <typename Fn>
+    bool With(Fn&& fn) const {
+        Rcu::ReadGuard guard;
+        if (T* widget = get()) {
+            std::forward<Fn>(fn)(*widget);
+            return true;
+        }
+        return false;
+    }
+
+    // Handle to the widget currently at the path that resolves to null once
+    // that widget is removed, even if another one later takes its path. Empty
+    // if nothing of type T is there now.
+    WidgetHandle Pinned() const noexcept {
+        if (slot_ == nullptr) {
+            return {};
+        }
+        const std::uint64_t generation = slot_->generation.load(std::memory_order_acquire);
+        if (WidgetIndex::Resolve<T>(slot_, generation) == nullptr) {
+            return {};
+        }
+        return WidgetHandle(slot_, generation);
+    }
+
+private:
+    const WidgetIndex::Slot* slot_ = nullptr;
+    std::uint64_t generation_ = WidgetIndex::kAnyGeneration;
+};
+
+// Where a container sits in the index. Containers pass a child path down to
+// every widget they create; a default-constructed path indexes nothing, for
+// widgets built outside a registry.
+class WidgetPath {
+public:
+    WidgetPath() = default;
+    WidgetPath(WidgetIndex* index, std::string path) : index_(index), path_(std::move(path)) {}
+
+    // The container whose children this path names. Set by the container
+    // itself once constructed; children are only indexed while it is.
+    void set_owner(const void* owner) noexcept { owner_ = owner; }
+
+    WidgetPath Child(const std::string& label) const {
+        if (index_ == nullptr) {
+            return {};
+        }
+        return WidgetPath(index_, path_.empty() ? label : path_ + "/" + label);
+    }
+
+    template <typename T>
+    void Register(const std::string& label, T* widget) const {
+        if (index_ != nullptr) {
+            index_->Register(ChildPath(label), widget, owner_);
+        }
+    }
+
+    void Unregister(const std::string& label, const void* widget) const {
+        if (index_ != nullptr) {
+            index_->Unregister(ChildPath(label), widget);
+        }
+    }
+
+    template <typename T>
+    T* Find(const std::string& label) const {
+        return index_ == nullptr ? nullptr : index_->Find<T>(ChildPath(label));
+    }
+
+    bool indexed() const noexcept { return index_ != nullptr; }
+
+private:
+    // Builds the child's path in a per-thread buffer so adding and removing
+    // widgets does not allocate a string each time. Valid until the next
+    // call on the same thread.
+    const std::string& ChildPath(const std::string& label) const {
+        thread_local std::string buffer;
+        buffer.assign(path_);
+        if (!path_.empty()) {
+            buffer.push_back('/');
+        }
+        buffer.append(label);
+        return buffer;
+    }
+
+    WidgetIndex* index_ = nullptr;
+    std::string path_;
+    const void* owner_ = nullptr;
+};
+
+}  // namespace debugglass
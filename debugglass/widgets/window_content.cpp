@@ -0,0 +1,38 @@
+#include "debugglass/widgets/window_content.h"
+
+#include <imgui.h>
+
+#include "debugglass/util/profiler.h"
+
+namespace debugglass {
+
+void RenderWidgets(RcuList<std::shared_ptr<WindowContent>>::View widgets) {
+    const float line_height = ImGui::GetTextLineHeightWithSpacing();
+    const float item_spacing = ImGui::GetStyle().ItemSpacing.y;
+    float skipped = 0.0f;
+    for (const auto& widget : widgets) {
+        if (!widget) {
+            continue;
+        }
+        if (widget->IsSingleLine()) {
+            const ImVec2 cursor = ImGui::GetCursorScreenPos();
+            const ImVec2 row_min(cursor.x, cursor.y + skipped);
+            const ImVec2 row_max(cursor.x + 1.0f, row_min.y + line_height);
+            if (!ImGui::IsRectVisible(row_min, row_max)) {
+                skipped += line_height;
+                continue;
+            }
+        }
+        if (skipped > 0.0f) {
+            ImGui::Dummy(ImVec2(0.0f, skipped - item_spacing));
+            skipped = 0.0f;
+        }
+        DEBUGGLASS_PROFILE_SCOPE(ProfileKind::kWidget, widget.get(), widget->label());
+        widget->Render();
+    }
+    if (skipped > 0.0f) {
+        ImGui::Dummy(ImVec2(0.0f, skipped - item_spacing));
+    }
+}
+
+}  // namespace debugglass
@@ -1,11 +1,66 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "debugglass/transport/update_sink.h"
+#include "debugglass/util/rcu.h"
+
 namespace debugglass {
 
-class WindowContent {
+class ExportTable;
+
+// Widgets are owned through shared_ptr; background work such as exports
+// uses weak_from_this() to keep a widget alive while it reads it.
+class WindowContent : public std::enable_shared_from_this<WindowContent> {
 public:
     virtual ~WindowContent() = default;
     virtual void Render() const = 0;
+
+    // Name under which the widget is indexed and removed by its parent.
+    virtual const std::string& label() const noexcept {
+        static const std::string kUnlabelled;
+        return kUnlabelled;
+    }
+
+    // Widgets that always draw exactly one line of text return true, which
+    // lets containers skip them entirely while they are scrolled out of view.
+    virtual bool IsSingleLine() const noexcept { return false; }
+
+    // Announces the widget to `sink` under node `parent` and routes its
+    // later writes there instead of local storage. Widgets that cannot be
+    // mirrored, such as watches, keep the default and stay local.
+    virtual void MirrorTo(UpdateSink& sink, std::uint32_t parent) {
+        static_cast<void>(sink);
+        static_cast<void>(parent);
+    }
+
+    // Fills `table` with the widget's data: one row per message, graph
+    // sample or structure leaf. Runs on the export thread, so it may only
+    // read state that is safe to read concurrently with writers and the
+    // render thread. Returns false when there is nothing to export.
+    virtual bool Export(ExportTable& table) const {
+        static_cast<void>(table);
+        return false;
+    }
+
+    // Adds (path, value) rows for the widget and its descendants to a
+    // table started by Structure::Export; `path` names this widget.
+    virtual void ExportLeaves(ExportTable& table, const std::string& path) const {
+        static_cast<void>(table);
+        static_cast<void>(path);
+    }
+
+    const RemoteBinding& remote() const noexcept { return remote_; }
+
+protected:
+    RemoteBinding remote_;
 };
 
+// Renders `widgets` in order. Runs of single-line widgets outside the visible
+// region are replaced by one spacer of the same height. The caller must hold
+// an Rcu::ReadGuard.
+void RenderWidgets(RcuList<std::shared_ptr<WindowContent>>::View widgets);
+
 }  // namespace debugglass
@@ -24,6 +24,8 @@ int main() {
 
     debugglass::DebugGlassOptions options;
     options.title = "Message Monitor Demo";
+    // Only takes effect when built with --config=profiler.
+    options.show_profiler = true;
 
     if (!monitor.Run(options)) {
         std::cerr << "Failed to start DebugGlass" << std::endl;
@@ -34,7 +34,7 @@ int main() {
     auto& fps_variable = systems_structure.AddVariable("FPS Target");
     fps_variable.SetValue(60);
     auto& telemetry_structure = systems_structure.AddStructure("Telemetry");
-    auto& latency_variable = telemetry_structure.AddVariable("Latency (ms)");
+    auto& latency_variable = telemetry_structure.AddTypedVariable<float>("Latency (ms)");
     latency_variable.SetValue(4.2f);
 
     auto& logs_structure = systems_structure.AddStructure("Logs");
@@ -0,0 +1,273 @@
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <imgui.h>
+
+#include "debugglass/debugglass.h"
+#include "debugglass/transport/remote_tree.h"
+#include "debugglass/transport/session_player.h"
+#include "debugglass/transport/shm_ring.h"
+#include "debugglass/transport/socket_client.h"
+#include "debugglass/widgets/typed_variable.h"
+
+namespace {
+// Bounds one poll so the stats and restart check keep running under load.
+constexpr std::size_t kMaxRecordsPerPoll = 65536;
+constexpr auto kIdlePoll = std::chrono::milliseconds(1);
+constexpr auto kSocketPoll = std::chrono::milliseconds(5);
+constexpr auto kSessionCheckInterval = std::chrono::seconds(1);
+constexpr auto kRetryInterval = std::chrono::milliseconds(500);
+constexpr auto kReplayPoll = std::chrono::milliseconds(5);
+constexpr float kMinReplaySpeed = 0.01f;
+constexpr float kMaxReplaySpeed = 1000.0f;
+// Shown as "Viewer"; the ImGui ID suffix keeps it apart from a mirrored
+// window of that name.
+constexpr char kViewerWindow[] = "Viewer###debugglass-viewer";
+
+bool IsSocketEndpoint(const std::string& source) {
+    return source.rfind("tcp://", 0) == 0 || source.rfind("unix://", 0) == 0;
+}
+
+bool IsRecording(const std::string& source) {
+    struct stat info {};
+    return stat(source.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+// Shared between the replay loop and the controls drawn by the render thread.
+struct ReplayControls {
+    std::atomic<bool> paused{false};
+    std::atomic<float> speed{1.0f};
+    // Requested position in ns, or -1.
+    std::atomic<std::int64_t> seek_ns{-1};
+    std::atomic<std::uint64_t> position_ns{0};
+    std::uint64_t duration_ns = 0;
+};
+
+void DrawReplayControls(ReplayControls& controls) {
+    const bool paused = controls.paused.load();
+    if (ImGui::Button(paused ? "Play" : "Pause")) {
+        controls.paused.store(!paused);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Restart")) {
+        controls.seek_ns.store(0);
+    }
+    ImGui::SameLine();
+    float speed = controls.speed.load();
+    ImGui::SetNextItemWidth(160.0f);
+    if (ImGui::SliderFloat("Speed", &speed, kMinReplaySpeed, kMaxReplaySpeed, "%.2fx",
+                           ImGuiSliderFlags_Logarithmic)) {
+        controls.speed.store(speed);
+    }
+    float seconds = static_cast<float>(static_cast<double>(controls.position_ns.load()) * 1e-9);
+    const float duration = static_cast<float>(static_cast<double>(controls.duration_ns) * 1e-9);
+    ImGui::SetNextItemWidth(-1.0f);
+    if (ImGui::SliderFloat("##position", &seconds, 0.0f, duration, "%.3f s")) {
+        controls.seek_ns.store(static_cast<std::int64_t>(static_cast<double>(seconds) * 1e9));
+    }
+}
+
+struct TransportStats {
+    explicit TransportStats(debugglass::Tab& tab)
+        : records(tab.AddTypedVariable<std::uint64_t>("records")),
+          lost(tab.AddTypedVariable<std::uint64_t>("lost updates")),
+          restarts(tab.AddTypedVariable<std::uint64_t>("producer restarts")) {}
+
+    debugglass::TypedVariable<std::uint64_t>& records;
+    debugglass::TypedVariable<std::uint64_t>& lost;
+    debugglass::TypedVariable<std::uint64_t>& restarts;
+};
+
+void RunSharedMemory(debugglass::DebugGlass& viewer, const std::string& name, TransportStats& stats, debugglass::Tab& tab) {
+    auto& catalog = tab.AddTypedVariable<std::uint64_t>("catalog bytes");
+    auto& overflows = tab.AddTypedVariable<std::uint64_t>("catalog overflows");
+    auto& compactions = tab.AddTypedVariable<std::uint64_t>("catalog compactions");
+
+    debugglass::RemoteTree tree(viewer.windows);
+    std::unique_ptr<debugglass::SharedMemoryRing> ring;
+    debugglass::SharedMemoryCursor cursor;
+    std::uint64_t applied = 0;
+    const auto apply = [&](const debugglass::RecordHeader& header, const unsigned char* payload) {
+        applied += tree.Apply(header, payload) ? 1 : 0;
+    };
+
+    std::string last_error;
+    auto last_check = std::chrono::steady_clock::now();
+    while (viewer.IsRunning()) {
+        if (!ring) {
+            std::string error;
+            ring = debugglass::SharedMemoryRing::Open(name, &error);
+            if (!ring) {
+                if (error != last_error) {
+                    std::cerr << "Waiting for producer: " << error << std::endl;
+                    last_error = error;
+                }
+                std::this_thread::sleep_for(kRetryInterval);
+                continue;
+            }
+            std::cout << "Attached to " << name << std::endl;
+            cursor = debugglass::SharedMemoryCursor{};
+        }
+
+        const std::uint64_t resets = cursor.catalog_resets;
+        const std::size_t visited = ring->Read(cursor, apply, kMaxRecordsPerPoll);
+        if (cursor.catalog_resets != resets) {
+            // The producer compacted its catalog; rebuild from it.
+            tree.Reset();
+            continue;
+        }
+        stats.records.SetValue(applied);
+        stats.lost.SetValue(cursor.lost);
+        catalog.SetValue(ring->catalog_used());
+        overflows.SetValue(ring->catalog_overflows());
+        compactions.SetValue(ring->catalog_compactions());
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now - last_check >= kSessionCheckInterval) {
+            last_check = now;
+            // A restarted producer recreates the segment under the same
+            // name; the old mapping stays valid but is never written again.
+            // Until a new one appears, keep showing the last state.
+            auto current = debugglass::SharedMemoryRing::Open(name);
+            if (current && current->session() != ring->session()) {
+                std::cout << "Producer restarted, reattaching" << std::endl;
+                tree.Reset();
+                ring = std::move(current);
+                cursor = debugglass::SharedMemoryCursor{};
+                stats.restarts.SetValue(stats.restarts.value() + 1);
+                continue;
+            }
+        }
+        if (visited == 0) {
+            std::this_thread::sleep_for(kIdlePoll);
+        }
+    }
+}
+
+void RunSocket(debugglass::DebugGlass& viewer, const std::string& endpoint, TransportStats& stats, debugglass::Tab& tab) {
+    auto& frames = tab.AddTypedVariable<std::uint64_t>("frames");
+    auto& bytes = tab.AddTypedVariable<std::uint64_t>("bytes");
+
+    debugglass::RemoteTree tree(viewer.windows);
+    std::unique_ptr<debugglass::SocketClient> client;
+    std::uint64_t connections = 0;
+    std::string last_error;
+    while (viewer.IsRunning()) {
+        if (!client) {
+            std::string error;
+            client = debugglass::SocketClient::Connect(endpoint, &error);
+            if (!client) {
+                if (error != last_error) {
+                    std::cerr << "Waiting for producer: " << error << std::endl;
+                    last_error = error;
+                }
+                std::this_thread::sleep_for(kRetryInterval);
+                continue;
+            }
+            std::cout << "Connected to " << endpoint << std::endl;
+            last_error.clear();
+            // Every connection starts with a snapshot, which replaces the
+            // tree; only count reconnects.
+            if (connections++ != 0) {
+                stats.restarts.SetValue(stats.restarts.value() + 1);
+            }
+        }
+
+        // Keep showing the last state until the producer is back.
+        const bool open = client->Poll(tree, kSocketPoll);
+        stats.records.SetValue(client->records());
+        stats.lost.SetValue(client->dropped());
+        frames.SetValue(client->frames());
+        bytes.SetValue(client->bytes());
+        if (!open) {
+            std::cout << "Disconnected from " << endpoint << std::endl;
+            client.reset();
+        }
+    }
+}
+
+void RunReplay(debugglass::DebugGlass& viewer, const std::string& path, TransportStats& stats, debugglass::Tab& tab) {
+    std::string error;
+    auto player = debugglass::SessionPlayer::Open(path, &error);
+    if (!player) {
+        std::cerr << "Cannot replay " << error << std::endl;
+        return;
+    }
+    std::cout << "Replaying " << path << ": " << player->chunk_count() << " chunks, "
+              << static_cast<double>(player->duration_ns()) * 1e-9 << " s"
+              << (player->indexed() ? "" : " (unfinished, index rebuilt)") << std::endl;
+
+    auto& position = tab.AddTypedVariable<double>("position (s)");
+    // Owned by the render callback too, which may run after this returns.
+    auto controls = std::make_shared<ReplayControls>();
+    controls->duration_ns = player->duration_ns();
+    tab.SetRenderCallback([controls] { DrawReplayControls(*controls); });
+
+    stats.records.SetValue(player->records());
+    stats.lost.SetValue(player->dropped());
+
+    debugglass::RemoteTree tree(viewer.windows);
+    bool reported_corrupt = false;
+    std::uint64_t time_ns = 0;
+    player->SeekTo(tree, time_ns);
+    auto last = std::chrono::steady_clock::now();
+    while (viewer.IsRunning()) {
+        std::this_thread::sleep_for(kReplayPoll);
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double, std::nano>(now - last).count();
+        last = now;
+
+        const std::int64_t seek = controls->seek_ns.exchange(-1);
+        if (seek >= 0) {
+            time_ns = std::min(static_cast<std::uint64_t>(seek), player->duration_ns());
+            player->SeekTo(tree, time_ns);
+        } else if (!controls->paused.load() && time_ns < player->duration_ns()) {
+            time_ns = std::min(time_ns + static_cast<std::uint64_t>(elapsed * controls->speed.load()),
+                               player->duration_ns());
+            player->AdvanceTo(tree, time_ns);
+        }
+        controls->position_ns.store(time_ns);
+        position.SetValue(static_cast<double>(time_ns) * 1e-9);
+        if (player->corrupt() && !reported_corrupt) {
+            std::cerr << "Recording is damaged after " << static_cast<double>(time_ns) * 1e-9 << " s" << std::endl;
+        }
+        reported_corrupt = player->corrupt();
+    }
+}
+}  // namespace
+
+// Usage: debugglass_viewer [shm-name | tcp://host:port | unix:///path | recording-file]
+int main(int argc, char** argv) {
+    const std::string source = argc > 1 ? argv[1] : "debugglass";
+
+    debugglass::DebugGlass viewer;
+    auto& tab = viewer.windows.add(kViewerWindow).tabs.add("transport");
+    TransportStats stats(tab);
+
+    debugglass::DebugGlassOptions options;
+    options.title = "DebugGlass Viewer - " + source;
+    options.redraw_mode = debugglass::RedrawMode::kOnDemand;
+    if (!viewer.Run(options)) {
+        std::cerr << "Failed to start DebugGlass" << std::endl;
+        return 1;
+    }
+
+    if (IsSocketEndpoint(source)) {
+        RunSocket(viewer, source, stats, tab);
+    } else if (IsRecording(source)) {
+        RunReplay(viewer, source, stats, tab);
+    } else {
+        RunSharedMemory(viewer, source, stats, tab);
+    }
+
+    viewer.Stop();
+    return 0;
+}